@@ -3,10 +3,11 @@
 in vec3 position;
 
 uniform vec3 color;
-uniform mat4 projectionViewMatrix;
 uniform vec3 linePosition;
 uniform vec3 lineScale;
 
+#block Frame
+
 out vec3 lineColor;
 
 void main(void)
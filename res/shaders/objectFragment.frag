@@ -17,16 +17,9 @@ out vec4 outColor;
 //uni
 
 uniform sampler2D textureSampler;
-uniform float shineDamper;
-uniform float reflectivity;
-uniform float ambientLight;
-uniform vec3 skyColor;
 
-uniform vec3 lightColour[MAX_LIGHTS];
-uniform vec3 attenuation[MAX_LIGHTS];
-uniform int lightCount;
-uniform vec3 directionalLight;
-uniform vec3 directionalLightColour;
+#block Frame
+#block Material
 
 //end
 
@@ -57,8 +50,8 @@ void main(void){
 		
 		float attFactor = attenuation[i].x + attenuation[i].y*lightDistance + attenuation[i].z*lightDistance*lightDistance;
 		
-		totalSpecular += calculateSpecular(unitNormal, unitLightVector, unitToCameraVector, shineDamper, reflectivity, lightColour[i], attFactor);
-		totalDiffuse += calculateDiffuse(unitNormal, unitLightVector, lightColour[i], attFactor);
+		totalSpecular += calculateSpecular(unitNormal, unitLightVector, unitToCameraVector, shineDamper, reflectivity, lightColour[i].xyz, attFactor);
+		totalDiffuse += calculateDiffuse(unitNormal, unitLightVector, lightColour[i].xyz, attFactor);
 	}
 	
 	totalDiffuse += directionalLightFinalColour;
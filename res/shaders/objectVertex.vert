@@ -21,16 +21,8 @@ out float visibility;
 //uni
 
 uniform mat4 transformationMatrix;
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
-uniform vec3 lightPosition[MAX_LIGHTS];
-uniform vec3 directionalLight;
-uniform vec3 directionalLightColor;
 
-uniform int lightCount;
-
-uniform float fogDensity;
-uniform float fogDistance;
+#block Frame
 
 //end                    
 void main(void){
@@ -42,9 +34,9 @@ void main(void){
 	unitNormal = normalize((transformationMatrix * vec4(normal,0.0)).xyz);
 	
 	for(int i = 0; i < lightCount;i++){
-		lightVector[i] = lightPosition[i] - worldPosition.xyz;	
+		lightVector[i] = lightPosition[i].xyz - worldPosition.xyz;	
 	}
-	directionalLightFinalColour = max(dot(unitNormal, directionalLight),0)*directionalLightColor;
+	directionalLightFinalColour = max(dot(unitNormal, directionalLight),0)*directionalLightColour;
 	directionalLightReflected = reflect(-directionalLight,unitNormal);
 	
 	toCameraVector = (inverse(viewMatrix) * vec4(0.0,0.0,0.0,1.0)).xyz - worldPosition.xyz;
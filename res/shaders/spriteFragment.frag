@@ -0,0 +1,18 @@
+#version 400 core
+
+in vec2 pass_textureCoords;
+
+out vec4 outColor;
+
+//uni
+
+uniform sampler2D textureSampler;
+
+//end
+
+void main(void)
+{
+	outColor = texture(textureSampler, pass_textureCoords);
+	if (outColor.a < 0.5) //Transparent texels would hide the sprites behind them in the depth buffer
+		discard;
+}
@@ -0,0 +1,25 @@
+#version 400 core
+
+//in
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 textureCoords;
+layout(location = 2) in vec4 basis;       //Per instance: 2x2 rotation and scale matrix, column major
+layout(location = 3) in vec4 translation; //Per instance: x, y, zIndex
+layout(location = 4) in vec4 uvRect;      //Per instance: region of the texture, offset in xy, scale in zw
+
+//end
+
+out vec2 pass_textureCoords;
+
+//uni
+
+#block Frame
+
+//end
+void main(void)
+{
+	vec2 worldPosition = mat2(basis.xy, basis.zw) * position + translation.xy;
+	gl_Position = projectionViewMatrix * vec4(worldPosition, translation.z, 1.0);
+	pass_textureCoords = uvRect.xy + textureCoords * uvRect.zw;
+}
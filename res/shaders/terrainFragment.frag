@@ -18,14 +18,7 @@ in float visibility;
 out vec4 outColor;
 
 
-uniform float ambientLight;
-uniform vec3 skyColor;
-
-uniform vec3 lightColour[MAX_LIGHTS];
-uniform vec3 attenuation[MAX_LIGHTS];
-uniform int lightCount;
-uniform vec3 directionalLightColour;
-uniform vec3 directionalLightDirection;
+#block Frame
 
 vec3 calculateDiffuse(vec3 unitNormal, vec3 unitLightVector, vec3 lightColour, float attFactor){
 	float nDotl = dot(unitNormal,unitLightVector);
@@ -54,8 +47,8 @@ void main(void){
 		
 		float attFactor = attenuation[i].x + attenuation[i].y*lightDistance + attenuation[i].z*lightDistance*lightDistance;
 		
-		totalSpecular += calculateSpecular(unitNormal, unitLightVector, unitToCameraVector, shineDamper_frag, reflectivity_frag, lightColour[i], attFactor);
-		totalDiffuse += calculateDiffuse(unitNormal, unitLightVector, lightColour[i], attFactor);
+		totalSpecular += calculateSpecular(unitNormal, unitLightVector, unitToCameraVector, shineDamper_frag, reflectivity_frag, lightColour[i].xyz, attFactor);
+		totalDiffuse += calculateDiffuse(unitNormal, unitLightVector, lightColour[i].xyz, attFactor);
 	}
 	
 	totalDiffuse += directionalLightFinalColour;
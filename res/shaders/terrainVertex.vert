@@ -10,9 +10,8 @@ struct Block
     float reflectivity;
 };
 
-in vec3 position;
-in int block_id;
-in int normal;
+layout(location = 0) in uvec3 position;      //Chunk local, packed in bytes (see ChunkMesher.hpp)
+layout(location = 1) in uint blockAndNormal; //Block id in the lowest 16 bits, normal index in the highest 16 bits
 
 
 out vec4 color_frag;
@@ -29,20 +28,15 @@ out float visibility;
 uniform Block blocks[MAX_BLOCKS];
 
 uniform vec3 chunkPosition;
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
-uniform vec3 lightPosition[MAX_LIGHTS];
-uniform vec3 directionalLight;
-uniform vec3 directionalLightColor;
 
-uniform int lightCount;
-
-uniform float fogDensity;
-uniform float fogDistance;
+#block Frame
 
 void main(void){
 
-	vec4 worldPosition = vec4(position + chunkPosition,1.0);
+	int block_id = int(blockAndNormal & 0xFFFFu);
+	int normal = int(blockAndNormal >> 16);
+
+	vec4 worldPosition = vec4(vec3(position) + chunkPosition,1.0);
 
 	gl_Position = projectionMatrix * viewMatrix * worldPosition;
 	
@@ -53,9 +47,9 @@ void main(void){
 	unitNormal = normalize(normals[normal].xyz);
 	
 	for(int i = 0; i < lightCount;i++){
-		lightVector[i] = lightPosition[i] - worldPosition.xyz;
+		lightVector[i] = lightPosition[i].xyz - worldPosition.xyz;
 	}
-	directionalLightFinalColour = max(dot(unitNormal, directionalLight),0)*directionalLightColor;
+	directionalLightFinalColour = max(dot(unitNormal, directionalLight),0)*directionalLightColour;
 	directionalLightReflected = reflect(-directionalLight,unitNormal);
 	
 	toCameraVector = (inverse(viewMatrix) * vec4(0.0,0.0,0.0,1.0)).xyz - worldPosition.xyz;
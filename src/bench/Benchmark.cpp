@@ -0,0 +1,388 @@
+#include "Benchmark.hpp"
+#include "ecs/World.hpp"
+#include "io/FileIO.hpp"
+#include "io/TextureCache.hpp"
+#include "io/ObjLoader.hpp"
+#include "rendering/MeshOptimizer.hpp"
+#include "rendering/Loader.hpp"
+#include "rendering/NullRenderDevice.hpp"
+#include "rendering/TextureStreamer.hpp"
+#include "terrain/ChunkMesher.hpp"
+#include "terrain/ChunkStreamer.hpp"
+#include "terrain/Noise.hpp"
+#include "terrain/TerrainGenerator.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+typedef std::chrono::steady_clock Clock;
+
+/// <summary>
+/// Returns the milliseconds elapsed since start.
+/// </summary>
+static double elapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// <summary>
+/// Prints the time per frame and the throughput of a benchmark.
+/// </summary>
+static void printResult(const char* label, uint updates, uint frames, double totalMs)
+{
+	double perFrame = frames > 0 ? totalMs / frames : 0;
+	printf("%s: %u updates/frame, %.3f ms/frame, %.1f M updates/s\n",
+		label, updates, perFrame, perFrame > 0 ? updates / perFrame / 1000.0 : 0.0);
+}
+
+int Benchmark::run(int argc, char** argv)
+{
+	const char* name = argc > 2 ? argv[2] : "";
+
+	if (strcmp(name, "ecs") == 0)
+		return ecs(argc > 3 ? std::stoi(argv[3]) : 1000000, argc > 4 ? std::stoi(argv[4]) : 100);
+	if (strcmp(name, "mesher") == 0)
+		return mesher(argc > 3 ? std::stoi(argv[3]) : 8);
+	if (strcmp(name, "terrain") == 0)
+		return terrain(argc > 3 ? std::stoi(argv[3]) : 16);
+	if (strcmp(name, "streaming") == 0)
+		return streaming(argc > 3 ? std::stoi(argv[3]) : 8, argc > 4 ? std::stoi(argv[4]) : 600);
+
+	if (strcmp(name, "textures") == 0)
+		return textures(argc > 3 ? std::stoi(argv[3]) : 1000, argc > 4 ? std::stof(argv[4]) : 2.0f);
+	if (strcmp(name, "obj") == 0)
+		return obj(argc > 3 ? std::stoi(argv[3]) : 64);
+
+	printf("Unknown benchmark \"%s\", available: ecs [entities] [frames], mesher [side], terrain [side], "
+		"streaming [view distance] [frames], textures [count] [budget ms], obj [side]\n", name);
+	return 1;
+}
+
+int Benchmark::ecs(uint entities, uint frames)
+{
+	Clock::time_point start = Clock::now();
+	for (uint i = 0; i < entities; i++)
+	{
+		ComponentMask mask = maskOf(ComponentType::TRANSFORM);
+		if (i % 2 == 0)
+			mask |= maskOf(ComponentType::RENDERER);
+		Entity entity = World::create(mask);
+		*World::get<float>(entity, ComponentType::TRANSFORM, Transform::SCALE) = 1;
+	}
+	printf("Created %u entities in %.1f ms\n", entities, elapsedMs(start));
+
+	//Moves every entity along a circle, the kind of work a physics or animation system does
+	auto update = [](Archetype& archetype, Chunk& chunk)
+	{
+		const float step = 0.001f;
+		float* x = archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::POSITION_X);
+		float* y = archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::POSITION_Y);
+		float* r = archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::ROTATION);
+
+		for (uint i = 0; i < chunk.count; i++)
+		{
+			float dx = -y[i] * step;
+			float dy = x[i] * step;
+			x[i] += dx + step;
+			y[i] += dy;
+			r[i] += 1;
+		}
+	};
+	Query query(maskOf(ComponentType::TRANSFORM));
+
+	start = Clock::now();
+	for (uint frame = 0; frame < frames; frame++)
+		query.forEach(update);
+	printResult("1 thread", query.count(), frames, elapsedMs(start));
+
+	start = Clock::now();
+	for (uint frame = 0; frame < frames; frame++)
+		query.forEachParallel([&](Archetype& archetype, Chunk& chunk, uint) { update(archetype, chunk); });
+	printResult((std::to_string(JobSystem::workerCount()) + " workers").c_str(), query.count(), frames, elapsedMs(start));
+
+	//Reading the results so the updates can't be optimized away
+	float checksum = 0;
+	query.forEach([&](Archetype& archetype, Chunk& chunk)
+	{
+		checksum += archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::POSITION_X)[0];
+	});
+	printf("Checksum %f\n", checksum);
+
+	World::clear();
+	return 0;
+}
+
+int Benchmark::mesher(uint side)
+{
+	const int S = VoxelChunk::SIZE;
+	const BlockID STONE = 1, DIRT = 2, GRASS = 3;
+
+	//Rolling hills between 16 and 48 voxels high, stone under 3 layers of dirt and grass
+	ChunkMap map;
+	std::vector<BlockID> blocks(VoxelChunk::VOLUME);
+	for (int cx = 0; cx < (int)side; cx++)
+		for (int cz = 0; cz < (int)side; cz++)
+			for (int cy = 0; cy < 2; cy++)
+			{
+				for (int x = 0; x < S; x++)
+					for (int z = 0; z < S; z++)
+					{
+						float wx = (float)(cx * S + x), wz = (float)(cz * S + z);
+						int height = 32 + (int)(10 * std::sin(wx * 0.07f) * std::cos(wz * 0.05f) + 6 * std::sin((wx + wz) * 0.13f));
+						for (int y = 0; y < S; y++)
+						{
+							int wy = cy * S + y;
+							BlockID block = wy > height ? AIR : wy == height ? GRASS : wy > height - 3 ? DIRT : STONE;
+							blocks[VoxelChunk::indexOf(x, y, z)] = block;
+						}
+					}
+				map.getOrCreate(glm::ivec3(cx, cy, cz)).load(blocks.data());
+			}
+	printf("Terrain: %u chunks, %.1f KB (%.1f KB as raw int16)\n", map.count(), map.memoryUsage() / 1024.0,
+		map.count() * VoxelChunk::VOLUME * sizeof(BlockID) / 1024.0);
+
+	std::vector<VoxelChunk*> chunks;
+	map.forEach([&](VoxelChunk& chunk) { chunks.push_back(&chunk); });
+
+	ChunkMesh mesh;
+	const char* names[2] = { "Naive", "Greedy" };
+	for (int greedy = 0; greedy < 2; greedy++)
+	{
+		size_t vertices = 0;
+		Clock::time_point start = Clock::now();
+		for (VoxelChunk* chunk : chunks)
+		{
+			if (greedy)
+				ChunkMesher::greedy(map, *chunk, mesh);
+			else
+				ChunkMesher::naive(map, *chunk, mesh);
+			vertices += mesh.vertices.size();
+		}
+		double total = elapsedMs(start);
+		printf("%s: %zu vertices (%.1f KB), %.1f us/chunk\n", names[greedy], vertices,
+			vertices * sizeof(TerrainVertex) / 1024.0, total * 1000.0 / chunks.size());
+	}
+
+	std::vector<ChunkMesh> meshes;
+	Clock::time_point start = Clock::now();
+	ChunkMesher::meshDirty(map, meshes);
+	double total = elapsedMs(start);
+	printf("Greedy on %u workers: %zu chunks in %.2f ms, %.1f us/chunk\n", JobSystem::workerCount(),
+		meshes.size(), total, total * 1000.0 / std::max<size_t>(meshes.size(), 1));
+	return 0;
+}
+
+int Benchmark::terrain(uint side)
+{
+	const Biome biome = TerrainGenerator::biome(0, 0);
+	printf("Biome \"%s\": %u octaves\n", biome.name.c_str(), biome.octaves);
+
+	const InstructionSet best = Noise::supported();
+	std::vector<float> heights(side * side * TerrainGenerator::AREA);
+	for (int set = (int)InstructionSet::SCALAR; set <= (int)best; set++)
+	{
+		Noise::use((InstructionSet)set);
+		Clock::time_point start = Clock::now();
+		for (uint i = 0; i < side * side; i++)
+			TerrainGenerator::heightmap(i % side, i / side, biome, heights.data() + i * TerrainGenerator::AREA);
+		double total = elapsedMs(start);
+		printf("Heightmaps with %s: %.2f us/chunk column, %.1f ns/voxel column\n", Noise::nameOf((InstructionSet)set),
+			total * 1000.0 / (side * side), total * 1e6 / (side * side * TerrainGenerator::AREA));
+	}
+	Noise::use(best);
+
+	ChunkMap map;
+	Clock::time_point start = Clock::now();
+	for (uint i = 0; i < side * side; i++)
+		for (int cy = 0; cy < 8; cy++)
+		{
+			VoxelChunk& chunk = map.getOrCreate(glm::ivec3(i % side, cy, i / side));
+			TerrainGenerator::generate(chunk, biome, heights.data() + i * TerrainGenerator::AREA);
+		}
+	double total = elapsedMs(start);
+	printf("Generated %u chunks in %.2f ms, %.1f us/chunk, %.1f KB\n", map.count(), total,
+		total * 1000.0 / map.count(), map.memoryUsage() / 1024.0);
+	return 0;
+}
+
+int Benchmark::streaming(uint viewDistance, uint frames)
+{
+	const double FRAME_MS = 1000.0 / 60;
+	const float SPEED = 1.0f; //Voxels per frame
+
+	ChunkMap map;
+	StreamSettings settings;
+	settings.viewDistance = viewDistance;
+	settings.maxLayer = 5;
+
+	size_t uploaded = 0, vertices = 0;
+	ChunkStreamer streamer(map, settings);
+	streamer.upload = [&](const ChunkMesh& mesh) { uploaded++; vertices += mesh.vertices.size(); };
+
+	StreamView view;
+	view.position = glm::vec3(0, 140, 0);
+	view.forward = glm::vec3(1, 0, 0);
+
+	double totalMs = 0, maxMs = 0;
+	uint firstComplete = 0;
+	for (uint frame = 0; frame < frames; frame++)
+	{
+		Clock::time_point start = Clock::now();
+		streamer.update(view);
+		double ms = elapsedMs(start);
+		totalMs += ms;
+		maxMs = std::max(maxMs, ms);
+		if (firstComplete == 0 && streamer.completedCount() == streamer.trackedCount())
+			firstComplete = frame + 1;
+
+		view.position.x += SPEED;
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(std::max(0.0, FRAME_MS - elapsedMs(start))));
+	}
+
+	printf("%u workers, view distance %u: update %.3f ms/frame avg, %.3f ms max\n", JobSystem::workerCount(),
+		viewDistance, totalMs / frames, maxMs);
+	if (firstComplete > 0)
+		printf("Every chunk in range was ready after %u frames\n", firstComplete);
+	printf("Uploaded %zu meshes, %zu vertices, %u chunks loaded (%.1f KB)\n", uploaded, vertices, map.count(),
+		map.memoryUsage() / 1024.0);
+	streamer.printStats();
+	return 0;
+}
+
+/// <summary>
+/// Streams count textures at 60 frames per second and prints how long it took.
+/// </summary>
+static void streamTextures(IRenderDevice* device, const std::vector<std::string>& files, uint count,
+	const TextureStreamSettings& settings, const char* title)
+{
+	const double FRAME_MS = 1000.0 / 60;
+	TextureStreamer streamer(device, settings);
+
+	Clock::time_point start = Clock::now();
+	for (uint i = 0; i < count; i++)
+		streamer.request(i, title, files[i % files.size()]);
+	double requestMs = elapsedMs(start);
+
+	uint frames = 0;
+	double maxMs = 0;
+	start = Clock::now();
+	while (streamer.pendingCount() > 0)
+	{
+		Clock::time_point frameStart = Clock::now();
+		streamer.update();
+		maxMs = std::max(maxMs, elapsedMs(frameStart));
+		frames++;
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(std::max(0.0, FRAME_MS - elapsedMs(frameStart))));
+	}
+
+	printf("%s: %u workers, requests %.2f ms, %u frames (%.2f ms) to load everything, update %.3f ms max\n",
+		title, JobSystem::workerCount(), requestMs, frames, elapsedMs(start), maxMs);
+	streamer.printStats();
+}
+
+int Benchmark::textures(uint count, float budgetMs)
+{
+	std::vector<std::string> files;
+	for (const auto& entry : std::filesystem::directory_iterator("res/textures"))
+		if (entry.is_regular_file())
+			files.push_back(entry.path().filename().string());
+	if (files.empty())
+	{
+		printf("No texture in res/textures\n");
+		return 1;
+	}
+
+	NullRenderDevice device;
+	Loader::device = &device;
+
+	Clock::time_point start = Clock::now();
+	for (uint i = 0; i < count; i++)
+		readTexture(i, "blocking", files[i % files.size()]);
+	double blockingMs = elapsedMs(start);
+	printf("Blocking: %u textures in %.2f ms on the render thread\n", count, blockingMs);
+
+	TextureStreamSettings settings;
+	settings.uploadMsPerFrame = budgetMs;
+	settings.compress = false;
+	streamTextures(&device, files, count, settings, "Decoded");
+
+	//Run twice, from an empty cache then with the mip chains it just cached. The cache is a temporary
+	//one, the cache of res/cache/textures is left as it is
+	settings.compress = true;
+	std::error_code error;
+	std::filesystem::path cache = std::filesystem::temp_directory_path(error) / "PixelEngineTextureCache";
+	std::filesystem::remove_all(cache, error);
+	TextureCache::directory = cache.string();
+	streamTextures(&device, files, count, settings, "Compressed, cold cache");
+	streamTextures(&device, files, count, settings, "Compressed, warm cache");
+	std::filesystem::remove_all(cache, error);
+	TextureCache::directory = TextureCache::DIRECTORY;
+	Loader::destroy();
+	return 0;
+}
+
+int Benchmark::obj(uint side)
+{
+	//Every face of side^3 unit cubes, like a voxel model exported without merging: the texture coordinates
+	//pick the color of the cube in a palette, so coplanar neighbours of the same color share their corners
+	static const int CORNERS[6][4][3] = {
+		{ { 1, 0, 0 }, { 1, 1, 0 }, { 1, 1, 1 }, { 1, 0, 1 } }, { { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 1 }, { 0, 1, 0 } },
+		{ { 0, 1, 0 }, { 0, 1, 1 }, { 1, 1, 1 }, { 1, 1, 0 } }, { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, 1 }, { 0, 0, 1 } },
+		{ { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } }, { { 0, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 } } };
+	Clock::time_point start = Clock::now();
+	std::string text = "# generated by the obj benchmark\n";
+	const uint points = side + 1;
+	char line[128];
+	for (uint z = 0; z < points; z++)
+		for (uint y = 0; y < points; y++)
+			for (uint x = 0; x < points; x++)
+			{
+				snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", x * 0.1, y * 0.1, z * 0.1);
+				text += line;
+			}
+	for (uint color = 0; color < 8; color++)
+	{
+		snprintf(line, sizeof(line), "vt %.4f 0.5\n", (color + 0.5) / 8);
+		text += line;
+	}
+	text += "vn 1 0 0\nvn -1 0 0\nvn 0 1 0\nvn 0 -1 0\nvn 0 0 1\nvn 0 0 -1\n";
+	for (uint z = 0; z < side; z++)
+		for (uint y = 0; y < side; y++)
+			for (uint x = 0; x < side; x++)
+				for (uint f = 0; f < 6; f++)
+				{
+					uint color = (x / 4 + y / 4 + z / 4) % 8 + 1;
+					int length = snprintf(line, sizeof(line), "f");
+					for (uint c = 0; c < 4; c++)
+					{
+						const int* corner = CORNERS[f][c];
+						uint position = ((z + corner[2]) * points + y + corner[1]) * points + x + corner[0] + 1;
+						length += snprintf(line + length, sizeof(line) - length, " %u/%u/%u", position, color, f + 1);
+					}
+					text += line;
+					text += '\n';
+				}
+	printf("Generated %u faces, %.1f MB of OBJ in %.1f ms\n", side * side * side * 6, text.size() / (1024.0 * 1024.0), elapsedMs(start));
+
+	ObjMesh mesh;
+	start = Clock::now();
+	if (!parseObj(text.data(), text.data() + text.size(), "generated", mesh))
+		return 1;
+	double ms = elapsedMs(start);
+	printf("Parsed in %.1f ms: %.1f MB/s, %.1f M faces/s, %zu vertices\n", ms,
+		text.size() / (1024.0 * 1024.0) / (ms / 1000), side * side * side * 6 / (ms * 1000), mesh.vertices.size());
+
+	start = Clock::now();
+	MeshStats stats = optimizeMesh(mesh);
+	mesh.narrowIndices();
+	ms = elapsedMs(start);
+	printf("Optimized in %.1f ms: %.1f M triangles/s, ACMR %.3f -> %.3f, %u vertices, %u %u bits indices\n", ms,
+		stats.triangles / (ms * 1000), stats.acmrBefore, stats.acmrAfter, stats.vertices, mesh.indexCount(),
+		mesh.indexType() == IndexType::UINT16 ? 16 : 32);
+	return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+/* Benchmarks run from the command line with --benchmark <name> [arguments], without a window.
+ * They print their results on stdout and return the exit code of the program.
+ */
+
+/// <summary>
+/// A static class running the benchmarks of the engine.
+/// </summary>
+class Benchmark
+{
+public:
+
+	/// <summary>
+	/// Runs the benchmark named by argv[2], with the arguments following it.
+	/// </summary>
+	static int run(int argc, char** argv);
+
+	/// <summary>
+	/// Updates the Transform of every entity of the World each frame, through a Query, first on one
+	/// thread then on all the workers. Half of the entities also have a Renderer, so the Query spans
+	/// two archetypes.
+	/// </summary>
+	/// <param name="entities">The number of entities created.</param>
+	/// <param name="frames">The number of frames measured.</param>
+	static int ecs(uint entities, uint frames);
+
+	/// <summary>
+	/// Meshes a rolling terrain of side * side columns of 2 chunks with the naive and the greedy mesher,
+	/// then meshes all of them in parallel.
+	/// </summary>
+	static int mesher(uint side);
+
+	/// <summary>
+	/// Computes the heightmaps of side * side chunk columns with each supported instruction set of the
+	/// noise, then generates the 8 chunks above each of them.
+	/// </summary>
+	static int terrain(uint side);
+
+	/// <summary>
+	/// Streams the terrain around a viewer flying along +x at 60 frames per second, then prints the
+	/// time spent in the streamer per frame and the stats of each stage.
+	/// </summary>
+	/// <param name="viewDistance">The radius of the streamed area, in chunks.</param>
+	/// <param name="frames">The number of frames simulated.</param>
+	static int streaming(uint viewDistance, uint frames);
+
+	/// <summary>
+	/// Loads count textures, cycling over the files of res/textures, on the Null device: first blocking
+	/// with readTexture(), then through a TextureStreamer updated at 60 frames per second, decoding the
+	/// files, then uploading their compressed mip chains from a temporary TextureCache, empty then warm.
+	/// Prints the time the render thread was blocked and the frames needed to stream everything.
+	/// </summary>
+	/// <param name="count">The number of textures loaded.</param>
+	/// <param name="budgetMs">The upload budget of the streamer per frame.</param>
+	static int textures(uint count, float budgetMs);
+
+	/// <summary>
+	/// Generates the OBJ text of every face of side^3 cubes in memory, parses it with parseObj() then
+	/// optimizes it with optimizeMesh().
+	/// </summary>
+	static int obj(uint side);
+};
@@ -0,0 +1,110 @@
+#include "Archetype.hpp"
+
+#include <cstring>
+#include <new>
+
+static uint alignUp(uint value, uint alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+static uint computeCapacity(ComponentMask mask)
+{
+	uint rowSize = sizeof(Entity);
+	uint columns = 1;
+	for (int t = 0; t < (int)ComponentType::COUNT; t++)
+	{
+		if ((mask & maskOf((ComponentType)t)) == 0)
+			continue;
+		for (uint size : componentLayout((ComponentType)t))
+		{
+			rowSize += size;
+			columns++;
+		}
+	}
+	//Every column can lose up to ALIGNMENT bytes to padding
+	return (Chunk::SIZE - columns * Chunk::ALIGNMENT) / rowSize;
+}
+
+Archetype::Archetype(ComponentMask mask) :
+	mask(mask), capacity(computeCapacity(mask))
+{
+	uint offset = alignUp(capacity * sizeof(Entity), Chunk::ALIGNMENT);
+	for (int t = 0; t < (int)ComponentType::COUNT; t++)
+	{
+		firstColumn[t] = -1;
+		if ((mask & maskOf((ComponentType)t)) == 0)
+			continue;
+
+		firstColumn[t] = (int)offsets.size();
+		for (uint size : componentLayout((ComponentType)t))
+		{
+			columnTypes.push_back((ComponentType)t);
+			sizes.push_back(size);
+			offsets.push_back(offset);
+			offset = alignUp(offset + capacity * size, Chunk::ALIGNMENT);
+		}
+	}
+}
+
+Archetype::~Archetype()
+{
+	for (Chunk& chunk : chunks)
+		::operator delete(chunk.data, std::align_val_t(Chunk::ALIGNMENT));
+}
+
+uint Archetype::size() const
+{
+	//Only the last chunk can be partially filled
+	return chunks.empty() ? 0 : (uint)(chunks.size() - 1) * capacity + chunks.back().count;
+}
+
+void Archetype::allocate(Entity entity, uint& chunk, uint& row)
+{
+	if (chunks.empty() || chunks.back().count == capacity)
+		chunks.push_back({ (uint8*)::operator new(Chunk::SIZE, std::align_val_t(Chunk::ALIGNMENT)), 0 });
+
+	chunk = (uint)chunks.size() - 1;
+	Chunk& c = chunks[chunk];
+	row = c.count++;
+
+	entities(c)[row] = entity;
+	for (uint i = 0; i < offsets.size(); i++)
+		memset(c.data + offsets[i] + row * sizes[i], 0, sizes[i]);
+}
+
+Entity Archetype::remove(uint chunk, uint row)
+{
+	Chunk& last = chunks.back();
+	uint lastRow = last.count - 1;
+	Entity moved = NULL_ENTITY;
+
+	if (&chunks[chunk] != &last || row != lastRow)
+	{
+		Chunk& c = chunks[chunk];
+		moved = entities(last)[lastRow];
+		entities(c)[row] = moved;
+		for (uint i = 0; i < offsets.size(); i++)
+			memcpy(c.data + offsets[i] + row * sizes[i], last.data + offsets[i] + lastRow * sizes[i], sizes[i]);
+	}
+
+	if (--last.count == 0)
+	{
+		::operator delete(last.data, std::align_val_t(Chunk::ALIGNMENT));
+		chunks.pop_back();
+	}
+	return moved;
+}
+
+void Archetype::copyRow(const Archetype& source, uint sourceChunk, uint sourceRow, uint chunk, uint row)
+{
+	const Chunk& from = source.chunks[sourceChunk];
+	Chunk& to = chunks[chunk];
+	for (uint i = 0; i < offsets.size(); i++)
+	{
+		int sourceColumn = source.firstColumn[(int)columnTypes[i]];
+		if (sourceColumn < 0)
+			continue;
+
+		//Columns of a type are consecutive, so the field is the distance to the first column
+		sourceColumn += i - firstColumn[(int)columnTypes[i]];
+		memcpy(to.data + offsets[i] + row * sizes[i], from.data + source.offsets[sourceColumn] + sourceRow * sizes[i], sizes[i]);
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Components.hpp"
+
+#include <vector>
+
+/// <summary>
+/// A fixed size block of memory holding the rows of an archetype, column by column.
+/// </summary>
+struct Chunk
+{
+	static constexpr uint SIZE = 16 * 1024; //Fits in L1 with room to spare
+	static constexpr uint ALIGNMENT = 64;   //Every column starts on a cache line
+
+	uint8* data;
+	uint count;  //Number of rows used
+};
+
+/// <summary>
+/// Stores all the entities having exactly the same set of components. Each component is stored in
+/// columns (see componentLayout()), each chunk holding `capacity` rows of every column plus the
+/// entity of each row. Rows are kept packed: removing a row moves the last row of the archetype in it.
+/// </summary>
+class Archetype
+{
+public:
+
+	const ComponentMask mask;
+	const uint capacity;          //Rows per chunk
+	std::vector<Chunk> chunks;
+
+	Archetype(ComponentMask mask);
+	~Archetype();
+
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	/// <summary>
+	/// Returns whether the archetype stores the given type.
+	/// </summary>
+	bool has(ComponentType type) const { return (mask & maskOf(type)) != 0; }
+
+	/// <summary>
+	/// Returns the entities stored in the chunk, one per row.
+	/// </summary>
+	Entity* entities(const Chunk& chunk) const { return (Entity*)chunk.data; }
+
+	/// <summary>
+	/// Returns a column of the chunk. The archetype must have the type.
+	/// </summary>
+	/// <typeparam name="T">The type of the elements, its' size must match the column.</typeparam>
+	/// <param name="field">The column of the type, 0 for single column types.</param>
+	template<typename T>
+	T* column(const Chunk& chunk, ComponentType type, uint field = 0) const
+	{
+		return (T*)(chunk.data + offsets[firstColumn[(int)type] + field]);
+	}
+
+	/// <summary>
+	/// Returns the number of rows stored in all the chunks.
+	/// </summary>
+	uint size() const;
+
+	/// <summary>
+	/// Adds a zeroed row for the entity at the end of the archetype.
+	/// </summary>
+	/// <param name="chunk">The index of the chunk of the row.</param>
+	/// <param name="row">The index of the row in the chunk.</param>
+	void allocate(Entity entity, uint& chunk, uint& row);
+
+	/// <summary>
+	/// Removes a row by moving the last row of the archetype in it.
+	/// </summary>
+	/// <returns>The entity that was moved in the row, NULL_ENTITY if the row was the last one.</returns>
+	Entity remove(uint chunk, uint row);
+
+	/// <summary>
+	/// Copies the columns both archetypes have from a row of the source to a row of this archetype.
+	/// </summary>
+	void copyRow(const Archetype& source, uint sourceChunk, uint sourceRow, uint chunk, uint row);
+
+private:
+
+	std::vector<ComponentType> columnTypes; //Type stored in each column
+	std::vector<uint> sizes;                //Size of the elements of each column
+	std::vector<uint> offsets;              //Offset of each column from the start of a chunk
+	int firstColumn[(int)ComponentType::COUNT]; //First column of each type, -1 if absent
+};
@@ -0,0 +1,16 @@
+#include "Components.hpp"
+
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<Renderer>, "Components are moved with memcpy");
+
+static const std::vector<uint> layouts[(int)ComponentType::COUNT] =
+{
+	{ sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(float) }, //TRANSFORM, one column per Field
+	{ sizeof(Renderer) }                                                           //RENDERER
+};
+
+const std::vector<uint>& componentLayout(ComponentType type)
+{
+	return layouts[(int)type];
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Entity.hpp"
+#include "util/Utility.hpp"
+
+#include <vector>
+#include "glm/vec2.hpp"
+
+/* Every type of component the World can store. A component type is stored in one or more columns:
+ * most components are a single column of structs, but the Transform is split in one column per
+ * field, so systems that only read a few fields don't load the others.
+ * Components are copied with memcpy when entities change archetype, so they must be trivially copyable.
+ */
+
+struct Texture;
+struct Material;
+struct GameObject;
+
+enum class ComponentType
+{
+	TRANSFORM,
+	RENDERER,
+	COUNT
+};
+
+typedef uint ComponentMask; //One bit per ComponentType
+
+/// <summary>
+/// Returns the mask with only the bit of the given type.
+/// </summary>
+inline constexpr ComponentMask maskOf(ComponentType type) { return 1u << (uint)type; }
+
+/// <summary>
+/// Returns the size in bytes of each column used to store the given type.
+/// </summary>
+const std::vector<uint>& componentLayout(ComponentType type);
+
+/// <summary>
+/// The position, zIndex, rotation and scale of an entity. This is a copy, the World stores each
+/// field in its' own column.
+/// </summary>
+struct Transform
+{
+	static constexpr ComponentType TYPE = ComponentType::TRANSFORM;
+
+	//Columns of the transform in the World
+	enum Field
+	{
+		POSITION_X,
+		POSITION_Y,
+		Z_INDEX,
+		ROTATION,
+		SCALE
+	};
+
+	glm::vec2 position = glm::vec2(0, 0);
+	float zIndex = 0;
+	float rotation = 0; //In degrees
+	float scale = 1;
+};
+
+/// <summary>
+/// The base class for all Components. Components are added to GameObjects only by creating them.
+/// </summary>
+struct Component
+{
+	uint id;                //Is unique for each type of component (for now defined through JSON)
+	Entity entity;          //Handle of the GameObject that has this component
+	bool enabled = true;    //If disabled, the component will be skipped during it's processing
+
+	Component(uint id, Entity entity) :
+		id{ id }, entity{ entity }{}
+};
+
+/// <summary>
+/// The main Rendering component for all sprites.
+/// </summary>
+struct Renderer : Component
+{
+	static constexpr ComponentType TYPE = ComponentType::RENDERER;
+
+	Texture* texture;     //Pointer to the texture rendered (defaults to blank square if null)
+	Material* material;   //Pointer to the material used by the renderer (defaults to default material)
+
+	Renderer(uint id, Entity entity, Texture* texture, Material* material) :
+		Component{ id, entity }, texture{ texture }, material{ material } {}
+
+	/// <summary>
+	/// Adds a Renderer to the GameObject.
+	/// </summary>
+	/// <returns>A reference to the Renderer, valid until the next entity changes archetype.</returns>
+	static Renderer& create(uint id, GameObject& gameObject, Texture* texture, Material* material);
+};
@@ -0,0 +1,42 @@
+#include "Entity.hpp"
+
+std::vector<uint> EntityManager::generations;
+std::vector<uint> EntityManager::freeIndices;
+
+Entity EntityManager::create()
+{
+	if (!freeIndices.empty())
+	{
+		uint index = freeIndices.back();
+		freeIndices.pop_back();
+		return { index, generations[index] };
+	}
+
+	generations.push_back(0);
+	return { (uint)generations.size() - 1, 0 };
+}
+
+void EntityManager::destroy(Entity entity)
+{
+	if (!isAlive(entity))
+		return;
+
+	generations[entity.index]++;
+	freeIndices.push_back(entity.index);
+}
+
+bool EntityManager::isAlive(Entity entity)
+{
+	return entity.index < generations.size() && generations[entity.index] == entity.generation;
+}
+
+uint EntityManager::count()
+{
+	return (uint)(generations.size() - freeIndices.size());
+}
+
+void EntityManager::clear()
+{
+	generations.clear();
+	freeIndices.clear();
+}
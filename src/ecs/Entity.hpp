@@ -0,0 +1,62 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+#include <vector>
+
+/* Entities are only handles: an index and a generation. The index is used to find the components of
+ * the entity in the World, the generation tells if the handle is still valid. When an entity is
+ * destroyed its' index is recycled with a greater generation, so old handles stop matching.
+ */
+
+/// <summary>
+/// Handle of an entity. Compare it with NULL_ENTITY to know if it's set.
+/// </summary>
+struct Entity
+{
+	uint index;
+	uint generation;
+
+	bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+inline constexpr Entity NULL_ENTITY{ 0xFFFFFFFF, 0 };
+
+/// <summary>
+/// A static class that creates, destroys and validates entity handles.
+/// </summary>
+class EntityManager
+{
+public:
+
+	/// <summary>
+	/// Creates a new entity, reusing the index of a destroyed one if possible.
+	/// </summary>
+	static Entity create();
+
+	/// <summary>
+	/// Destroys the entity, its' handle becomes invalid. The components must be removed by the caller.
+	/// </summary>
+	static void destroy(Entity entity);
+
+	/// <summary>
+	/// Returns whether the handle points to a living entity.
+	/// </summary>
+	static bool isAlive(Entity entity);
+
+	/// <summary>
+	/// Returns the number of living entities.
+	/// </summary>
+	static uint count();
+
+	/// <summary>
+	/// Destroys all the entities and forgets the generations.
+	/// </summary>
+	static void clear();
+
+private:
+
+	static std::vector<uint> generations; //Current generation of each index
+	static std::vector<uint> freeIndices; //Indices of destroyed entities, reused first
+};
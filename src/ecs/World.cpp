@@ -0,0 +1,136 @@
+#include "World.hpp"
+
+std::vector<World::Location> World::locations;
+std::vector<Archetype*> World::archetypes;
+std::unordered_map<ComponentMask, Archetype*> World::archetypeByMask;
+uint World::generation = 0;
+
+#pragma region World
+
+Archetype* World::getArchetype(ComponentMask mask)
+{
+	auto it = archetypeByMask.find(mask);
+	if (it != archetypeByMask.end())
+		return it->second;
+
+	Archetype* archetype = new Archetype(mask);
+	archetypes.push_back(archetype);
+	archetypeByMask[mask] = archetype;
+	return archetype;
+}
+
+Entity World::create(ComponentMask mask)
+{
+	Entity entity = EntityManager::create();
+	if (entity.index >= locations.size())
+		locations.resize(entity.index + 1);
+
+	Location& l = locations[entity.index];
+	l.archetype = getArchetype(mask);
+	l.archetype->allocate(entity, l.chunk, l.row);
+	return entity;
+}
+
+void World::removeRow(const Location& location)
+{
+	Entity moved = location.archetype->remove(location.chunk, location.row);
+	if (moved != NULL_ENTITY)
+	{
+		locations[moved.index].chunk = location.chunk;
+		locations[moved.index].row = location.row;
+	}
+}
+
+void World::destroy(Entity entity)
+{
+	if (!EntityManager::isAlive(entity))
+		return;
+
+	removeRow(locations[entity.index]);
+	locations[entity.index].archetype = nullptr;
+	EntityManager::destroy(entity);
+}
+
+void World::move(Entity entity, ComponentMask mask)
+{
+	Location from = locations[entity.index];
+	Location& to = locations[entity.index];
+
+	to.archetype = getArchetype(mask);
+	to.archetype->allocate(entity, to.chunk, to.row);
+	to.archetype->copyRow(*from.archetype, from.chunk, from.row, to.chunk, to.row);
+	removeRow(from);
+}
+
+void World::addComponent(Entity entity, ComponentType type)
+{
+	ComponentMask mask = maskOf(entity);
+	if (!EntityManager::isAlive(entity) || (mask & ::maskOf(type)) != 0)
+		return;
+	move(entity, mask | ::maskOf(type));
+}
+
+void World::removeComponent(Entity entity, ComponentType type)
+{
+	ComponentMask mask = maskOf(entity);
+	if ((mask & ::maskOf(type)) == 0)
+		return;
+	move(entity, mask & ~::maskOf(type));
+}
+
+bool World::has(Entity entity, ComponentType type)
+{
+	return (maskOf(entity) & ::maskOf(type)) != 0;
+}
+
+ComponentMask World::maskOf(Entity entity)
+{
+	if (!EntityManager::isAlive(entity))
+		return 0;
+	return locations[entity.index].archetype->mask;
+}
+
+void World::clear()
+{
+	for (Archetype* archetype : archetypes)
+		delete archetype;
+
+	archetypes.clear();
+	archetypeByMask.clear();
+	locations.clear();
+	EntityManager::clear();
+	generation++; //The queries drop the archetypes they matched
+}
+
+#pragma endregion
+
+#pragma region Query
+
+void Query::refresh()
+{
+	const std::vector<Archetype*>& archetypes = World::getArchetypes();
+	if (generation != World::getGeneration()) //The World was cleared, even if it has as many archetypes again
+	{
+		matching.clear();
+		archetypesSeen = 0;
+		generation = World::getGeneration();
+	}
+
+	for (; archetypesSeen < archetypes.size(); archetypesSeen++)
+	{
+		Archetype* archetype = archetypes[archetypesSeen];
+		if ((archetype->mask & required) == required && (archetype->mask & excluded) == 0)
+			matching.push_back(archetype);
+	}
+}
+
+uint Query::count()
+{
+	refresh();
+	uint count = 0;
+	for (Archetype* archetype : matching)
+		count += archetype->size();
+	return count;
+}
+
+#pragma endregion
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Archetype.hpp"
+#include "Entity.hpp"
+#include "jobs/JobSystem.hpp"
+
+#include <vector>
+#include <unordered_map>
+
+/* The World stores the components of every entity, grouped by archetype: all the entities having the
+ * same set of components are stored together, in the chunks of the same Archetype. Adding or removing
+ * a component moves the entity to another archetype, so pointers to components are only valid until
+ * the next structural change (create, destroy, add or remove).
+ *
+ * Systems don't look entities up one by one, they use a Query to iterate the chunks of every
+ * archetype having the components they need, which is a linear sweep over contiguous columns.
+ */
+
+/// <summary>
+/// A static class that stores the components of all the entities.
+/// </summary>
+class World
+{
+public:
+
+	/// <summary>
+	/// Creates an entity with the given components, all zeroed.
+	/// </summary>
+	static Entity create(ComponentMask mask);
+
+	/// <summary>
+	/// Destroys the entity and all its' components.
+	/// </summary>
+	static void destroy(Entity entity);
+
+	/// <summary>
+	/// Adds a zeroed component to the entity, nothing happens if it already has one.
+	/// </summary>
+	static void addComponent(Entity entity, ComponentType type);
+
+	/// <summary>
+	/// Removes the component from the entity, nothing happens if it doesn't have one.
+	/// </summary>
+	static void removeComponent(Entity entity, ComponentType type);
+
+	/// <summary>
+	/// Returns whether the entity has the component.
+	/// </summary>
+	static bool has(Entity entity, ComponentType type);
+
+	/// <summary>
+	/// Returns the set of components of the entity, 0 if it isn't alive.
+	/// </summary>
+	static ComponentMask maskOf(Entity entity);
+
+	/// <summary>
+	/// Returns a column element of the entity, nullptr if it doesn't have the component.
+	/// </summary>
+	/// <param name="field">The column of the type, 0 for single column types.</param>
+	template<typename T>
+	static T* get(Entity entity, ComponentType type, uint field = 0)
+	{
+		if (!has(entity, type))
+			return nullptr;
+		const Location& l = locations[entity.index];
+		return l.archetype->column<T>(l.archetype->chunks[l.chunk], type, field) + l.row;
+	}
+
+	/// <summary>
+	/// Returns the component of the entity, nullptr if it doesn't have one.
+	/// </summary>
+	template<typename T>
+	static T* get(Entity entity) { return get<T>(entity, T::TYPE); }
+
+	/// <summary>
+	/// Returns every archetype created so far, in order of creation.
+	/// </summary>
+	static const std::vector<Archetype*>& getArchetypes() { return archetypes; }
+
+	/// <summary>
+	/// Returns the number of calls to clear() so far, the archetypes of a generation are never destroyed
+	/// before the next one.
+	/// </summary>
+	static uint getGeneration() { return generation; }
+
+	/// <summary>
+	/// Destroys all the entities and the archetypes.
+	/// </summary>
+	static void clear();
+
+private:
+
+	/// <summary>
+	/// Where the components of an entity are stored.
+	/// </summary>
+	struct Location
+	{
+		Archetype* archetype;
+		uint chunk;
+		uint row;
+	};
+
+	static std::vector<Location> locations; //By entity index
+	static std::vector<Archetype*> archetypes;
+	static std::unordered_map<ComponentMask, Archetype*> archetypeByMask;
+	static uint generation;                 //Incremented by clear()
+
+	/// <summary>
+	/// Returns the archetype of the mask, creating it if needed.
+	/// </summary>
+	static Archetype* getArchetype(ComponentMask mask);
+
+	/// <summary>
+	/// Moves the entity to the archetype of the given mask, keeping the components both have.
+	/// </summary>
+	static void move(Entity entity, ComponentMask mask);
+
+	/// <summary>
+	/// Removes the row of the entity from its' archetype and fixes the location of the moved entity.
+	/// </summary>
+	static void removeRow(const Location& location);
+};
+
+/// <summary>
+/// Iterates the chunks of every archetype having all the required components and none of the
+/// excluded ones. The matching archetypes are cached and only refreshed when new ones are created, or
+/// when the World is cleared.
+/// </summary>
+class Query
+{
+public:
+
+	Query(ComponentMask required, ComponentMask excluded = 0) :
+		required(required), excluded(excluded) {}
+
+	/// <summary>
+	/// Calls function(Archetype&amp;, Chunk&amp;) on every matching chunk. Structural changes are not
+	/// allowed while iterating.
+	/// </summary>
+	template<typename F>
+	void forEach(F&& function)
+	{
+		refresh();
+		for (Archetype* archetype : matching)
+			for (Chunk& chunk : archetype->chunks)
+				function(*archetype, chunk);
+	}
+
+	/// <summary>
+	/// Calls function(Archetype&amp;, Chunk&amp;, uint firstRow) on every matching chunk, in parallel on the
+	/// JobSystem. firstRow is the number of rows in the chunks before this one, in forEach() order.
+	/// Structural changes are not allowed while iterating.
+	/// </summary>
+	template<typename F>
+	void forEachParallel(F&& function)
+	{
+		refresh();
+		chunks.clear();
+		uint rows = 0;
+		for (Archetype* archetype : matching)
+			for (Chunk& chunk : archetype->chunks)
+			{
+				chunks.push_back({ archetype, &chunk, rows });
+				rows += chunk.count;
+			}
+
+		JobSystem::parallelFor(0, (uint)chunks.size(), 0, [&](uint first, uint last)
+		{
+			for (uint i = first; i < last; i++)
+				function(*chunks[i].archetype, *chunks[i].chunk, chunks[i].firstRow);
+		});
+	}
+
+	/// <summary>
+	/// Returns the number of entities matching the query.
+	/// </summary>
+	uint count();
+
+private:
+
+	ComponentMask required;
+	ComponentMask excluded;
+	std::vector<Archetype*> matching;
+
+	struct ChunkRef
+	{
+		Archetype* archetype;
+		Chunk* chunk;
+		uint firstRow;
+	};
+	std::vector<ChunkRef> chunks; //Kept between calls of forEachParallel to avoid reallocations
+
+	uint archetypesSeen = 0; //Number of World archetypes already tested
+	uint generation = 0;     //World generation of the archetypes in matching
+
+	/// <summary>
+	/// Tests the archetypes created since the last refresh.
+	/// </summary>
+	void refresh();
+};
@@ -0,0 +1,171 @@
+#include "AssetBlob.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+static_assert(std::endian::native == std::endian::little, "Blobs are little endian and read in place");
+
+/// <summary>
+/// Where a table is stored in a blob.
+/// </summary>
+struct BlobTable
+{
+	uint offset;
+	uint count;
+	uint recordSize;
+};
+
+struct BlobHeader
+{
+	char magic[4];
+	uint version;
+	uint64 sourceTime;
+	BlobTable tables[(int)AssetTable::COUNT];
+	BlobTable strings;   //recordSize is 1
+};
+
+static const char MAGIC[4] = { 'P', 'X', 'A', 'B' };
+static const uint ALIGNMENT = 8;
+
+static const uint RECORD_SIZES[(int)AssetTable::COUNT] =
+{
+	sizeof(TextureRecord),
+	sizeof(MaterialRecord),
+	sizeof(GameObjectRecord),
+	sizeof(VertexShaderRecord),
+	sizeof(GeometryShaderRecord),
+	sizeof(FragmentShaderRecord),
+	sizeof(ShaderRecord),
+	sizeof(BiomeRecord)
+};
+
+#pragma region AssetTables
+
+AssetTables::AssetTables() :
+	strings(1, '\0')
+{
+	stringOffsets[""] = 0;
+}
+
+uint AssetTables::addString(constring string)
+{
+	std::lock_guard<std::mutex> lock(stringsMutex);
+	auto it = stringOffsets.find(string);
+	if (it != stringOffsets.end())
+		return it->second;
+
+	uint offset = (uint)strings.size();
+	strings.append(string.c_str(), string.size() + 1);
+	stringOffsets[string] = offset;
+	return offset;
+}
+
+AssetView AssetTables::view() const
+{
+	AssetView view;
+	for (int t = 0; t < (int)AssetTable::COUNT; t++)
+	{
+		view.tables[t].data = tables[t].data();
+		view.tables[t].count = (uint)(tables[t].size() / RECORD_SIZES[t]);
+	}
+	view.strings = strings.data();
+	view.stringsSize = (uint)strings.size();
+	return view;
+}
+
+size_t AssetTables::save(constring path, uint64 sourceTime) const
+{
+	BlobHeader header = {};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = AssetBlob::VERSION;
+	header.sourceTime = sourceTime;
+
+	auto align = [](size_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; };
+	size_t offset = align(sizeof(BlobHeader));
+	for (int t = 0; t < (int)AssetTable::COUNT; t++)
+	{
+		header.tables[t] = { (uint)offset, (uint)(tables[t].size() / RECORD_SIZES[t]), RECORD_SIZES[t] };
+		offset = align(offset + tables[t].size());
+	}
+	header.strings = { (uint)offset, (uint)strings.size(), 1 };
+	size_t size = offset + strings.size();
+
+	std::vector<uint8> blob(size, 0);
+	memcpy(blob.data(), &header, sizeof(header));
+	for (int t = 0; t < (int)AssetTable::COUNT; t++)
+		if (!tables[t].empty())
+			memcpy(blob.data() + header.tables[t].offset, tables[t].data(), tables[t].size());
+	memcpy(blob.data() + header.strings.offset, strings.data(), strings.size());
+
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.write((const char*)blob.data(), blob.size()))
+		return 0;
+	return size;
+}
+
+#pragma endregion
+
+#pragma region AssetBlob
+
+bool AssetBlob::open(constring path)
+{
+	records = AssetView();
+	if (!file.open(path))
+		return false;
+
+	auto reject = [&](const char* reason)
+	{
+		printf("Ignoring %s: %s\n", path.c_str(), reason);
+		file.close();
+		return false;
+	};
+
+	if (file.size() < sizeof(BlobHeader))
+		return reject("truncated header");
+
+	const BlobHeader& header = *(const BlobHeader*)file.data();
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+		return reject("not an asset blob");
+	if (header.version != VERSION)
+		return reject("cooked by another version of the engine");
+
+	for (int t = 0; t < (int)AssetTable::COUNT; t++)
+	{
+		const BlobTable& table = header.tables[t];
+		if (table.recordSize != RECORD_SIZES[t] || table.offset % ALIGNMENT != 0
+			|| table.offset + (uint64)table.count * table.recordSize > file.size())
+			return reject("corrupted table");
+		records.tables[t].data = file.data() + table.offset;
+		records.tables[t].count = table.count;
+	}
+
+	const BlobTable& strings = header.strings;
+	if (strings.count == 0 || strings.offset + (uint64)strings.count > file.size()
+		|| file.data()[strings.offset + strings.count - 1] != '\0')
+		return reject("corrupted string table");
+	records.strings = (const char*)file.data() + strings.offset;
+	records.stringsSize = strings.count;
+
+	cookedFrom = header.sourceTime;
+	return true;
+}
+
+uint64 AssetBlob::newestSource()
+{
+	std::error_code error;
+	uint64 newest = 0;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(SOURCES, error))
+	{
+		if (entry.path().extension() != ".json")
+			continue;
+		uint64 time = (uint64)entry.last_write_time(error).time_since_epoch().count();
+		newest = std::max(newest, time);
+	}
+	return newest;
+}
+
+#pragma endregion
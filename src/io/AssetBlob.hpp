@@ -0,0 +1,237 @@
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* The JSON files of res/data are validated once by the cook step (--cook) which writes all their records
+ * in a single binary blob, res/data/assets.bin. At startup the blob is mapped and its' records are read
+ * in place, nothing is parsed.
+ *
+ * Layout, little endian, every table aligned on 8 bytes:
+ *   BlobHeader
+ *   one table per AssetTable: `count` records of `recordSize` bytes
+ *   the string table: every string null terminated, the first one being ""
+ *
+ * Records only hold numbers, their strings are offsets in the string table. The same records are built
+ * in memory by the JSON loaders (AssetTables), so the engine reads both sources through an AssetView.
+ * Changing a record or the layout requires incrementing AssetBlob::VERSION.
+ */
+
+enum class AssetTable
+{
+	TEXTURES,
+	MATERIALS,
+	GAMEOBJECTS,
+	VERTEX_SHADERS,
+	GEOMETRY_SHADERS,
+	FRAGMENT_SHADERS,
+	SHADERS,
+	BIOMES,
+	COUNT
+};
+
+#pragma region Records
+
+struct TextureRecord
+{
+	static constexpr AssetTable TABLE = AssetTable::TEXTURES;
+	uint id;
+	uint name;  //Offset in the string table
+	uint path;  //Relative to res/textures
+};
+
+struct MaterialRecord
+{
+	static constexpr AssetTable TABLE = AssetTable::MATERIALS;
+	uint id;
+	uint name;
+	uint shader;
+	float shineDamper;
+	float reflectivity;
+};
+
+struct GameObjectRecord
+{
+	static constexpr AssetTable TABLE = AssetTable::GAMEOBJECTS;
+	uint id;
+	uint name;
+	float x, y;
+	float zIndex;
+	float rotation;
+	float scale;
+};
+
+/// <summary>
+/// A vertex, geometry or fragment shader, depending on its' table.
+/// </summary>
+struct ShaderStageRecord
+{
+	uint id;
+	uint name;
+	uint path;  //Relative to res/shaders
+};
+
+struct VertexShaderRecord : ShaderStageRecord { static constexpr AssetTable TABLE = AssetTable::VERTEX_SHADERS; };
+struct GeometryShaderRecord : ShaderStageRecord { static constexpr AssetTable TABLE = AssetTable::GEOMETRY_SHADERS; };
+struct FragmentShaderRecord : ShaderStageRecord { static constexpr AssetTable TABLE = AssetTable::FRAGMENT_SHADERS; };
+
+struct ShaderRecord
+{
+	static constexpr AssetTable TABLE = AssetTable::SHADERS;
+	uint id;
+	uint name;
+	int vertex;    //Indices of the stages, -1 if absent
+	int geometry;
+	int fragment;
+};
+
+struct BiomeRecord
+{
+	static constexpr AssetTable TABLE = AssetTable::BIOMES;
+	uint id;
+	uint name;
+	float minTemperature, maxTemperature;
+	float minPrecipitation, maxPrecipitation;
+	float height;
+	uint octaves;
+	float frequency, amplitude, lacunarity, persistence;
+	int surface, subsurface;
+	uint subsurfaceDepth;
+	int stone;
+};
+
+#pragma endregion
+
+/// <summary>
+/// Read access to the records of every table, wherever they are stored.
+/// </summary>
+class AssetView
+{
+public:
+
+	/// <summary>
+	/// Returns all the records of a type.
+	/// </summary>
+	template<typename T>
+	std::span<const T> records() const
+	{
+		const Table& table = tables[(int)T::TABLE];
+		return std::span<const T>((const T*)table.data, table.count);
+	}
+
+	/// <summary>
+	/// Returns a string of the string table, "" if the offset is out of it.
+	/// </summary>
+	const char* string(uint offset) const { return offset < stringsSize ? strings + offset : ""; }
+
+private:
+
+	friend class AssetTables;
+	friend class AssetBlob;
+
+	struct Table
+	{
+		const void* data = nullptr;
+		uint count = 0;
+	};
+
+	Table tables[(int)AssetTable::COUNT];
+	const char* strings = "";
+	uint stringsSize = 1;
+};
+
+/// <summary>
+/// Records built in memory, by the JSON loaders.
+/// </summary>
+class AssetTables
+{
+public:
+
+	AssetTables();
+
+	/// <summary>
+	/// Adds a string to the string table, only once. Thread safe.
+	/// </summary>
+	/// <returns>Its' offset.</returns>
+	uint addString(constring string);
+
+	/// <summary>
+	/// Appends a record to its' table. Different tables can be filled by different threads.
+	/// </summary>
+	template<typename T>
+	void add(const T& record)
+	{
+		std::vector<uint8>& table = tables[(int)T::TABLE];
+		const uint8* bytes = (const uint8*)&record;
+		table.insert(table.end(), bytes, bytes + sizeof(T));
+	}
+
+	/// <summary>
+	/// Returns the number of records of a type.
+	/// </summary>
+	template<typename T>
+	uint count() const { return (uint)(tables[(int)T::TABLE].size() / sizeof(T)); }
+
+	/// <summary>
+	/// Returns a view of the records, valid until the next add.
+	/// </summary>
+	AssetView view() const;
+
+	/// <summary>
+	/// Writes the records in a blob.
+	/// </summary>
+	/// <param name="sourceTime">The modification time of the newest source, see AssetBlob::newestSource().</param>
+	/// <returns>The size of the blob, 0 if it couldn't be written.</returns>
+	size_t save(constring path, uint64 sourceTime) const;
+
+private:
+
+	std::vector<uint8> tables[(int)AssetTable::COUNT];
+	std::string strings;
+	std::unordered_map<std::string, uint> stringOffsets;
+	std::mutex stringsMutex;
+};
+
+/// <summary>
+/// Records mapped from a cooked blob.
+/// </summary>
+class AssetBlob
+{
+public:
+
+	static constexpr uint VERSION = 2;
+	static constexpr const char* PATH = "res/data/assets.bin";
+	static constexpr const char* SOURCES = "res/data"; //Cooked from the JSON files of this directory
+
+	/// <summary>
+	/// Maps a blob and checks its' header and the bounds of its' tables.
+	/// </summary>
+	/// <returns>Whether the blob can be used.</returns>
+	bool open(constring path);
+
+	/// <summary>
+	/// Returns the records of the blob, valid while it's open.
+	/// </summary>
+	const AssetView& view() const { return records; }
+
+	/// <summary>
+	/// Returns the modification time of the newest source when the blob was cooked.
+	/// </summary>
+	uint64 sourceTime() const { return cookedFrom; }
+
+	/// <summary>
+	/// Returns the modification time of the newest JSON file of the sources, 0 if there are none.
+	/// </summary>
+	static uint64 newestSource();
+
+private:
+
+	MappedFile file;
+	AssetView records;
+	uint64 cookedFrom = 0;
+};
@@ -0,0 +1,253 @@
+#include "AssetPack.hpp"
+#include "AssetBlob.hpp"
+#include "LZ4.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+static_assert(std::endian::native == std::endian::little, "Packs are little endian and read in place");
+
+struct PackHeader
+{
+	char magic[4];
+	uint version;
+	uint64 sourceTime;   //The modification time of the newest loose file when it was packed
+	uint entryCount;
+	uint pathsSize;      //The paths follow the table of contents
+};
+
+static const char MAGIC[4] = { 'P', 'X', 'P', 'K' };
+static const char* SOURCES[] = { "res/textures", "res/shaders", "res/wren", "res/data" };
+
+MappedFile AssetPack::file;
+const PackEntry* AssetPack::entries = nullptr;
+uint AssetPack::entryCount = 0;
+const char* AssetPack::paths = "";
+uint AssetPack::pathsSize = 0;
+
+static char normalized(char c) { return c == '\\' ? '/' : c; }
+
+uint64 AssetPack::hash(constring path)
+{
+	if (path.find('\\') == std::string::npos)
+		return fnv1a(path.data(), path.size());
+
+	std::string slashes = path;
+	std::replace(slashes.begin(), slashes.end(), '\\', '/');
+	return fnv1a(slashes.data(), slashes.size());
+}
+
+bool AssetPack::open(bool checkSources, constring path)
+{
+	close();
+	if (!file.open(path))
+		return false;
+
+	auto reject = [&](const char* reason)
+	{
+		printf("Ignoring %s: %s\n", path.c_str(), reason);
+		close();
+		return false;
+	};
+
+	if (file.size() < sizeof(PackHeader))
+		return reject("truncated header");
+	const PackHeader& header = *(const PackHeader*)file.data();
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+		return reject("not an asset pack");
+	if (header.version != VERSION)
+		return reject("packed by another version of the engine");
+
+	uint64 pathsOffset = sizeof(PackHeader) + (uint64)header.entryCount * sizeof(PackEntry);
+	if (header.pathsSize == 0 || pathsOffset + header.pathsSize > file.size()
+		|| file.data()[pathsOffset + header.pathsSize - 1] != '\0')
+		return reject("corrupted table of contents");
+	const PackEntry* table = (const PackEntry*)(file.data() + sizeof(PackHeader));
+	for (uint i = 0; i < header.entryCount; i++)
+	{
+		const PackEntry& entry = table[i];
+		if (entry.path >= header.pathsSize || entry.compression > (uint)PackCompression::LZ4
+			|| entry.offset > file.size() || entry.storedSize > file.size() - entry.offset
+			|| (entry.compression == (uint)PackCompression::NONE && entry.storedSize != entry.size)
+			|| (i > 0 && table[i - 1].hash > entry.hash))
+			return reject("corrupted entry");
+	}
+
+	//Checked last, the header being valid
+	if (checkSources && header.sourceTime < newestSource())
+	{
+		printf("%s is older than the loose files, run --pack to update it\n", path.c_str());
+		close();
+		return false;
+	}
+
+	entries = table;
+	entryCount = header.entryCount;
+	paths = (const char*)file.data() + pathsOffset;
+	pathsSize = header.pathsSize;
+	printf("Reading the assets from %s (%u files)\n", path.c_str(), entryCount);
+	return true;
+}
+
+void AssetPack::close()
+{
+	file.close();
+	entries = nullptr;
+	entryCount = 0;
+	paths = "";
+	pathsSize = 0;
+}
+
+const PackEntry* AssetPack::find(constring path)
+{
+	if (entryCount == 0)
+		return nullptr;
+
+	uint64 key = hash(path);
+	const PackEntry* end = entries + entryCount;
+	const PackEntry* entry = std::lower_bound(entries, end, key, [](const PackEntry& e, uint64 h) { return e.hash < h; });
+	for (; entry != end && entry->hash == key; entry++)
+	{
+		const char* candidate = paths + entry->path;
+		size_t i = 0;
+		while (i < path.size() && candidate[i] == normalized(path[i]))
+			i++;
+		if (i == path.size() && candidate[i] == '\0')
+			return entry;
+	}
+	return nullptr;
+}
+
+const uint8* AssetPack::view(const PackEntry& entry)
+{
+	return entry.compression == (uint)PackCompression::NONE ? file.data() + entry.offset : nullptr;
+}
+
+bool AssetPack::read(const PackEntry& entry, uint8* out)
+{
+	const uint8* stored = file.data() + entry.offset;
+	if (entry.compression == (uint)PackCompression::NONE)
+	{
+		memcpy(out, stored, entry.size);
+		return true;
+	}
+	return lz4Decompress(stored, entry.storedSize, out, entry.size);
+}
+
+std::vector<std::string> AssetPack::sources()
+{
+	std::vector<std::string> files;
+	std::error_code error;
+	for (const char* directory : SOURCES)
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, error))
+		{
+			std::string path = entry.path().generic_string();
+			if (entry.is_regular_file(error) && path != AssetBlob::PATH) //The blob is mapped on its' own
+				files.push_back(path);
+		}
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+uint64 AssetPack::newestSource()
+{
+	std::error_code error;
+	uint64 newest = 0;
+	for (const std::string& path : sources())
+		newest = std::max(newest, (uint64)std::filesystem::last_write_time(path, error).time_since_epoch().count());
+	return newest;
+}
+
+int AssetPack::build(constring path)
+{
+	//Taken first, so files edited while packing make the pack stale
+	uint64 sourceTime = newestSource();
+	std::vector<std::string> files = sources();
+
+	struct Packed
+	{
+		PackEntry entry;
+		std::vector<uint8> data;
+	};
+	std::vector<Packed> packed(files.size());
+	std::string pathTable;
+	uint64 rawSize = 0;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		std::ifstream source(files[i], std::ios::in | std::ios::binary | std::ios::ate);
+		std::vector<uint8> bytes(source ? (size_t)source.tellg() : 0);
+		source.seekg(0);
+		if (!source || !source.read((char*)bytes.data(), bytes.size()))
+		{
+			printf("Couldn't read %s\n", files[i].c_str());
+			return 1;
+		}
+
+		PackEntry& entry = packed[i].entry;
+		entry = {};
+		entry.hash = hash(files[i]);
+		entry.path = (uint)pathTable.size();
+		entry.size = bytes.size();
+		pathTable.append(files[i].c_str(), files[i].size() + 1);
+		rawSize += bytes.size();
+
+		std::vector<uint8> compressed(lz4Bound(bytes.size()));
+		size_t compressedSize = lz4Compress(bytes.data(), bytes.size(), compressed.data());
+		if (compressedSize <= bytes.size() - bytes.size() / 8 && !bytes.empty())
+		{
+			compressed.resize(compressedSize);
+			packed[i].data = std::move(compressed);
+			entry.compression = (uint)PackCompression::LZ4;
+		}
+		else
+		{
+			packed[i].data = std::move(bytes);
+			entry.compression = (uint)PackCompression::NONE;
+		}
+		entry.storedSize = packed[i].data.size();
+	}
+
+	std::stable_sort(packed.begin(), packed.end(), [](const Packed& a, const Packed& b) { return a.entry.hash < b.entry.hash; });
+
+	auto align = [](uint64 offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; };
+	uint64 offset = align(sizeof(PackHeader) + packed.size() * sizeof(PackEntry) + pathTable.size());
+	for (Packed& p : packed)
+	{
+		p.entry.offset = offset;
+		offset = align(offset + p.entry.storedSize);
+	}
+
+	PackHeader header = {};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.sourceTime = sourceTime;
+	header.entryCount = (uint)packed.size();
+	header.pathsSize = (uint)pathTable.size();
+
+	std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	out.write((const char*)&header, sizeof(header));
+	for (const Packed& p : packed)
+		out.write((const char*)&p.entry, sizeof(PackEntry));
+	out.write(pathTable.data(), pathTable.size());
+	static const char PADDING[ALIGNMENT] = {};
+	for (const Packed& p : packed)
+	{
+		out.write(PADDING, p.entry.offset - (uint64)out.tellp());
+		out.write((const char*)p.data.data(), p.data.size());
+	}
+	if (!out)
+	{
+		printf("Couldn't write %s\n", path.c_str());
+		return 1;
+	}
+
+	uint compressedCount = (uint)std::count_if(packed.begin(), packed.end(),
+		[](const Packed& p) { return p.entry.compression == (uint)PackCompression::LZ4; });
+	printf("Packed %zu files (%u compressed) in %s: %.1f KB of files, %.1f KB packed\n", packed.size(),
+		compressedCount, path.c_str(), rawSize / 1024.0, (double)out.tellp() / 1024.0);
+	return 0;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <string>
+#include <vector>
+
+/* The loose files of res/textures, res/shaders, res/wren and res/data can be packed (--pack) in a single
+ * file, res/assets.pack. At startup it's mapped once and the files are found in its' table of contents,
+ * instead of opening every file: FileIO reads through it first (see readAsset()), then falls back on the
+ * loose files. The pack is trusted as it is, the loose files are only checked for changes made since it
+ * was packed while iterating on the assets (with --json or the hot reload), as it stats all of them.
+ *
+ * Layout, little endian:
+ *   PackHeader
+ *   the table of contents: one PackEntry per file, sorted by hash then path
+ *   the paths, null terminated
+ *   the files, each one aligned on 4096 bytes, so pages are never shared and the mapped files are aligned
+ *
+ * Files are compressed with LZ4 when it saves at least an eighth of their size, which leaves the PNGs
+ * stored as they are: those are decoded straight from the mapping, without a copy. Changing the layout
+ * requires incrementing AssetPack::VERSION.
+ */
+
+enum class PackCompression
+{
+	NONE,
+	LZ4
+};
+
+/// <summary>
+/// A file in the table of contents.
+/// </summary>
+struct PackEntry
+{
+	uint64 hash;         //AssetPack::hash() of the path
+	uint path;           //Offset in the paths, like "res/textures/grass.png"
+	uint compression;    //PackCompression
+	uint64 offset;       //From the start of the pack
+	uint64 storedSize;
+	uint64 size;         //Once decompressed
+};
+
+/// <summary>
+/// A static class that reads the files of the pack. See the top of AssetPack.hpp.
+/// </summary>
+class AssetPack
+{
+public:
+
+	static constexpr uint VERSION = 1;
+	static constexpr const char* PATH = "res/assets.pack";
+	static constexpr uint ALIGNMENT = 4096;
+
+	/// <summary>
+	/// Maps the pack. Not thread safe, call it before loading.
+	/// </summary>
+	/// <param name="checkSources">Whether to ignore the pack if it's older than the loose files.</param>
+	/// <returns>Whether the pack can be used.</returns>
+	static bool open(bool checkSources, constring path = PATH);
+
+	/// <summary>
+	/// Unmaps the pack, the files are read from the disk again.
+	/// </summary>
+	static void close();
+
+	static bool isOpen() { return file.isOpen(); }
+
+	/// <summary>
+	/// Finds a file in the pack, from any thread.
+	/// </summary>
+	/// <param name="path">Relative to the working directory, like "res/textures/grass.png".</param>
+	/// <returns>Its' entry, nullptr if the pack isn't open or doesn't have it.</returns>
+	static const PackEntry* find(constring path);
+
+	/// <summary>
+	/// Returns the content of a file stored uncompressed, in place, nullptr if it's compressed.
+	/// </summary>
+	static const uint8* view(const PackEntry& entry);
+
+	/// <summary>
+	/// Copies or decompresses a file, from any thread.
+	/// </summary>
+	/// <param name="out">Receives entry.size bytes.</param>
+	/// <returns>false if the compressed data is corrupted.</returns>
+	static bool read(const PackEntry& entry, uint8* out);
+
+	/// <summary>
+	/// Writes every loose file in a pack.
+	/// </summary>
+	/// <returns>The exit code of the program.</returns>
+	static int build(constring path = PATH);
+
+	/// <summary>
+	/// Returns the 64 bits FNV-1a hash of a path, back slashes hashed as slashes.
+	/// </summary>
+	static uint64 hash(constring path);
+
+	/// <summary>
+	/// Returns the modification time of the newest loose file, 0 if there are none.
+	/// </summary>
+	static uint64 newestSource();
+
+private:
+
+	static MappedFile file;
+	static const PackEntry* entries;
+	static uint entryCount;
+	static const char* paths;
+	static uint pathsSize;
+
+	/// <summary>
+	/// Lists the loose files to pack, sorted.
+	/// </summary>
+	static std::vector<std::string> sources();
+};
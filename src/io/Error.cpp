@@ -12,6 +12,13 @@ namespace naming //OPTI Do not keep these in memory, they are only needed on loa
 	extern const char* texture_s    = "texture";
 	extern const char* finalmodel_s = "finalmodel";
 
+	extern const char* position_s = "position";
+	extern const char* x_s        = "x";
+	extern const char* y_s        = "y";
+	extern const char* zIndex_s   = "zIndex";
+	extern const char* rotation_s = "rotation";
+	extern const char* scale_s    = "scale";
+
 	extern const char* message_s = "message";
 
 	extern const char* error_s   = "ERROR";      
@@ -30,6 +37,22 @@ namespace naming //OPTI Do not keep these in memory, they are only needed on loa
 	extern const char* geometry_s    = "geometry";
 	extern const char* shader_s        = "shader";
 	extern const char* attribcount_s = "attribcount";
+
+	extern const char* biome_s           = "biome";
+	extern const char* temperature_s     = "temperature";
+	extern const char* precipitation_s   = "precipitation";
+	extern const char* min_s             = "min";
+	extern const char* max_s             = "max";
+	extern const char* height_s          = "height";
+	extern const char* octaves_s         = "octaves";
+	extern const char* frequency_s       = "frequency";
+	extern const char* amplitude_s       = "amplitude";
+	extern const char* lacunarity_s      = "lacunarity";
+	extern const char* persistence_s     = "persistence";
+	extern const char* surface_s         = "surface";
+	extern const char* subsurface_s      = "subsurface";
+	extern const char* subsurfaceDepth_s = "subsurfaceDepth";
+	extern const char* stone_s           = "stone";
 }
 
 Error::Error(const uint id, const std::string name, const std::string message) :
@@ -20,6 +20,13 @@ namespace naming //OPTI Do not keep these in memory, they are only needed on loa
 	extern const char* texture_s;
 	extern const char* finalmodel_s;
 
+	extern const char* position_s;
+	extern const char* x_s;
+	extern const char* y_s;
+	extern const char* zIndex_s;
+	extern const char* rotation_s;
+	extern const char* scale_s;
+
 	extern const char* message_s;
 
 	extern const char* error_s;
@@ -39,6 +46,22 @@ namespace naming //OPTI Do not keep these in memory, they are only needed on loa
 	extern const char* geometry_s;
 	extern const char* shader_s;
 	extern const char* attribcount_s;
+
+	extern const char* biome_s;
+	extern const char* temperature_s;
+	extern const char* precipitation_s;
+	extern const char* min_s;
+	extern const char* max_s;
+	extern const char* height_s;
+	extern const char* octaves_s;
+	extern const char* frequency_s;
+	extern const char* amplitude_s;
+	extern const char* lacunarity_s;
+	extern const char* persistence_s;
+	extern const char* surface_s;
+	extern const char* subsurface_s;
+	extern const char* subsurfaceDepth_s;
+	extern const char* stone_s;
 }
 
 #pragma region Enums
@@ -1,6 +1,10 @@
 #include "FileIO.hpp"
 #include "rendering/Loader.hpp"
 #include "Error.hpp"
+#include "AssetPack.hpp"
+#include "MappedFile.hpp"
+#include "ObjLoader.hpp"
+#include "rendering/MeshOptimizer.hpp"
 
 #include "stb_image.h"
 
@@ -25,14 +29,13 @@ uint extractNumber(char* text, unsigned int start, char* buffer, int bufferSize)
 {
 	int i = 0;
 	unsigned int k = start;
-	while (text[k] != '\0' || text[k] != ' ' && i < bufferSize)
+	while (text[k] != '\0' && text[k] != ' ' && i < bufferSize - 1) //Room left for the terminator
 	{
 		buffer[i] = text[k];
 		i++;
 		k++;
 	}
-	if (buffer[i] != '\0')
-		buffer[i] = '\0';
+	buffer[i] = '\0';
 	return k;
 }
 
@@ -62,17 +65,115 @@ void readFile(std::ifstream& stream, std::string& content)
 }
 
 
-void readTexture(uint id, constring name, constring fileName)
+bool readFile(constring path, std::string& content, bool printError)
+{
+	if (const PackEntry* entry = AssetPack::find(path))
+	{
+		content.resize(entry->size);
+		if (AssetPack::read(*entry, (uint8*)content.data()))
+			return true;
+		ErrorManager::printError("[IOERROR]", "CAN'T OPEN FILE", "Corrupted file in the asset pack", path, "");
+		return false;
+	}
+
+	std::ifstream file;
+	if (!openFile(&file, path, printError))
+		return false;
+	readFile(file, content);
+	return true;
+}
+
+const uint8* readAsset(constring path, std::vector<uint8>& storage, size_t& size)
+{
+	if (const PackEntry* entry = AssetPack::find(path))
+	{
+		size = entry->size;
+		if (const uint8* data = AssetPack::view(*entry))
+			return data;
+		storage.resize(size);
+		return AssetPack::read(*entry, storage.data()) ? storage.data() : nullptr;
+	}
+
+	std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file)
+		return nullptr;
+	storage.resize((size_t)file.tellg());
+	file.seekg(0);
+	if (!file.read((char*)storage.data(), storage.size()))
+		return nullptr;
+	size = storage.size();
+	return storage.data();
+}
+
+uint8* decodeTexture(constring fileName, int& width, int& height, int& channels, int desiredChannels)
 {
-	int width, height, nrChannels;
 	std::string path = "res/textures/" + fileName;
-	uint8* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
+	uint8* data = nullptr;
+	if (AssetPack::find(path) != nullptr)
+	{
+		std::vector<uint8> storage;
+		size_t size;
+		if (const uint8* file = readAsset(path, storage, size))
+			data = stbi_load_from_memory(file, (int)size, &width, &height, &channels, desiredChannels);
+	}
+	else
+		data = stbi_load(path.c_str(), &width, &height, &channels, desiredChannels);
 	if (data == NULL)
 	{
 		std::cerr << "Couldn't open the file: " << path << std::endl;
+		width = height = channels = 0;
 	}
-	Texture* tex = Loader::loadTexture(id, name, data, width, height);
+	else if (desiredChannels != 0)
+		channels = desiredChannels;
+	return data;
+}
+
+bool readTextureSize(constring fileName, int& width, int& height)
+{
+	std::string path = "res/textures/" + fileName;
+	int channels;
+	if (AssetPack::find(path) == nullptr)
+		return stbi_info(path.c_str(), &width, &height, &channels) != 0;
+
+	//Only the header is touched when the texture is stored uncompressed, which is the case of the PNGs
+	std::vector<uint8> storage;
+	size_t size;
+	const uint8* file = readAsset(path, storage, size);
+	return file != nullptr && stbi_info_from_memory(file, (int)size, &width, &height, &channels) != 0;
+}
+
+void freeTexture(uint8* data)
+{
 	stbi_image_free(data);
 }
 
+void readTexture(uint id, constring name, constring fileName)
+{
+	int width, height, channels;
+	uint8* data = decodeTexture(fileName, width, height, channels);
+	Texture* tex = Loader::loadTexture(id, name, data, width, height, channels);
+	freeTexture(data);
+}
+
+RawModel* readObjModel(uint id, constring name, constring fileName)
+{
+	std::string path = "res/gameobjects/" + fileName;
+	MappedFile file;
+	if (!file.open(path))
+	{
+		std::cerr << "Couldn't open the file: " << path << std::endl;
+		return nullptr;
+	}
+
+	ObjMesh mesh;
+	const char* text = (const char*)file.data();
+	if (!parseObj(text, text + file.size(), path.c_str(), mesh))
+		return nullptr;
+	MeshStats stats = optimizeMesh(mesh);
+	printf("%s: %u triangles, %u vertices, ACMR %.3f -> %.3f\n", path.c_str(), stats.triangles, stats.vertices,
+		stats.acmrBefore, stats.acmrAfter);
+	mesh.narrowIndices();
+	return Loader::loadToVao(id, name, mesh);
+}
+
 
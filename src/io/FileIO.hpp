@@ -4,6 +4,9 @@
 
 #include "rendering/Model.hpp"
 
+#include <string>
+#include <vector>
+
 
 /// <summary>
 /// Opens the ifstream file at the given path
@@ -21,6 +24,43 @@ bool openFile(std::ifstream* file, constring path, bool printError = true);
 /// <param name="content"> The contents' holder</param>
 void readFile(std::ifstream& stream, std::string& content);
 
+/// <summary>
+/// Reads a whole file, from the AssetPack if it has it, from the disk otherwise. From any thread.
+/// </summary>
+/// <param name="path">The path to the file.</param>
+/// <param name="content">The contents' holder</param>
+/// <param name="printError">Print errors to the console?</param>
+/// <returns>True if  success, false otherwise</returns>
+bool readFile(constring path, std::string& content, bool printError = true);
+
+/// <summary>
+/// Reads a whole binary file, from the AssetPack if it has it, from the disk otherwise. From any thread.
+/// </summary>
+/// <param name="storage">Receives the content, unless it's stored uncompressed in the pack.</param>
+/// <param name="size">Receives the size of the content.</param>
+/// <returns>The content, in the pack or in storage, nullptr if the file couldn't be read.</returns>
+const uint8* readAsset(constring path, std::vector<uint8>& storage, size_t& size);
+
+/// <summary>
+/// <para>Decodes a texture without uploading it, from any thread. Texture must be located within res/textures.</para>
+/// </summary>
+/// <param name="fileName">Relative file name from res/textures</param>
+/// <param name="channels">Receives the number of channels of the pixels, 1 to 4</param>
+/// <param name="desiredChannels">The number of channels to convert the pixels to, 0 to keep the ones of the file</param>
+/// <returns>The pixels, to free with freeTexture(), nullptr if it couldn't be decoded</returns>
+uint8* decodeTexture(constring fileName, int& width, int& height, int& channels, int desiredChannels = 0);
+
+/// <summary>
+/// Reads the size of a texture from the header of its' file, without decoding it. Texture must be located within res/textures.
+/// </summary>
+/// <returns>false if the file couldn't be read</returns>
+bool readTextureSize(constring fileName, int& width, int& height);
+
+/// <summary>
+/// Frees the pixels returned by decodeTexture().
+/// </summary>
+void freeTexture(uint8* data);
+
 /// <summary>
 /// <para>Loads a texture. Texture must be located within res/textures.</para> 
 /// </summary>
@@ -29,11 +69,11 @@ void readFile(std::ifstream& stream, std::string& content);
 void readTexture(uint id, constring name, constring fileName);
 
 /// <summary>
-/// <para>Loads a model. Model must be located within res/gameobjects.</para> 
+/// <para>Loads a Wavefront OBJ model, see ObjLoader.hpp. Model must be located within res/gameobjects.</para> 
 /// </summary>
 /// <param name="fileName">Relative file name from res/gameobjects</param>
-/// <returns>A reference to a RawModel object representing the model</returns>
-void readObjModel(uint id, constring name, constring fileName);
+/// <returns>A reference to a RawModel object representing the model, nullptr if it couldn't be read</returns>
+RawModel* readObjModel(uint id, constring name, constring fileName);
 
 
 
@@ -0,0 +1,211 @@
+#include "FileWatcher.hpp"
+
+#include <cstdio>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+std::vector<FileChange> FileWatcher::poll()
+{
+	std::lock_guard<std::mutex> lock(changesMutex);
+	std::vector<FileChange> result;
+	result.swap(changes);
+	return result;
+}
+
+void FileWatcher::push(std::string path)
+{
+	for (char& c : path)
+		c = c == '\\' ? '/' : c;
+	std::lock_guard<std::mutex> lock(changesMutex);
+	changes.push_back({ std::move(path), std::chrono::steady_clock::now() });
+}
+
+#ifdef _WIN32
+
+FileWatcher::FileWatcher(const std::vector<std::string>& directories)
+{
+	stopEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	for (const std::string& directory : directories)
+	{
+		HANDLE handle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+			FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (handle == INVALID_HANDLE_VALUE)
+			continue;
+		handles.push_back(handle);
+		this->directories.push_back(directory);
+	}
+	watching = stopEvent != nullptr && !handles.empty();
+	if (watching)
+		thread = std::thread(&FileWatcher::watch, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	running = false;
+	if (stopEvent != nullptr)
+		SetEvent(stopEvent);
+	if (thread.joinable())
+		thread.join();
+	for (void* handle : handles)
+		CloseHandle(handle);
+	if (stopEvent != nullptr)
+		CloseHandle(stopEvent);
+}
+
+void FileWatcher::watch()
+{
+	const DWORD FILTER = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+	size_t count = handles.size();
+	std::vector<OVERLAPPED> overlapped(count);
+	std::vector<std::vector<DWORD>> buffers(count, std::vector<DWORD>(16384)); //DWORD aligned, as required
+	std::vector<HANDLE> events(count + 1);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		overlapped[i] = {};
+		overlapped[i].hEvent = events[i] = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+		ReadDirectoryChangesW(handles[i], buffers[i].data(), (DWORD)(buffers[i].size() * sizeof(DWORD)), TRUE,
+			FILTER, nullptr, &overlapped[i], nullptr);
+	}
+	events[count] = stopEvent;
+
+	while (running)
+	{
+		DWORD signaled = WaitForMultipleObjects((DWORD)events.size(), events.data(), FALSE, INFINITE);
+		size_t i = signaled - WAIT_OBJECT_0;
+		if (i >= count)
+			break;
+
+		DWORD bytes = 0;
+		if (GetOverlappedResult(handles[i], &overlapped[i], &bytes, FALSE) && bytes > 0)
+		{
+			const uint8* record = (const uint8*)buffers[i].data();
+			for (;;)
+			{
+				const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)record;
+				if (info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_ADDED
+					|| info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+				{
+					int wideLength = (int)(info->FileNameLength / sizeof(WCHAR));
+					int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, nullptr, 0, nullptr, nullptr);
+					std::string name(length, '\0');
+					WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, name.data(), length, nullptr, nullptr);
+					push(directories[i] + "/" + name);
+				}
+				if (info->NextEntryOffset == 0)
+					break;
+				record += info->NextEntryOffset;
+			}
+		}
+		ReadDirectoryChangesW(handles[i], buffers[i].data(), (DWORD)(buffers[i].size() * sizeof(DWORD)), TRUE,
+			FILTER, nullptr, &overlapped[i], nullptr);
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		CancelIoEx(handles[i], &overlapped[i]);
+		DWORD bytes;
+		GetOverlappedResult(handles[i], &overlapped[i], &bytes, TRUE); //The buffers must outlive the reads
+		CloseHandle(events[i]);
+	}
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::vector<std::string>& directories) :
+	directories(directories)
+{
+	descriptor = inotify_init1(IN_CLOEXEC);
+	if (descriptor < 0 || pipe(stopPipe) != 0)
+		return;
+	for (const std::string& directory : directories)
+		addWatches(directory, false);
+	watching = !watches.empty();
+	if (watching)
+		thread = std::thread(&FileWatcher::watch, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	running = false;
+	if (stopPipe[1] >= 0)
+	{
+		char stop = 0;
+		(void)!write(stopPipe[1], &stop, 1);
+	}
+	if (thread.joinable())
+		thread.join();
+	for (int end : stopPipe)
+		if (end >= 0)
+			close(end);
+	if (descriptor >= 0)
+		close(descriptor);
+}
+
+void FileWatcher::addWatches(const std::string& directory, bool created)
+{
+	//Written files are reported once closed, moved ones cover the editors saving through a temporary file
+	const uint32_t MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+	int watch = inotify_add_watch(descriptor, directory.c_str(), MASK);
+	if (watch < 0)
+		return;
+	watches.push_back({ watch, directory });
+
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+	{
+		if (entry.is_directory(error))
+			addWatches(entry.path().generic_string(), created);
+		else if (created) //Written before the watch was added
+			push(entry.path().generic_string());
+	}
+}
+
+void FileWatcher::watch()
+{
+	alignas(inotify_event) char buffer[16384];
+	pollfd descriptors[2] = { { descriptor, POLLIN, 0 }, { stopPipe[0], POLLIN, 0 } };
+
+	while (running)
+	{
+		if (::poll(descriptors, 2, -1) < 0 || (descriptors[1].revents & POLLIN))
+			break;
+
+		ssize_t length = read(descriptor, buffer, sizeof(buffer));
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event* event = (const inotify_event*)(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+			if (event->len == 0)
+				continue;
+
+			std::string directory;
+			for (const auto& [watch, path] : watches)
+				if (watch == event->wd)
+					directory = path;
+			if (directory.empty())
+				continue;
+
+			std::string path = directory + "/" + event->name;
+			if (event->mask & IN_ISDIR)
+			{
+				if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					addWatches(path, true); //Only this thread touches the watches once it runs
+			}
+			else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				push(path);
+		}
+	}
+}
+
+#endif
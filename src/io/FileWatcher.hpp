@@ -0,0 +1,87 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// A file written or moved into a watched directory.
+/// </summary>
+struct FileChange
+{
+	std::string path;                               //Like "res/shaders/spriteVertex.vert"
+	std::chrono::steady_clock::time_point time;     //When the watcher was told
+};
+
+/// <summary>
+/// Watches directories and their subdirectories on a thread of its' own: inotify on Linux,
+/// ReadDirectoryChangesW on Windows. Editors often write a file in several steps, poll() returns every
+/// one of them.
+/// </summary>
+class FileWatcher
+{
+public:
+
+	/// <summary>
+	/// Starts watching the directories, relative to the working directory. Missing ones are skipped.
+	/// </summary>
+	FileWatcher(const std::vector<std::string>& directories);
+
+	/// <summary>
+	/// Stops the thread.
+	/// </summary>
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	/// <summary>
+	/// Returns whether the directories are watched, false if the system refused.
+	/// </summary>
+	bool isWatching() const { return watching; }
+
+	/// <summary>
+	/// Returns the changes since the last call, from any thread.
+	/// </summary>
+	std::vector<FileChange> poll();
+
+private:
+
+	std::vector<std::string> directories;
+	std::thread thread;
+	std::atomic<bool> running = true;
+	bool watching = false;
+
+	std::mutex changesMutex;
+	std::vector<FileChange> changes;
+
+	/// <summary>
+	/// Adds a change, from the thread.
+	/// </summary>
+	void push(std::string path);
+
+	/// <summary>
+	/// Waits for the changes until the watcher is destroyed.
+	/// </summary>
+	void watch();
+
+#ifdef _WIN32
+	std::vector<void*> handles;   //HANDLE of every directory
+	void* stopEvent = nullptr;    //HANDLE signaled by the destructor
+#else
+	int descriptor = -1;          //Of inotify
+	int stopPipe[2] = { -1, -1 }; //Written by the destructor to wake the thread
+	std::vector<std::pair<int, std::string>> watches; //Watch descriptors and their directories
+
+	/// <summary>
+	/// Watches a directory and its' subdirectories.
+	/// </summary>
+	/// <param name="created">Whether it was created while watching, its' files are reported as changed.</param>
+	void addWatches(const std::string& directory, bool created);
+#endif
+};
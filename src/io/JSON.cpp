@@ -1,7 +1,9 @@
 #include "JSON.hpp"
 #include "Error.hpp"
 #include "FileIO.hpp"
-#include "rendering/shader.hpp"
+#include "rendering/Shader.hpp"
+#include "AssetBlob.hpp"
+#include "AssetPack.hpp"
 
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
@@ -14,6 +16,7 @@
 #include <string>
 #include <algorithm>
 #include <functional>
+#include <cmath>
 
 using namespace naming;
 
@@ -103,7 +106,7 @@ int parseJSONInt   (const rapidjson::Value& value, const char* object, const cha
 
 	if (!value[member].IsInt())
 	{
-		ErrorManager::printJSONError(JSONError::WRONG_TYPE, path, defaultValueFormat("\""+defaultValue+"\""),
+		ErrorManager::printJSONError(JSONError::WRONG_TYPE, path, defaultValueFormat(defaultValue),
 			formatJSONErrorArray(object, index), member, int_s);
 		return defaultValue;
 	}
@@ -111,7 +114,7 @@ int parseJSONInt   (const rapidjson::Value& value, const char* object, const cha
 	int v = value[member].GetInt();
 	if (!comparator.compare(v))
 	{
-		ErrorManager::printJSONError(JSONError::WRONG_VALUE, path, defaultValueFormat("\""+defaultValue+"\""),
+		ErrorManager::printJSONError(JSONError::WRONG_VALUE, path, defaultValueFormat(defaultValue),
 			formatJSONErrorArray(object, index), member, comparator.printMessage());
 		return defaultValue;
 	}
@@ -154,15 +157,65 @@ std::string parseJSONString(const rapidjson::Value& value, const char* object, c
 		return defaultValue;
 	}
 
-	return ;
+	return s;
 }
 
 #pragma endregion
 
+/* The documents of the loaders and the files they parse are allocated in a single arena. Files are read
+ * once into a buffer of the arena and parsed in-situ: the strings of the document point into that
+ * buffer instead of being copied, and nothing is freed until releaseJSONArena() drops everything at once.
+ * Each thread has its' own arena, so loaders can run in parallel.
+ */
+static const size_t ARENA_CHUNK_SIZE = 256 * 1024;
+static thread_local rapidjson::MemoryPoolAllocator<> arena(ARENA_CHUNK_SIZE);
+
+void releaseJSONArena()
+{
+	arena.Clear();
+}
+
+/// <summary>
+/// Reads a whole file in a null terminated buffer allocated by the allocator.
+/// </summary>
+/// <param name="size">Receives the number of bytes read, without the terminator.</param>
+/// <param name="printError">Print errors to the console?</param>
+/// <returns>The buffer, nullptr if the file couldn't be opened.</returns>
+static char* readFile(constring path, rapidjson::MemoryPoolAllocator<>& allocator, size_t& size, bool printError)
+{
+	if (const PackEntry* entry = AssetPack::find(path))
+	{
+		char* buffer = (char*)allocator.Malloc(entry->size + 1);
+		if (!AssetPack::read(*entry, (uint8*)buffer))
+		{
+			ErrorManager::printError("[IOERROR]", "CAN'T OPEN FILE", "Corrupted file in the asset pack", path, "");
+			return nullptr;
+		}
+		size = entry->size;
+		buffer[size] = '\0';
+		return buffer;
+	}
+
+	std::ifstream file;
+	if (!openFile(&file, path, printError))
+		return nullptr;
+
+	file.seekg(0, std::ios::end);
+	size_t capacity = (size_t)file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	char* buffer = (char*)allocator.Malloc(capacity + 1);
+	file.read(buffer, capacity);
+	size = (size_t)file.gcount();  //Less than the capacity when line endings are converted
+	buffer[size] = '\0';
+	return buffer;
+}
+
 //TODO Change printError name (ambiguity)
 
 /// <summary>
 /// Parses the file at the given path to the given document. Prints any errors in the console.
+/// The document must be allocated in the arena of the loaders, its' strings point into the file.
 /// </summary>
 /// <param name="doc">The doc to parse into</param>
 /// <param name="path">The path of the file to parse</param>
@@ -170,47 +223,39 @@ std::string parseJSONString(const rapidjson::Value& value, const char* object, c
 /// <returns>True if parsing was successful, False otherwise</returns>
 bool parseJSON(rapidjson::Document& doc, constring path, bool printError = true)
 {
-	std::ifstream file;
-	if (!openFile(&file, path, printError))             //First we open the file and return false if couldn't be opened
+	size_t size;
+	char* json = readFile(path, doc.GetAllocator(), size, printError); //First we read the file and return false if couldn't be opened
+	if (json == nullptr)
 		return false;
 
-	std::string json;
-	readFile(file, json);                               //Read the bytes from the file
-	doc.Parse(json.c_str());                            //Parsing the file
+	doc.ParseInsitu(json);                              //Parsing the file, strings are decoded in place
 	bool error = doc.HasParseError();
 	if (error)
 	{
 		// rapidjson does not provide line/column, only character offset
 		//hacking it here until (if) rapidjson implements it
-		size_t const error_char_offset = doc.GetErrorOffset();
-		std::string::const_iterator error_it =
-			json.cbegin() + error_char_offset;
+		//In-situ parsing decoded the escaped line breaks before the error, so the lines are counted on a fresh copy
+		size_t originalSize;
+		char* original = readFile(path, doc.GetAllocator(), originalSize, false);
+		if (original != nullptr && doc.GetErrorOffset() <= originalSize)
+			json = original;
+		char* errorChar = json + doc.GetErrorOffset();
 
 		// Compute line number, using 1 as base line
-		size_t const line = 1 + std::count_if(
-			json.cbegin(),
-			error_it,
-			std::bind(std::equal_to<char>(), '\n'));
+		size_t const line = 1 + std::count(json, errorChar, '\n');
 
 		// Compute column (char offset into line), using 1 as base column
-		std::string::const_reverse_iterator reverse_error_it{ error_it };
-		auto error_line_begin_it = std::find(
-			reverse_error_it,
-			json.crend(),
-			'\n');
-
-		// If this is the first line we can
-		size_t const column =
-			error_line_begin_it != json.crend()
-			? std::distance(reverse_error_it, error_line_begin_it) + 1
-			: error_char_offset + 1;
+		char* lineBegin = errorChar;
+		while (lineBegin > json && lineBegin[-1] != '\n')
+			lineBegin--;
+		size_t const column = errorChar - lineBegin + 1;
 
 		if (printError)
 			ErrorManager::printJSONErrorLine(JSONError::CANT_PARSE, path, rapidjson::GetParseError_En(doc.GetParseError()), line, column);
 		else
 			ErrorManager::printError("JSONError", "CAN'T PARSE", path, "Couldn't parse the file", rapidjson::GetParseError_En(doc.GetParseError()), line, column);
 	}
-	return error;
+	return !error;
 }
 
 #pragma region Shaders
@@ -304,61 +349,21 @@ std::vector<std::string>* extractAttributes(std::string& shaderCode)
 */
 
 /// <summary>
-/// Loads all the vertex shaders in the file res/data/vertexshaders.json
-/// </summary>
-void readVertexShaders()
-{
-	const std::string path = "res/data/vertexshaders.json";
-	rapidjson::Document doc;
-
-	if (!parseJSON(doc, path))
-		return;
-
-	if (!doc.IsArray()) //We should have an array of raw models
-	{
-		ErrorManager::printJSONError(JSONError::WRONG_ROOT, path, "", array_s);
-		return;
-	}
-
-	for (int i = 0; i < doc.Size(); i++)
-	{
-		int id;
-		std::string name;
-		std::string fileName;
-
-		const rapidjson::Value& value = doc[i]; 
-		
-		name = parseJSONString(value, vertex_s, name_s, i, path);
-
-		if(EndsWith{ ".vert" }.compare)
-		fileName = parseJSONString(value, vertex_s, path_s, i, path);
-
-		std::string shaderCode;
-
-		//TODO Read shader code
-
-		uint vertexShader = loadShader(fileName, ShaderType::VERTEX_SHADER, shaderCode);
-
-		if (vertexShader > 0) //Error management done in loadShader()
-		{
-			new VertexShader(id, name, vertexShader); //Adds to the static list of VertexShader
-		}
-	}
-
-}
-
-/// <summary>
-/// Loads all the geometry shaders in the file res/data/geometryshaders.json
+/// Validates the shaders of a stage.
 /// </summary>
-void readGeometryShaders()
+/// <typeparam name="T">The record of the stage.</typeparam>
+/// <param name="path">The path of the file listing them.</param>
+/// <param name="object">The name of the stage.</param>
+/// <param name="extension">The comparator validating the paths of the files.</param>
+template<typename T>
+static void readShaderStages(constring path, const char* object, const IComparator<std::string>& extension, AssetTables& tables)
 {
-	const std::string path = "res/data/geometryshaders.json";
-	rapidjson::Document doc;
+	rapidjson::Document doc(&arena);
 
 	if (!parseJSON(doc, path))
 		return;
 
-	if (!doc.IsArray()) //We should have an array of raw models
+	if (!doc.IsArray()) //We should have an array of shaders
 	{
 		ErrorManager::printJSONError(JSONError::WRONG_ROOT, path, "", array_s);
 		return;
@@ -366,89 +371,29 @@ void readGeometryShaders()
 
 	for (int i = 0; i < doc.Size(); i++)
 	{
-		int id;
-		std::string name;
-		std::string fileName; //SAFE must finish by .geom ??
-
+		T record;
 		const rapidjson::Value& value = doc[i];
 
-		id = parseJSONInt(value, geometry_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
-
-		name = parseJSONString(value, geometry_s, name_s, i, path);
-
-		fileName = parseJSONString(value, geometry_s, path_s, i, path);
+		record.id = parseJSONInt(value, object, id_s, i, path, GreaterEqualThan{ 0 }, i);
 
-		std::string shaderCode;
+		record.name = tables.addString(parseJSONString(value, object, name_s, i, path));
 
-		//TODO Read shader code
+		record.path = tables.addString(parseJSONString(value, object, path_s, i, path, extension));
 
-		uint geometryShader = loadShader(fileName, ShaderType::GEOMETRY_SHADER, shaderCode);
-		if (geometryShader > 0)
-		{
-			new ShaderBase(id, name, geometryShader);
-		}
+		tables.add(record);
 	}
 }
 
-/// <summary>
-/// Loads all the fragment shaders in the file res/data/fragmentshaders.json
-/// </summary>
-void readFragmentShaders()
+void readShaders(AssetTables& tables)
 {
-	const std::string path = "res/data/fragmentshaders.json";
-	rapidjson::Document doc;
-
-	if (!parseJSON(doc, path))
-		return;
-
-	if (!doc.IsArray()) //We should have an array of raw models
-	{
-		ErrorManager::printJSONError(JSONError::WRONG_ROOT, path, "", array_s);
-		return;
-	}
-
-	for (int i = 0; i < doc.Size(); i++)
-	{
-		int id;
-		std::string name;
-		std::string fileName; //SAFE must finish by .frag
-
-		const rapidjson::Value& value = doc[i];
-
-		id = parseJSONInt(value, fragment_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
-
-		name = parseJSONString(value, fragment_s, name_s, i, path);
-
-		fileName = parseJSONString(value, fragment_s, path_s, i, path);
-
-		std::string shaderCode;
+	//First things first, the stages
+	readShaderStages<VertexShaderRecord>("res/data/vertexshaders.json", vertex_s, EndsWith{ ".vert" }, tables);
+	readShaderStages<GeometryShaderRecord>("res/data/geometryshaders.json", geometry_s, EndsWith{ ".geom" }, tables);
+	readShaderStages<FragmentShaderRecord>("res/data/fragmentshaders.json", fragment_s, EndsWith{ ".frag" }, tables);
 
-		//TODO Read shader code
-
-		uint fragmentShader = loadShader(fileName, ShaderType::FRAGMENT_SHADER, shaderCode);
-		if (fragmentShader > 0)
-		{
-			new ShaderBase(id, name, fragmentShader);
-		}
-	}
-}
-
-void readShaders()
-{
-	//First things first, we load all the scripts
-	readVertexShaders();
-	readGeometryShaders();
-	readFragmentShaders();
-
-	printf("Loaded %d vertex shaders, %d geometry shaders, %d fragment shaders\n", 
-		(int)VertexShader::vertexShaders.size(),
-		(int)GeometryShader::geometryShaders.size(),
-		(int)FragmentShader::fragmentShaders.size());
-
-
-	//Then we link shaders together
+	//Then the programs linking them together
 	const std::string path = "res/data/shaders.json";
-	rapidjson::Document doc;
+	rapidjson::Document doc(&arena);
 
 	if (!parseJSON(doc, path))
 		return;
@@ -461,64 +406,31 @@ void readShaders()
 
 	for (int i = 0; i < doc.Size(); i++)
 	{
-		int id;
-		std::string name;
-		int vertexID;
-		int geometryID; //TODO Add the possibility to specify the Shaders by their name
-		int fragmentID;
-
+		ShaderRecord record;
 		const rapidjson::Value& value = doc[i];
 
-		id = parseJSONInt(value, shader_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
+		record.id = parseJSONInt(value, shader_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
 
-		name = parseJSONString(value, shader_s, name_s, i, path);
+		record.name = tables.addString(parseJSONString(value, shader_s, name_s, i, path));
 
-		vertexID = parseJSONInt(value, shader_s, vertex_s, i, path, GreaterEqualThan{ 0 }, -1);
+		//TODO Add the possibility to specify the Shaders by their name
+		record.vertex = parseJSONInt(value, shader_s, vertex_s, i, path, GreaterEqualThan{ 0 }, -1);
 
-		geometryID = parseJSONInt(value, shader_s, geometry_s, i, path, GreaterEqualThan{ -1 }, -1);
+		record.geometry = parseJSONInt(value, shader_s, geometry_s, i, path, GreaterEqualThan{ -1 }, -1);
 
-		fragmentID = parseJSONInt(value, shader_s, fragment_s, i, path, GreaterEqualThan{ 0 }, -1);
-
-		//TODO Display message saying that one or two are missing
-		if (vertexID == -1 || fragmentID == -1) continue; //We skip the shader if vertex or fragment is missing
+		record.fragment = parseJSONInt(value, shader_s, fragment_s, i, path, GreaterEqualThan{ 0 }, -1);
 
 		//SAFE Verify if vertexID, geometryID and fragmentID are in range
-		uint programID = linkShaders(id, name,
-							  VertexShader::vertexShaders[vertexID],
-			geometryID >= 0 ? GeometryShader::geometryShaders[geometryID] : nullptr,
-							  FragmentShader::fragmentShaders[fragmentID]);
-		
-		if (programID == 0) continue; //Error managed in linkShaders()
-		
-		int attribCount;
-
-		glGetProgramiv(programID, GL_ACTIVE_ATTRIBUTES, &attribCount);
-		printf("Active Attributes: %d\n", attribCount);
-		//TODO Get attrib and uniforms
-		/*
-		for (i = 0; i < attribCount; i++)
-		{
-			glGetActiveAttrib(programID, (GLuint)i, bufSize, &length, &size, &type, name);
-
-			printf("Attribute #%d Type: %u Name: %s\n", i, type, name);
-		}*/
-
+		tables.add(record);
 	}
-
-	//Destroying the temporary sub Shaders
-	VertexShader::destroy();
-	GeometryShader::destroy();
-	FragmentShader::destroy();
-
-
-	printf("Loaded %d shaders\n",
-		(int)Shader::shaders.size());
 }
 
 #pragma endregion
 
 #pragma region Components
 
+void readRenderers();
+
 void readComponents()
 {
 	readRenderers();
@@ -527,7 +439,7 @@ void readComponents()
 void readRenderers()
 {
 	const std::string path = "res/data/renderers.json";
-	rapidjson::Document doc;
+	rapidjson::Document doc(&arena);
 
 	if (!parseJSON(doc, path))
 		return;
@@ -560,10 +472,10 @@ void readRenderers()
 
 #pragma region Models
 
-void readTextures()
+void readTextures(AssetTables& tables)
 {
 	const std::string path = "res/data/textures.json";
-	rapidjson::Document doc;
+	rapidjson::Document doc(&arena);
 
 	if (!parseJSON(doc, path))
 		return;
@@ -576,28 +488,24 @@ void readTextures()
 
 	for (int i = 0; i < doc.Size(); i++)
 	{
-		int id;
-		std::string name;
-		std::string fileName; //SAFE must finish by .png or .jpg or other supported format
+		TextureRecord record; //SAFE path must finish by .png or .jpg or other supported format
 
 		const rapidjson::Value& value = doc[i];
 
-		id = parseJSONInt(value, texture_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
+		record.id = parseJSONInt(value, texture_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
 
-		name = parseJSONString(value, texture_s, name_s, i, path);
+		record.name = tables.addString(parseJSONString(value, texture_s, name_s, i, path));
 
-		fileName = parseJSONString(value, texture_s, path_s, i, path);
+		record.path = tables.addString(parseJSONString(value, texture_s, path_s, i, path));
 
-		readTexture(id, name, fileName);
+		tables.add(record);
 	}
-
-	printf("Loaded %d textures\n", (int)Texture::textures.size());
 }
 
-void readMaterials()
+void readMaterials(AssetTables& tables)
 {
 	const std::string path = "res/data/materials.json";
-	rapidjson::Document doc;
+	rapidjson::Document doc(&arena);
 
 	if (!parseJSON(doc, path))
 		return;
@@ -610,27 +518,28 @@ void readMaterials()
 
 	for (int i = 0; i < doc.Size(); i++)
 	{
-		int id;
-		std::string name;
-		int shaderID;
+		MaterialRecord record;
 
 		const rapidjson::Value& mat = doc[i];
 
-		id = parseJSONInt(mat, material_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
+		record.id = parseJSONInt(mat, material_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
+
+		record.name = tables.addString(parseJSONString(mat, material_s, name_s, i, path));
 
-		name = parseJSONString(mat, material_s, name_s, i, path);
+		record.shader = parseJSONInt(mat, material_s, shader_s, i, path, GreaterEqualThan{ 0 }, 0);
 
-		shaderID = parseJSONInt(mat, material_s, shader_s, i, path, GreaterEqualThan{ 0 }, 0);
+		record.shineDamper = parseJSONFloat(mat, material_s, shineDamper_s, i, path, GreaterThan{ 0.0f }, 10);
 
-		new Material(id, name, Shader::shaders[shaderID]);
+		record.reflectivity = parseJSONFloat(mat, material_s, reflectivity_s, i, path, GreaterEqualThan{ 0.0f }, 0);
+
+		tables.add(record);
 	}
-	printf("Loaded %d materials\n", (int)Material::materials.size());
 }
 
-void readGameObjects()
+void readGameObjects(AssetTables& tables)
 {
 	const std::string path = "res/data/gameobjects.json";
-	rapidjson::Document doc;
+	rapidjson::Document doc(&arena);
 
 	if (!parseJSON(doc, path))
 		return;
@@ -643,39 +552,121 @@ void readGameObjects()
 
 	for (int i = 0; i < doc.Size(); i++)
 	{
-		int id;
-		std::string name;
-		float posX;
-		float posY;
-		float zIndex;
-		float rotation;
-		
+		GameObjectRecord record;
 
 		const rapidjson::Value& value = doc[i];
 
-		id = parseJSONInt(value, finalmodel_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
+		record.id = parseJSONInt(value, finalmodel_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
 
-		name = parseJSONString(value, finalmodel_s, name_s, i, path);
+		record.name = tables.addString(parseJSONString(value, finalmodel_s, name_s, i, path));
+
+		record.x = record.y = 0;
+		if (value.HasMember(position_s) && value[position_s].IsObject())
+		{
+			record.x = parseJSONFloat(value[position_s], position_s, x_s, i, path);
+			record.y = parseJSONFloat(value[position_s], position_s, y_s, i, path);
+		}
+		else
+		{
+			ErrorManager::printJSONError(JSONError::MISSING_MEMBER, path, defaultValueFormat("(0, 0)"),
+				formatJSONErrorArray(finalmodel_s, i), position_s);
+		}
 
-		posX = parseJSONFloat(value, finalmodel_s, rawmodel_s, i, path, GreaterEqualThan{ 0 }, 0);
+		record.zIndex = parseJSONFloat(value, finalmodel_s, zIndex_s, i, path);
+
+		record.rotation = parseJSONFloat(value, finalmodel_s, rotation_s, i, path);
+
+		record.scale = parseJSONFloat(value, finalmodel_s, scale_s, i, path, Always<float>(), 1);
 
 		//texture = parseJSONInt(value, finalmodel_s, texture_s, i, path, 0, GreaterEqualThan{ 0 });
 
 		//material = parseJSONInt(value, finalmodel_s, material_s, i, path, 0, GreaterEqualThan{ 0 });
 
-		GameObject* gameObject = new GameObject(id, name);
-		Transform transform = gameObject->transform;
-		//transform.position
+		tables.add(record);
+	}
+}
+
+#pragma endregion
+
+#pragma region Biomes
+
+/// <summary>
+/// Reads the min and max members of a range object of a biome.
+/// </summary>
+/// <param name="value">The biome.</param>
+/// <param name="member">The name of the range object.</param>
+/// <param name="index">The index of the biome.</param>
+/// <param name="path">The path of the file.</param>
+static void parseJSONRange(const rapidjson::Value& value, const char* member, int index, constring path, float& min, float& max)
+{
+	min = -INFINITY;
+	max = INFINITY;
+	if (!value.HasMember(member) || !value[member].IsObject())
+	{
+		ErrorManager::printJSONError(JSONError::MISSING_MEMBER, path, defaultValueFormat("(-inf, inf)"),
+			formatJSONErrorArray(biome_s, index), member);
+		return;
+	}
+	min = parseJSONFloat(value[member], member, min_s, index, path, Always<float>(), min);
+	max = parseJSONFloat(value[member], member, max_s, index, path, Always<float>(), max);
+}
+
+void readBiomes(AssetTables& tables)
+{
+	const std::string path = "res/data/terrain_generation/biomes.json";
+	rapidjson::Document doc(&arena);
+
+	if (!parseJSON(doc, path))
+		return;
+
+	if (!doc.IsArray()) //We should have an array of biomes
+	{
+		ErrorManager::printJSONError(JSONError::WRONG_ROOT, path, "", array_s);
+		return;
+	}
+
+	for (int i = 0; i < doc.Size(); i++)
+	{
+		BiomeRecord biome;
+		const rapidjson::Value& value = doc[i];
+
+		biome.id = parseJSONInt(value, biome_s, id_s, i, path, GreaterEqualThan{ 0 }, i);
+		biome.name = tables.addString(parseJSONString(value, biome_s, name_s, i, path));
+
+		parseJSONRange(value, temperature_s, i, path, biome.minTemperature, biome.maxTemperature);
+		parseJSONRange(value, precipitation_s, i, path, biome.minPrecipitation, biome.maxPrecipitation);
+
+		biome.height = parseJSONFloat(value, biome_s, height_s, i, path, Always<float>(), 64);
+		biome.octaves = parseJSONInt(value, biome_s, octaves_s, i, path, GreaterEqualThan{ 1 }, 1);
+		biome.frequency = parseJSONFloat(value, biome_s, frequency_s, i, path, GreaterThan{ 0.0f }, 0.01f);
+		biome.amplitude = parseJSONFloat(value, biome_s, amplitude_s, i, path, Always<float>(), 1);
+		biome.lacunarity = parseJSONFloat(value, biome_s, lacunarity_s, i, path, GreaterThan{ 0.0f }, 2);
+		biome.persistence = parseJSONFloat(value, biome_s, persistence_s, i, path, Always<float>(), 0.5f);
+
+		biome.surface = parseJSONInt(value, biome_s, surface_s, i, path, GreaterEqualThan{ 0 }, 0);
+		biome.subsurface = parseJSONInt(value, biome_s, subsurface_s, i, path, GreaterEqualThan{ 0 }, 0);
+		biome.subsurfaceDepth = parseJSONInt(value, biome_s, subsurfaceDepth_s, i, path, GreaterEqualThan{ 0 }, 0);
+		biome.stone = parseJSONInt(value, biome_s, stone_s, i, path, GreaterEqualThan{ 0 }, 0);
+
+		tables.add(biome);
 	}
-	printf("Loaded %d GameObjects\n", (int)GameObject::gameobjects.size());
 }
 
 #pragma endregion
 
+void readAssets(AssetTables& tables)
+{
+	readTextures(tables);
+	readMaterials(tables);
+	readGameObjects(tables);
+	readShaders(tables);
+	readBiomes(tables);
+}
+
 void readErrors()
 {
 	std::string path = "res/data/errors.json";
-	rapidjson::Document doc;
+	rapidjson::Document doc(&arena);
 
 	if (!parseJSON(doc, path, false))
 		return;
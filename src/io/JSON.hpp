@@ -3,11 +3,22 @@
 #include "util/Comparators.hpp"
 #include "util/Utility.hpp"
 
+class AssetTables;
+
+/* The read functions only validate the JSON files and add their records to the tables, the Loader
+ * creates the objects from the records (see AssetBlob.hpp). The readers of different files can run on
+ * different threads at the same time.
+ */
 
 /// <summary>
-/// Loads all the shader programs in the file res/data/shaders.json
+/// Validates all the JSON files of res/data listed below.
 /// </summary>
-void readShaders();
+void readAssets(AssetTables& tables);
+
+/// <summary>
+/// Validates all the shader stages in the files res/data/*shaders.json, then the shader programs in the file res/data/shaders.json
+/// </summary>
+void readShaders(AssetTables& tables);
 
 /// <summary>
 /// Loads all the components, all located in files res/data/components/*
@@ -15,22 +26,32 @@ void readShaders();
 void readComponents();
 
 /// <summary>
-/// Loads all the textures in the file res/data/textures.json
+/// Validates all the textures in the file res/data/textures.json
+/// </summary>
+void readTextures(AssetTables& tables);
+
+/// <summary>
+/// Validates all the materials in the file res/data/materials.json
 /// </summary>
-void readTextures();
+void readMaterials(AssetTables& tables);
 
 /// <summary>
-/// Loads all the materials in the file res/data/materials.json
+/// Validates all the GameObjects in the file res/data/gameobjects.json
 /// </summary>
-void readMaterials();
+void readGameObjects(AssetTables& tables);
 
 /// <summary>
-/// Loads all the FinalModels in the file res/data/finalmodels.json
+/// Validates all the biomes in the file res/data/terrain_generation/biomes.json
 /// </summary>
-void readGameObjects();
+void readBiomes(AssetTables& tables);
 
 /// <summary>
 /// <para>Loads all the errors in the specified file. The file must be located within res/data.</para> 
 /// </summary>
 /// <param name="fileName">Relative file name from res/data</param>
-void readErrors();
\ No newline at end of file
+void readErrors();
+
+/// <summary>
+/// Frees the memory used by the documents of all the loaders above run on the calling thread. Call it once they are all done.
+/// </summary>
+void releaseJSONArena();
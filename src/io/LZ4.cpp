@@ -0,0 +1,141 @@
+#include "LZ4.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5;  //The last bytes are always literals
+static const size_t MATCH_LIMIT = 12;   //No match starts in the last bytes
+static const size_t MAX_OFFSET = 65535;
+static const uint HASH_BITS = 12;
+
+static uint read32(const uint8* p)
+{
+	uint value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static uint hashOf(uint sequence) { return (sequence * 2654435761u) >> (32 - HASH_BITS); }
+
+/// <summary>
+/// Writes the rest of a length over 15, as bytes of 255 and a last smaller byte.
+/// </summary>
+static uint8* writeLength(uint8* out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		*out++ = 255;
+	*out++ = (uint8)length;
+	return out;
+}
+
+/// <summary>
+/// Writes a sequence: the literals, then a match unless it's the last one.
+/// </summary>
+static uint8* writeSequence(uint8* out, const uint8* literals, size_t literalCount, size_t offset, size_t matchLength)
+{
+	uint8* token = out++;
+	*token = (uint8)(std::min<size_t>(literalCount, 15) << 4);
+	if (literalCount >= 15)
+		out = writeLength(out, literalCount - 15);
+	if (literalCount > 0) //literals can be null for an empty block
+		memcpy(out, literals, literalCount);
+	out += literalCount;
+	if (matchLength == 0)
+		return out;
+
+	*out++ = (uint8)offset;
+	*out++ = (uint8)(offset >> 8);
+	*token |= (uint8)std::min<size_t>(matchLength - MIN_MATCH, 15);
+	if (matchLength - MIN_MATCH >= 15)
+		out = writeLength(out, matchLength - MIN_MATCH - 15);
+	return out;
+}
+
+size_t lz4Bound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+size_t lz4Compress(const uint8* data, size_t size, uint8* out)
+{
+	uint8* start = out;
+	size_t anchor = 0;
+	if (size > MATCH_LIMIT)
+	{
+		std::vector<uint> table(1 << HASH_BITS, 0); //Position + 1 of the last sequence of every hash, 0 if none
+		for (size_t position = 0; position + MATCH_LIMIT <= size;)
+		{
+			uint sequence = read32(data + position);
+			uint& entry = table[hashOf(sequence)];
+			size_t candidate = entry;
+			entry = (uint)position + 1;
+
+			if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET || read32(data + candidate - 1) != sequence)
+			{
+				position += 1 + ((position - anchor) >> 6); //Skips faster through data that doesn't compress
+				continue;
+			}
+
+			size_t match = candidate - 1;
+			size_t length = MIN_MATCH;
+			while (position + length < size - LAST_LITERALS && data[match + length] == data[position + length])
+				length++;
+			out = writeSequence(out, data + anchor, position - anchor, position - match, length);
+			position += length;
+			anchor = position;
+		}
+	}
+	out = writeSequence(out, data + anchor, size - anchor, 0, 0);
+	return out - start;
+}
+
+bool lz4Decompress(const uint8* data, size_t size, uint8* out, size_t rawSize)
+{
+	const uint8* end = data + size;
+	size_t written = 0;
+
+	//Reads the rest of a length over 15
+	auto readLength = [&](size_t& length)
+	{
+		uint8 byte;
+		do
+		{
+			if (data == end)
+				return false;
+			byte = *data++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	};
+
+	while (data < end)
+	{
+		uint8 token = *data++;
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !readLength(literalCount))
+			return false;
+		if (literalCount > (size_t)(end - data) || literalCount > rawSize - written)
+			return false;
+		memcpy(out + written, data, literalCount);
+		data += literalCount;
+		written += literalCount;
+		if (data == end)
+			break; //The last sequence has no match
+
+		if (end - data < 2)
+			return false;
+		size_t offset = data[0] | (data[1] << 8);
+		data += 2;
+		size_t length = token & 15;
+		if (length == 15 && !readLength(length))
+			return false;
+		length += MIN_MATCH;
+		if (offset == 0 || offset > written || length > rawSize - written)
+			return false;
+		for (size_t i = 0; i < length; i++, written++) //Byte by byte, the match can overlap what it writes
+			out[written] = out[written - offset];
+	}
+	return written == rawSize;
+}
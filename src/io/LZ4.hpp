@@ -0,0 +1,27 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+/* The LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), for the entries of
+ * the asset packs. Compressed with a greedy matcher and a single hash table of the last positions of
+ * 4 bytes sequences, decompressed with bounds checks as packs are read from the disk.
+ */
+
+/// <summary>
+/// Returns the largest size of the compressed data of size bytes.
+/// </summary>
+size_t lz4Bound(size_t size);
+
+/// <summary>
+/// Compresses a block.
+/// </summary>
+/// <param name="out">Receives the compressed data, lz4Bound(size) bytes.</param>
+/// <returns>The size of the compressed data.</returns>
+size_t lz4Compress(const uint8* data, size_t size, uint8* out);
+
+/// <summary>
+/// Decompresses a block.
+/// </summary>
+/// <param name="out">Receives the decompressed data, rawSize bytes.</param>
+/// <returns>false if the block is corrupted or doesn't decompress to rawSize bytes.</returns>
+bool lz4Decompress(const uint8* data, size_t size, uint8* out, size_t rawSize);
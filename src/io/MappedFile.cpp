@@ -0,0 +1,97 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(constring path)
+{
+	close();
+
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping != nullptr)
+		bytes = (const uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (bytes == nullptr)
+	{
+		close();
+		return false;
+	}
+	length = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (bytes != nullptr)
+		UnmapViewOfFile(bytes);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != nullptr)
+		CloseHandle(file);
+	bytes = nullptr;
+	mapping = nullptr;
+	file = nullptr;
+	length = 0;
+}
+
+#else
+
+bool MappedFile::open(constring path)
+{
+	close();
+
+	int descriptor = ::open(path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+	{
+		void* address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (address != MAP_FAILED)
+		{
+			bytes = (const uint8*)address;
+			length = (size_t)status.st_size;
+		}
+	}
+	::close(descriptor); //The mapping keeps its' own reference to the file
+	return bytes != nullptr;
+}
+
+void MappedFile::close()
+{
+	if (bytes != nullptr)
+		munmap((void*)bytes, length);
+	bytes = nullptr;
+	length = 0;
+}
+
+#endif
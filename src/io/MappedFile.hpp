@@ -0,0 +1,42 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+/// <summary>
+/// A file mapped read-only in memory. Pages are only read from the disk when they are touched.
+/// </summary>
+class MappedFile
+{
+public:
+
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/// <summary>
+	/// Maps the file, closing the previously mapped one.
+	/// </summary>
+	/// <returns>Whether the file could be mapped. Empty files can't.</returns>
+	bool open(constring path);
+
+	/// <summary>
+	/// Unmaps the file, nothing happens if none is mapped.
+	/// </summary>
+	void close();
+
+	const uint8* data() const { return bytes; }
+	size_t size() const { return length; }
+	bool isOpen() const { return bytes != nullptr; }
+
+private:
+
+	const uint8* bytes = nullptr;
+	size_t length = 0;
+
+#ifdef _WIN32
+	void* file = nullptr;     //HANDLE of the file
+	void* mapping = nullptr;  //HANDLE of the mapping
+#endif
+};
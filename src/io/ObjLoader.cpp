@@ -0,0 +1,281 @@
+#include "ObjLoader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#pragma region Scanner
+
+static bool isDigit(char c) { return (unsigned)(c - '0') < 10; }
+static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static const char* skipBlanks(const char* p, const char* end)
+{
+	while (p < end && isBlank(*p))
+		p++;
+	return p;
+}
+
+/// <summary>
+/// Parses a decimal float with an optional exponent.
+/// </summary>
+/// <returns>The character after the number, nullptr if there's no number.</returns>
+static const char* parseFloat(const char* p, const char* end, float& value)
+{
+	static const double POWERS[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	bool negative = p < end && *p == '-';
+	if (p < end && (*p == '-' || *p == '+'))
+		p++;
+
+	//At most 19 significant digits fit in the mantissa, the next ones only move the exponent
+	uint64 mantissa = 0;
+	int exponent = 0;
+	uint significant = 0;
+	bool digits = false;
+	for (; p < end && isDigit(*p); p++, digits = true)
+	{
+		if (significant < 19)
+		{
+			mantissa = mantissa * 10 + (uint)(*p - '0');
+			significant += mantissa != 0;
+		}
+		else
+			exponent++;
+	}
+	if (p < end && *p == '.')
+		for (p++; p < end && isDigit(*p); p++, digits = true)
+			if (significant < 19)
+			{
+				mantissa = mantissa * 10 + (uint)(*p - '0');
+				significant += mantissa != 0;
+				exponent--;
+			}
+	if (!digits)
+		return nullptr;
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char* q = p + 1;
+		bool negativeExponent = q < end && *q == '-';
+		if (q < end && (*q == '-' || *q == '+'))
+			q++;
+		if (q < end && isDigit(*q))
+		{
+			int e = 0;
+			for (; q < end && isDigit(*q); q++)
+				e = e < 10000 ? e * 10 + (*q - '0') : e;
+			exponent += negativeExponent ? -e : e;
+			p = q;
+		}
+	}
+
+	//Exact when the mantissa and the power of 10 are both exact doubles, the common case
+	double result = (double)mantissa;
+	if (exponent >= -22 && exponent <= 22)
+		result = exponent < 0 ? result / POWERS[-exponent] : result * POWERS[exponent];
+	else
+		result *= std::pow(10.0, exponent);
+	value = (float)(negative ? -result : result);
+	return p;
+}
+
+/// <summary>
+/// Parses a decimal integer.
+/// </summary>
+/// <returns>The character after the number, nullptr if there's no number.</returns>
+static const char* parseInt(const char* p, const char* end, int& value)
+{
+	bool negative = p < end && *p == '-';
+	if (p < end && (*p == '-' || *p == '+'))
+		p++;
+	if (p == end || !isDigit(*p))
+		return nullptr;
+	long long result = 0;
+	for (; p < end && isDigit(*p); p++)
+		result = result < 0x7FFFFFFF ? result * 10 + (*p - '0') : result; //Saturated, out of range anyway
+	value = (int)(negative ? -result : result);
+	return p;
+}
+
+#pragma endregion
+
+#pragma region Vertex map
+
+/// <summary>
+/// The attributes of a face corner, indices in the lists of the file, -1 if absent.
+/// </summary>
+struct CornerKey
+{
+	int position, textureCoords, normal;
+
+	bool operator==(const CornerKey& other) const
+	{
+		return position == other.position && textureCoords == other.textureCoords && normal == other.normal;
+	}
+};
+
+/// <summary>
+/// Maps the corners to the index of their vertex. The buckets are indexed by the position of the corner,
+/// each one chaining the vertices using that position, so the lookups of the corners of nearby faces,
+/// which reference nearby positions, stay in the cache instead of hashing all over a large table.
+/// </summary>
+class VertexMap
+{
+public:
+
+	/// <summary>
+	/// Returns the vertex of a corner, or adds it with the given index, the next one.
+	/// </summary>
+	/// <param name="added">Receives whether the corner wasn't in the map.</param>
+	uint insert(const CornerKey& key, uint index, bool& added)
+	{
+		if ((size_t)key.position >= heads.size())
+			heads.resize(std::max((size_t)key.position + 1, heads.size() * 2), EMPTY);
+
+		for (uint vertex = heads[key.position]; vertex != EMPTY; vertex = next[vertex])
+			if (keys[vertex] == key)
+			{
+				added = false;
+				return vertex;
+			}
+
+		added = true;
+		keys.push_back(key);
+		next.push_back(heads[key.position]);
+		heads[key.position] = index;
+		return index;
+	}
+
+private:
+
+	static constexpr uint EMPTY = ~0u; //No vertex reaches it, indices are at most 32 bits
+
+	std::vector<uint> heads;      //By position, the last vertex added with it
+	std::vector<uint> next;       //By vertex, the previous one with the same position
+	std::vector<CornerKey> keys;  //By vertex
+};
+
+#pragma endregion
+
+bool parseObj(const char* begin, const char* end, const char* name, ObjMesh& mesh)
+{
+	std::vector<float> positions, textureCoords, normals;
+	VertexMap vertices;
+	mesh = ObjMesh();
+
+	uint line = 1;
+	auto fail = [&](const char* reason)
+	{
+		printf("%s:%u: %s\n", name, line, reason);
+		mesh = ObjMesh();
+		return false;
+	};
+
+	//Resolves a 1 based or negative index in a list of count elements, -1 if it's out of range
+	auto resolve = [](int index, size_t count)
+	{
+		long long resolved = index > 0 ? (long long)index - 1 : (long long)count + index;
+		return index != 0 && resolved >= 0 && resolved < (long long)count ? (int)resolved : -1;
+	};
+
+	for (const char* p = begin; p < end; line++)
+	{
+		const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+		if (lineEnd == nullptr)
+			lineEnd = end;
+		p = skipBlanks(p, lineEnd);
+
+		if (lineEnd - p >= 2 && p[0] == 'v' && (isBlank(p[1]) || p[1] == 'n' || p[1] == 't'))
+		{
+			//v x y z [w], vt u [v [w]], vn x y z
+			std::vector<float>& list = p[1] == 'n' ? normals : p[1] == 't' ? textureCoords : positions;
+			uint required = p[1] == 't' ? 1 : 3;
+			uint wanted = p[1] == 't' ? 2 : 3;
+			p += isBlank(p[1]) ? 1 : 2;
+			for (uint i = 0; i < wanted; i++)
+			{
+				float value = 0;
+				const char* next = parseFloat(skipBlanks(p, lineEnd), lineEnd, value);
+				if (next == nullptr && i < required)
+					return fail("expected a number");
+				list.push_back(value);
+				p = next != nullptr ? next : p;
+			}
+		}
+		else if (lineEnd - p >= 2 && p[0] == 'f' && isBlank(p[1]))
+		{
+			//f v[/vt][/vn] ..., triangulated as a fan around the first corner
+			uint first = 0, previous = 0, corners = 0;
+			for (p = skipBlanks(p + 1, lineEnd); p < lineEnd; p = skipBlanks(p, lineEnd), corners++)
+			{
+				CornerKey key = { -1, -1, -1 };
+				int index;
+				if ((p = parseInt(p, lineEnd, index)) == nullptr)
+					return fail("expected a vertex index");
+				if ((key.position = resolve(index, positions.size() / 3)) < 0)
+					return fail("position index out of range");
+				if (p < lineEnd && *p == '/')
+				{
+					p++;
+					if (p < lineEnd && *p != '/')
+					{
+						if ((p = parseInt(p, lineEnd, index)) == nullptr)
+							return fail("expected a texture coordinates index");
+						if ((key.textureCoords = resolve(index, textureCoords.size() / 2)) < 0)
+							return fail("texture coordinates index out of range");
+					}
+					if (p < lineEnd && *p == '/')
+					{
+						if ((p = parseInt(p + 1, lineEnd, index)) == nullptr)
+							return fail("expected a normal index");
+						if ((key.normal = resolve(index, normals.size() / 3)) < 0)
+							return fail("normal index out of range");
+					}
+				}
+				if (p < lineEnd && !isBlank(*p))
+					return fail("unexpected character in a face");
+
+				bool added;
+				uint vertex = vertices.insert(key, (uint)mesh.vertices.size(), added);
+				if (added)
+				{
+					ObjVertex v = {};
+					memcpy(v.position, &positions[key.position * 3], sizeof(v.position));
+					if (key.textureCoords >= 0)
+						memcpy(v.textureCoords, &textureCoords[key.textureCoords * 2], sizeof(v.textureCoords));
+					if (key.normal >= 0)
+						memcpy(v.normal, &normals[key.normal * 3], sizeof(v.normal));
+					mesh.vertices.push_back(v);
+				}
+
+				if (corners == 0)
+					first = vertex;
+				else if (corners >= 2)
+				{
+					mesh.indices.push_back(first);
+					mesh.indices.push_back(previous);
+					mesh.indices.push_back(vertex);
+				}
+				previous = vertex;
+			}
+			if (corners < 3)
+				return fail("a face needs at least 3 vertices");
+		}
+
+		p = lineEnd + 1;
+	}
+
+	return true;
+}
+
+void ObjMesh::narrowIndices()
+{
+	if (vertices.size() <= 65536 && !indices.empty())
+	{
+		shortIndices.assign(indices.begin(), indices.end());
+		indices = std::vector<uint>();
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "util/Utility.hpp"
+#include "rendering/RenderDevice.hpp"
+
+#include <vector>
+
+/* Parses Wavefront OBJ models into an indexed triangle mesh ready to be uploaded.
+ *
+ * The text is scanned in place, one line at a time (found with memchr), numbers being parsed by hand:
+ * no stream, no string and no allocation per token. Only the positions (v), texture coordinates (vt),
+ * normals (vn) and faces (f) are read, polygons are triangulated as fans and negative indices are
+ * relative to the end of their list. Every other statement is ignored.
+ *
+ * A vertex is emitted per distinct position/texture coordinates/normal triple of the faces, so the shared
+ * corners of the voxel models are only stored once. The triples are found in a flat table indexed by
+ * position, the faces of a model mostly reference nearby positions so its' lookups stay in the cache.
+ */
+
+/// <summary>
+/// An interleaved vertex, attributes 0, 1 and 2 of objectVertex.vert.
+/// </summary>
+struct ObjVertex
+{
+	float position[3];
+	float textureCoords[2];  //0 if the face has none
+	float normal[3];         //0 if the face has none
+};
+
+/// <summary>
+/// A parsed model.
+/// </summary>
+struct ObjMesh
+{
+	std::vector<ObjVertex> vertices;
+	std::vector<uint> indices;          //Empty if shortIndices is used
+	std::vector<uint16> shortIndices;   //Used when there are at most 65536 vertices
+
+	/// <summary>
+	/// Moves the indices to shortIndices if there are at most 65536 vertices.
+	/// </summary>
+	void narrowIndices();
+
+	IndexType indexType() const { return indices.empty() ? IndexType::UINT16 : IndexType::UINT32; }
+	uint indexCount() const { return (uint)(indices.empty() ? shortIndices.size() : indices.size()); }
+	const void* indexData() const { return indices.empty() ? (const void*)shortIndices.data() : (const void*)indices.data(); }
+	size_t indexSize() const { return indices.empty() ? shortIndices.size() * sizeof(uint16) : indices.size() * sizeof(uint); }
+};
+
+/// <summary>
+/// Parses the text of an OBJ file, in 32 bits indices. Prints the line of the first error.
+/// </summary>
+/// <param name="name">The name of the file, for the errors.</param>
+/// <returns>false if a statement is malformed or an index is out of range.</returns>
+bool parseObj(const char* begin, const char* end, const char* name, ObjMesh& mesh);
@@ -0,0 +1,201 @@
+#include "TextureCache.hpp"
+#include "FileIO.hpp"
+#include "rendering/TextureCompression.hpp"
+
+#include "stb_image.h"
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+static_assert(std::endian::native == std::endian::little, "Cached textures are little endian");
+
+std::string TextureCache::directory = TextureCache::DIRECTORY;
+
+struct CacheHeader
+{
+	char magic[4];
+	uint version;
+	uint64 sourceHash;  //Also in the file name, checked against collisions of truncated names
+	uint format;        //CompressedFormat
+	uint levelCount;
+};
+
+/// <summary>
+/// A level in a cached texture, its' offset is from the end of the level table.
+/// </summary>
+struct CacheLevel
+{
+	uint width, height;
+	uint offset, size;
+};
+
+static const char MAGIC[4] = { 'P', 'X', 'T', 'C' };
+static const size_t ALIGNMENT = 16;
+
+static size_t align(size_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+/// <summary>
+/// Reads a whole binary file.
+/// </summary>
+static bool readBytes(constring path, std::vector<uint8>& bytes)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+	bytes.resize((size_t)file.tellg());
+	file.seekg(0);
+	return (bool)file.read((char*)bytes.data(), bytes.size());
+}
+
+uint64 TextureCache::hash(const uint8* bytes, size_t size)
+{
+	return fnv1a(bytes, size);
+}
+
+std::string TextureCache::pathOf(uint64 hash)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx.pxt", hash);
+	return directory + name;
+}
+
+void TextureCache::compress(const uint8* pixels, uint width, uint height, CompressedTexture& texture)
+{
+	std::vector<MipLevel> mips = buildMipChain(pixels, width, height);
+	texture.format = chooseCompressedFormat(pixels, width, height); //Smaller levels are opaque if the image is
+
+	texture.levels.clear();
+	size_t size = 0;
+	for (uint i = 0; i <= mips.size(); i++)
+	{
+		uint levelWidth = i == 0 ? width : mips[i - 1].width;
+		uint levelHeight = i == 0 ? height : mips[i - 1].height;
+		size_t levelSize = compressedSize(texture.format, levelWidth, levelHeight);
+		texture.levels.push_back({ levelWidth, levelHeight, size, levelSize });
+		size = align(size + levelSize);
+	}
+
+	texture.data.assign(size, 0);
+	for (uint i = 0; i < texture.levels.size(); i++)
+	{
+		const CompressedTexture::Level& level = texture.levels[i];
+		compressImage(i == 0 ? pixels : mips[i - 1].pixels.data(), level.width, level.height, texture.format,
+			texture.data.data() + level.offset);
+	}
+}
+
+bool TextureCache::read(constring path, uint64 hash, CompressedTexture& texture)
+{
+	std::vector<uint8> bytes;
+	if (!readBytes(path, bytes))
+		return false; //Not cached yet
+
+	auto reject = [&](const char* reason)
+	{
+		printf("Ignoring %s: %s\n", path.c_str(), reason);
+		return false;
+	};
+
+	if (bytes.size() < sizeof(CacheHeader))
+		return reject("truncated header");
+	CacheHeader header;
+	memcpy(&header, bytes.data(), sizeof(header));
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+		return reject("not a cached texture");
+	if (header.version != VERSION)
+		return reject("cached by another version of the engine");
+	if (header.sourceHash != hash)
+		return reject("cached from another texture");
+	if (header.format > (uint)CompressedFormat::BC3 || header.levelCount == 0 || header.levelCount > 32
+		|| sizeof(CacheHeader) + (size_t)header.levelCount * sizeof(CacheLevel) > bytes.size())
+		return reject("corrupted header");
+
+	size_t start = align(sizeof(CacheHeader) + (size_t)header.levelCount * sizeof(CacheLevel));
+	texture.format = (CompressedFormat)header.format;
+	texture.levels.clear();
+	for (uint i = 0; i < header.levelCount; i++)
+	{
+		CacheLevel level;
+		memcpy(&level, bytes.data() + sizeof(CacheHeader) + i * sizeof(CacheLevel), sizeof(level));
+		if (level.size != compressedSize(texture.format, level.width, level.height)
+			|| start + (uint64)level.offset + level.size > bytes.size())
+			return reject("corrupted level");
+		texture.levels.push_back({ level.width, level.height, level.offset, level.size });
+	}
+
+	bytes.erase(bytes.begin(), bytes.begin() + start);
+	texture.data = std::move(bytes);
+	return true;
+}
+
+bool TextureCache::write(constring path, uint64 hash, const CompressedTexture& texture)
+{
+	CacheHeader header = {};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.sourceHash = hash;
+	header.format = (uint)texture.format;
+	header.levelCount = (uint)texture.levels.size();
+
+	std::vector<uint8> bytes(align(sizeof(CacheHeader) + texture.levels.size() * sizeof(CacheLevel)), 0);
+	memcpy(bytes.data(), &header, sizeof(header));
+	for (uint i = 0; i < texture.levels.size(); i++)
+	{
+		const CompressedTexture::Level& level = texture.levels[i];
+		CacheLevel cached = { level.width, level.height, (uint)level.offset, (uint)level.size };
+		memcpy(bytes.data() + sizeof(CacheHeader) + i * sizeof(CacheLevel), &cached, sizeof(cached));
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	{
+		std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.write((const char*)bytes.data(), bytes.size())
+			|| !file.write((const char*)texture.data.data(), texture.data.size()))
+			return false;
+	}
+
+	//Fails on Windows if another thread wrote it first, which is just as good
+	std::filesystem::rename(temporary, path, error);
+	if (error)
+		std::filesystem::remove(temporary, error);
+	return true;
+}
+
+bool TextureCache::load(constring fileName, CompressedTexture& texture, bool& cached)
+{
+	std::string source = "res/textures/" + fileName;
+	std::vector<uint8> storage;
+	size_t size = 0;
+	const uint8* bytes = readAsset(source, storage, size);
+	if (bytes == nullptr || size == 0)
+	{
+		printf("Couldn't open the file: %s\n", source.c_str());
+		return false;
+	}
+
+	uint64 contentHash = hash(bytes, size);
+	std::string path = pathOf(contentHash);
+	cached = read(path, contentHash, texture);
+	if (cached)
+		return true;
+
+	int width, height, channels;
+	uint8* pixels = stbi_load_from_memory(bytes, (int)size, &width, &height, &channels, 4);
+	if (pixels == nullptr)
+	{
+		printf("Couldn't decode the file: %s (%s)\n", source.c_str(), stbi_failure_reason());
+		return false;
+	}
+	compress(pixels, width, height, texture);
+	stbi_image_free(pixels);
+
+	if (!write(path, contentHash, texture))
+		printf("Couldn't write %s\n", path.c_str());
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "rendering/RenderDevice.hpp"
+
+#include <string>
+#include <vector>
+
+/* The first time a texture is loaded, its' mip chain is computed and block compressed (see
+ * TextureCompression.hpp), then written in res/cache/textures under the hash of the content of its'
+ * file. The next launches find it there and upload the compressed levels as they are: the PNG is read
+ * to be hashed but not decoded, and the textures take 4 to 8 times less video memory.
+ *
+ * Layout, little endian:
+ *   CacheHeader
+ *   one CacheLevel per level, from the largest
+ *   the levels, each one aligned on 16 bytes
+ *
+ * Editing a texture changes its' hash, so the cache is never stale, files of old versions of the textures
+ * are just left behind. Changing the layout or the compression requires incrementing TextureCache::VERSION.
+ */
+
+/// <summary>
+/// The compressed mip chain of a texture.
+/// </summary>
+struct CompressedTexture
+{
+	/// <summary>
+	/// Where a level is in data.
+	/// </summary>
+	struct Level
+	{
+		uint width, height;
+		size_t offset, size;
+	};
+
+	CompressedFormat format = CompressedFormat::BC1;
+	std::vector<Level> levels;  //From the largest
+	std::vector<uint8> data;    //Every level
+
+	bool empty() const { return levels.empty(); }
+};
+
+/// <summary>
+/// A static class that gets the compressed mip chains of the textures. See the top of TextureCache.hpp.
+/// </summary>
+class TextureCache
+{
+public:
+
+	static constexpr uint VERSION = 1;
+	static constexpr const char* DIRECTORY = "res/cache/textures";
+
+	static std::string directory; //Where the textures are cached, DIRECTORY unless changed before loading
+
+	/// <summary>
+	/// Loads the compressed mip chain of a texture from the cache, compressing it and writing it in the
+	/// cache if it's not there. From any thread.
+	/// </summary>
+	/// <param name="fileName">Relative file name from res/textures.</param>
+	/// <param name="cached">Receives whether it was found in the cache.</param>
+	/// <returns>false if the file couldn't be read or decoded.</returns>
+	static bool load(constring fileName, CompressedTexture& texture, bool& cached);
+
+	/// <summary>
+	/// Computes and compresses the mip chain of an RGBA image.
+	/// </summary>
+	static void compress(const uint8* pixels, uint width, uint height, CompressedTexture& texture);
+
+	/// <summary>
+	/// Returns the 64 bits FNV-1a hash of some bytes.
+	/// </summary>
+	static uint64 hash(const uint8* bytes, size_t size);
+
+private:
+
+	/// <summary>
+	/// Returns the path of the cached texture of a content hash.
+	/// </summary>
+	static std::string pathOf(uint64 hash);
+
+	/// <summary>
+	/// Reads a cached texture and checks its' header and the bounds of its' levels.
+	/// </summary>
+	/// <returns>Whether it can be used.</returns>
+	static bool read(constring path, uint64 hash, CompressedTexture& texture);
+
+	/// <summary>
+	/// Writes a cached texture. Written in a temporary file first, so concurrent loads of the same
+	/// content never read a partial file.
+	/// </summary>
+	static bool write(constring path, uint64 hash, const CompressedTexture& texture);
+};
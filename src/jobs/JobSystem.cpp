@@ -0,0 +1,202 @@
+#include "JobSystem.hpp"
+#include "WorkStealingDeque.hpp"
+
+#include <cstdio>
+
+std::vector<WorkStealingDeque*> JobSystem::deques;
+std::vector<std::thread> JobSystem::threads;
+std::atomic<bool> JobSystem::running(false);
+std::atomic<uint> JobSystem::pending(0);
+std::atomic<uint> JobSystem::sleeping(0);
+std::mutex JobSystem::sleepMutex;
+std::condition_variable JobSystem::wake;
+thread_local uint JobSystem::worker = JobSystem::NOT_A_WORKER;
+
+static const uint SPINS_BEFORE_SLEEP = 64;
+
+void JobSystem::init(uint threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	running = true;
+	worker = 0;
+	for (uint i = 0; i < threadCount; i++)
+		deques.push_back(new WorkStealingDeque());
+	for (uint i = 1; i < threadCount; i++)
+		threads.emplace_back(workerLoop, i);
+
+	printf("Started the JobSystem with %u workers\n", threadCount);
+}
+
+void JobSystem::destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+	wake.notify_all();
+
+	for (std::thread& thread : threads)
+		thread.join();
+	threads.clear();
+
+	for (WorkStealingDeque* deque : deques)
+		delete deque;
+	deques.clear();
+	worker = NOT_A_WORKER;
+	pending = 0;
+}
+
+void JobSystem::workerLoop(uint index)
+{
+	worker = index;
+	uint spins = 0;
+	while (running)
+	{
+		Job* job = findJob();
+		if (job != nullptr)
+		{
+			execute(job);
+			spins = 0;
+			continue;
+		}
+
+		if (++spins < SPINS_BEFORE_SLEEP)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		//Pushers check sleeping after incrementing pending, so one of us always sees the other
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleeping++;
+		wake.wait(lock, [] { return pending > 0 || !running; });
+		sleeping--;
+		spins = 0;
+	}
+}
+
+void JobSystem::push(Job* job)
+{
+	if (worker == NOT_A_WORKER || !deques[worker]->push(job))
+	{
+		execute(job); //Not started, not a worker or too many jobs: running it now is always correct
+		return;
+	}
+
+	pending++;
+	if (sleeping > 0)
+	{
+		//Taking the lock ensures the sleeper is either waiting or will see pending
+		{ std::lock_guard<std::mutex> lock(sleepMutex); }
+		wake.notify_one();
+	}
+}
+
+Job* JobSystem::findJob()
+{
+	if (worker == NOT_A_WORKER || pending == 0)
+		return nullptr;
+
+	Job* job = deques[worker]->pop();
+	for (uint i = 1; job == nullptr && i < deques.size(); i++)
+		job = deques[(worker + i) % deques.size()]->steal();
+
+	if (job != nullptr)
+		pending--;
+	return job;
+}
+
+void JobSystem::execute(Job* job)
+{
+	job->function();
+	Counter* counter = job->counter;
+	delete job;
+
+	if (counter != nullptr)
+		decrement(*counter);
+}
+
+void JobSystem::decrement(Counter& counter)
+{
+	uint value = counter.value.load(std::memory_order_acquire);
+	while (value > 1)
+		if (counter.value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel))
+			return;
+
+	//Probably the last job of the group. Reaching 0 under the lock means wait() can't return,
+	//and the counter can't be destroyed, before we are done with it
+	std::vector<Job*> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter.mutex);
+		if (counter.value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			continuations.swap(counter.continuations);
+	}
+	for (Job* continuation : continuations)
+		push(continuation);
+}
+
+void JobSystem::run(std::function<void()> function, Counter* counter, Counter* dependency)
+{
+	if (counter != nullptr)
+		counter->value.fetch_add(1, std::memory_order_relaxed);
+
+	Job* job = new Job{ std::move(function), counter };
+	if (dependency != nullptr)
+	{
+		std::lock_guard<std::mutex> lock(dependency->mutex);
+		if (!dependency->done())
+		{
+			dependency->continuations.push_back(job);
+			return;
+		}
+	}
+	push(job);
+}
+
+void JobSystem::wait(Counter& counter)
+{
+	while (!counter.done())
+	{
+		Job* job = findJob();
+		if (job != nullptr)
+			execute(job);
+		else
+			std::this_thread::yield();
+	}
+
+	//The last job may still hold the lock
+	std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+bool JobSystem::tryExecute()
+{
+	Job* job = findJob();
+	if (job == nullptr)
+		return false;
+	execute(job);
+	return true;
+}
+
+void JobSystem::parallelFor(uint begin, uint end, uint grain, const std::function<void(uint, uint)>& function)
+{
+	if (end <= begin)
+		return;
+	if (grain == 0)
+		grain = std::max(1u, (end - begin) / (workerCount() * 4));
+
+	if (end - begin <= grain)
+	{
+		function(begin, end);
+		return;
+	}
+
+	Counter counter;
+	for (uint first = begin; first < end; first += grain)
+	{
+		uint last = std::min(end, first + grain);
+		run([&function, first, last] { function(first, last); }, &counter);
+	}
+	wait(counter);
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* The JobSystem runs small functions (jobs) on one worker thread per core. The main thread is
+ * worker 0 and helps executing jobs whenever it waits for a Counter.
+ *
+ * Each worker owns a WorkStealingDeque: the jobs it creates are pushed on its' own deque and popped
+ * in LIFO order (they are hot in its' cache), idle workers steal the oldest jobs of the others.
+ * Jobs are tracked with Counters: a Counter is incremented when a job is run with it and decremented
+ * when the job ends, so waiting for a Counter waits for a whole group of jobs. A job can also depend
+ * on a Counter, it is only pushed once that Counter reaches 0.
+ *
+ * Only the main thread and the workers can create jobs.
+ */
+
+class WorkStealingDeque;
+class Counter;
+
+/// <summary>
+/// A function executed by the JobSystem.
+/// </summary>
+struct Job
+{
+	std::function<void()> function;
+	Counter* counter; //Decremented when the function returns, can be null
+};
+
+/// <summary>
+/// Counts the unfinished jobs of a group. It must not be destroyed nor reused before being waited on.
+/// </summary>
+class Counter
+{
+public:
+
+	Counter() : value(0) {}
+
+	Counter(const Counter&) = delete;
+	Counter& operator=(const Counter&) = delete;
+
+	/// <summary>
+	/// Returns whether all the jobs of the group ended.
+	/// </summary>
+	bool done() const { return value.load(std::memory_order_acquire) == 0; }
+
+private:
+
+	friend class JobSystem;
+
+	std::atomic<uint> value;
+	std::mutex mutex;                  //Protects continuations
+	std::vector<Job*> continuations;   //Jobs pushed when value reaches 0
+};
+
+/// <summary>
+/// A static class that runs jobs on all the cores.
+/// </summary>
+class JobSystem
+{
+public:
+
+	/// <summary>
+	/// Starts the worker threads. Until then, jobs are executed immediately by the caller.
+	/// </summary>
+	/// <param name="threadCount">The number of workers including the main thread, 0 for one per core.</param>
+	static void init(uint threadCount = 0);
+
+	/// <summary>
+	/// Stops and joins the worker threads. The jobs left are not executed.
+	/// </summary>
+	static void destroy();
+
+	/// <summary>
+	/// Returns the number of workers including the main thread, 1 before init().
+	/// </summary>
+	static uint workerCount() { return deques.empty() ? 1 : (uint)deques.size(); }
+
+	/// <summary>
+	/// Runs a job.
+	/// </summary>
+	/// <param name="counter">Incremented now and decremented when the job ends, can be null.</param>
+	/// <param name="dependency">The job starts only once this counter reaches 0, can be null.</param>
+	static void run(std::function<void()> function, Counter* counter = nullptr, Counter* dependency = nullptr);
+
+	/// <summary>
+	/// Executes jobs until the counter reaches 0.
+	/// </summary>
+	static void wait(Counter& counter);
+
+	/// <summary>
+	/// Executes one pending job if there is one, lets the main thread make progress on jobs it doesn't
+	/// wait for.
+	/// </summary>
+	/// <returns>Whether a job was executed.</returns>
+	static bool tryExecute();
+
+	/// <summary>
+	/// Splits [begin, end) in ranges of at most grain elements and calls function(rangeBegin, rangeEnd)
+	/// on each of them in parallel. Returns once all the ranges are done.
+	/// </summary>
+	/// <param name="grain">The size of the ranges, 0 to make about 4 ranges per worker.</param>
+	static void parallelFor(uint begin, uint end, uint grain, const std::function<void(uint, uint)>& function);
+
+	/// <summary>
+	/// Sorts the data by sorting ranges in parallel then merging them in parallel.
+	/// </summary>
+	/// <param name="scratch">Resized to the size of the data, kept by the caller to avoid reallocations.</param>
+	template<typename T, typename Compare>
+	static void parallelSort(std::vector<T>& data, std::vector<T>& scratch, Compare less)
+	{
+		const uint size = (uint)data.size();
+		uint ranges = 1;
+		while (ranges < workerCount() * 2 && size / (ranges * 2) >= MIN_SORT_RANGE)
+			ranges *= 2;
+
+		if (ranges == 1)
+		{
+			std::sort(data.begin(), data.end(), less);
+			return;
+		}
+
+		auto bound = [size, ranges](uint range) { return (uint)((uint64)size * range / ranges); };
+		parallelFor(0, ranges, 1, [&](uint first, uint last)
+		{
+			for (uint r = first; r < last; r++)
+				std::sort(data.begin() + bound(r), data.begin() + bound(r + 1), less);
+		});
+
+		//Merging pairs of ranges, ping-ponging between data and scratch
+		scratch.resize(size);
+		std::vector<T>* from = &data;
+		std::vector<T>* to = &scratch;
+		for (uint width = 1; width < ranges; width *= 2)
+		{
+			parallelFor(0, ranges / (width * 2), 1, [&](uint first, uint last)
+			{
+				for (uint pair = first; pair < last; pair++)
+				{
+					uint b = bound(pair * width * 2), m = bound(pair * width * 2 + width), e = bound((pair + 1) * width * 2);
+					std::merge(from->begin() + b, from->begin() + m, from->begin() + m, from->begin() + e, to->begin() + b, less);
+				}
+			});
+			std::swap(from, to);
+		}
+		if (from != &data)
+			data.swap(scratch);
+	}
+
+private:
+
+	static constexpr uint MIN_SORT_RANGE = 4096; //Smaller ranges aren't worth a job
+	static constexpr uint NOT_A_WORKER = 0xFFFFFFFF;
+
+	static std::vector<WorkStealingDeque*> deques; //One per worker, the main thread's first
+	static std::vector<std::thread> threads;
+	static std::atomic<bool> running;
+
+	static std::atomic<uint> pending;  //Jobs pushed but not taken yet
+	static std::atomic<uint> sleeping; //Workers waiting on wake
+	static std::mutex sleepMutex;
+	static std::condition_variable wake;
+
+	static thread_local uint worker; //Index of the worker of the current thread
+
+	/// <summary>
+	/// The loop of a worker thread: executes jobs, sleeps when there are none.
+	/// </summary>
+	static void workerLoop(uint index);
+
+	/// <summary>
+	/// Pushes a job on the deque of the current worker, executes it if the deque is full.
+	/// </summary>
+	static void push(Job* job);
+
+	/// <summary>
+	/// Pops a job from the deque of the current worker, or steals one from another worker.
+	/// </summary>
+	/// <returns>nullptr if there are none.</returns>
+	static Job* findJob();
+
+	/// <summary>
+	/// Executes and deletes the job, then decrements its' counter.
+	/// </summary>
+	static void execute(Job* job);
+
+	/// <summary>
+	/// Decrements the counter and pushes its' continuations when it reaches 0.
+	/// </summary>
+	static void decrement(Counter& counter);
+};
@@ -0,0 +1,251 @@
+#include "TaskGraph.hpp"
+
+#include <cstdio>
+#include <map>
+
+TaskGraph::~TaskGraph()
+{
+	for (Task* task : tasks)
+		delete task;
+}
+
+uint TaskGraph::add(const char* kind, constring name, std::function<void()> function, TaskThread thread)
+{
+	Task* task = new Task();
+	task->kind = kind;
+	task->name = name;
+	task->function = std::move(function);
+	task->thread = thread;
+	tasks.push_back(task);
+	return (uint)tasks.size() - 1;
+}
+
+void TaskGraph::depend(uint task, uint dependency)
+{
+	tasks[dependency]->dependents.push_back(task);
+	if (!tasks[dependency]->done)
+		tasks[task]->dependencies++;
+}
+
+std::vector<uint> TaskGraph::sortTasks() const
+{
+	std::vector<uint> order;
+	std::vector<uint> incoming(tasks.size(), 0);
+	for (const Task* task : tasks)
+		for (uint dependent : task->dependents)
+			incoming[dependent]++;
+
+	for (uint i = 0; i < tasks.size(); i++)
+		if (incoming[i] == 0)
+			order.push_back(i);
+
+	//Kahn's algorithm, order doubles as the queue
+	for (uint i = 0; i < order.size(); i++)
+		for (uint dependent : tasks[order[i]]->dependents)
+			if (--incoming[dependent] == 0)
+				order.push_back(dependent);
+
+	if (order.size() != tasks.size())
+		order.clear();
+	return order;
+}
+
+bool TaskGraph::run()
+{
+	if (sortTasks().empty() && !tasks.empty())
+	{
+		printf("TaskGraph: the dependencies have a cycle, nothing was run\n");
+		return false;
+	}
+
+	if (!started)
+	{
+		firstStart = Clock::now();
+		started = true;
+	}
+
+	std::vector<Task*> ready;
+	uint count = 0;
+	for (Task* task : tasks)
+	{
+		if (task->done)
+			continue;
+		count++;
+		task->remaining.store(task->dependencies, std::memory_order_relaxed);
+		if (task->dependencies == 0)
+			ready.push_back(task);
+	}
+	finished = 0;
+
+	for (Task* task : ready)
+		schedule(task);
+
+	//Runs the main tasks as they get ready, helps the workers in between
+	std::vector<Task*> mainTasks;
+	while (finished.load(std::memory_order_acquire) < count)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mainMutex);
+			mainTasks.swap(mainQueue);
+		}
+		for (Task* task : mainTasks)
+			execute(task);
+
+		if (mainTasks.empty() && !JobSystem::tryExecute())
+			std::this_thread::yield();
+		mainTasks.clear();
+	}
+	JobSystem::wait(jobs);
+
+	for (Task* task : tasks)
+		task->done = true;
+	return true;
+}
+
+void TaskGraph::schedule(Task* task)
+{
+	if (task->thread == TaskThread::MAIN)
+	{
+		std::lock_guard<std::mutex> lock(mainMutex);
+		mainQueue.push_back(task);
+	}
+	else
+		JobSystem::run([this, task]() { execute(task); }, &jobs);
+}
+
+void TaskGraph::execute(Task* task)
+{
+	task->start = Clock::now();
+	if (task->function)
+		task->function();
+	task->end = Clock::now();
+
+	for (uint dependent : task->dependents)
+	{
+		Task* next = tasks[dependent];
+		if (!next->done && next->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			schedule(next);
+	}
+	finished.fetch_add(1, std::memory_order_release);
+}
+
+double TaskGraph::durationMs(const Task* task)
+{
+	return std::chrono::duration<double, std::milli>(task->end - task->start).count();
+}
+
+double TaskGraph::totalMs() const
+{
+	Clock::time_point last = firstStart;
+	for (const Task* task : tasks)
+		if (task->done && task->end > last)
+			last = task->end;
+	return std::chrono::duration<double, std::milli>(last - firstStart).count();
+}
+
+double TaskGraph::workMs() const
+{
+	double ms = 0;
+	for (const Task* task : tasks)
+		if (task->done)
+			ms += durationMs(task);
+	return ms;
+}
+
+std::vector<uint> TaskGraph::criticalPath(double& ms) const
+{
+	std::vector<uint> order = sortTasks();
+	std::vector<double> finish(tasks.size(), 0);   //Longest chain ending with the task
+	std::vector<int> previous(tasks.size(), -1);  //In that chain
+
+	int last = -1;
+	ms = 0;
+	for (uint i : order)
+	{
+		finish[i] += tasks[i]->done ? durationMs(tasks[i]) : 0;
+		if (finish[i] > ms)
+		{
+			ms = finish[i];
+			last = (int)i;
+		}
+		for (uint dependent : tasks[i]->dependents)
+			if (finish[i] > finish[dependent])
+			{
+				finish[dependent] = finish[i];
+				previous[dependent] = (int)i;
+			}
+	}
+
+	std::vector<uint> path;
+	for (int i = last; i >= 0; i = previous[i])
+		path.insert(path.begin(), (uint)i);
+	return path;
+}
+
+double TaskGraph::criticalPathMs() const
+{
+	double ms;
+	criticalPath(ms);
+	return ms;
+}
+
+void TaskGraph::printReport(const char* title) const
+{
+	double pathMs;
+	std::vector<uint> path = criticalPath(pathMs);
+	double total = totalMs();
+	double work = workMs();
+
+	printf("%s: %.2f ms total, %.2f ms of work on %u workers (x%.2f), %.2f ms critical path\n", title,
+		total, work, JobSystem::workerCount(), total > 0 ? work / total : 0.0, pathMs);
+
+	//Tasks under 1% of the path are summed up, long chains of small uploads would hide the rest
+	printf("  Critical path:\n");
+	uint shortCount = 0;
+	double shortMs = 0;
+	for (uint i : path)
+	{
+		double ms = durationMs(tasks[i]);
+		if (ms < pathMs * 0.01)
+		{
+			shortCount++;
+			shortMs += ms;
+			continue;
+		}
+		printf("    %8.2f ms  %-10s %s%s\n", ms, tasks[i]->kind, tasks[i]->name.c_str(),
+			tasks[i]->thread == TaskThread::MAIN ? " (main)" : "");
+	}
+	if (shortCount > 0)
+		printf("    %8.2f ms  %u shorter tasks\n", shortMs, shortCount);
+
+	//Kinds in order of first appearance
+	struct KindStats
+	{
+		uint order;
+		uint count = 0;
+		double workMs = 0;
+		Clock::time_point start = Clock::time_point::max();
+		Clock::time_point end = Clock::time_point::min();
+	};
+	std::map<std::string, KindStats> kinds;
+	for (const Task* task : tasks)
+	{
+		if (!task->done || !task->function)
+			continue;
+		KindStats& k = kinds.try_emplace(task->kind, KindStats{ (uint)kinds.size() }).first->second;
+		k.count++;
+		k.workMs += durationMs(task);
+		k.start = std::min(k.start, task->start);
+		k.end = std::max(k.end, task->end);
+	}
+
+	std::vector<std::pair<const std::string*, const KindStats*>> sorted(kinds.size());
+	for (const auto& [kind, stats] : kinds)
+		sorted[stats.order] = { &kind, &stats };
+
+	printf("  Per kind:\n");
+	for (const auto& [kind, stats] : sorted)
+		printf("    %-10s %4u tasks %8.2f ms of work, from %8.2f to %8.2f ms\n", kind->c_str(), stats->count, stats->workMs,
+			std::chrono::duration<double, std::milli>(stats->start - firstStart).count(),
+			std::chrono::duration<double, std::milli>(stats->end - firstStart).count());
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "JobSystem.hpp"
+
+#include <chrono>
+#include <string>
+
+/* A TaskGraph runs functions (tasks) once all the tasks they depend on are done. Worker tasks are run
+ * on the JobSystem, main tasks are run by the thread calling run(), which owns the render device: it
+ * is the only one allowed to make graphic calls. While it has no main task to run, it helps with the
+ * worker tasks.
+ *
+ * Every task belongs to a kind ("textures", "shaders"...) so the report can tell where the time goes.
+ * Tasks without a function only join their dependencies, other tasks can depend on them instead of
+ * depending on every task of a kind.
+ *
+ * Tasks can be added between two runs, depending on tasks already done. The tasks of a graph must not
+ * be added nor run from a task.
+ */
+
+/// <summary>
+/// Where a task runs.
+/// </summary>
+enum class TaskThread
+{
+	WORKER, //Any thread of the JobSystem
+	MAIN    //The thread calling TaskGraph::run()
+};
+
+/// <summary>
+/// Runs tasks in the order of their dependencies, in parallel. See the top of TaskGraph.hpp.
+/// </summary>
+class TaskGraph
+{
+public:
+
+	TaskGraph() = default;
+	~TaskGraph();
+
+	TaskGraph(const TaskGraph&) = delete;
+	TaskGraph& operator=(const TaskGraph&) = delete;
+
+	/// <summary>
+	/// Adds a task.
+	/// </summary>
+	/// <param name="function">Can be null, the task only joins its' dependencies then.</param>
+	/// <returns>The id of the task.</returns>
+	uint add(const char* kind, constring name, std::function<void()> function, TaskThread thread = TaskThread::WORKER);
+
+	/// <summary>
+	/// Makes a task wait for another one. Both must have been added, and the task must not have run yet.
+	/// </summary>
+	void depend(uint task, uint dependency);
+
+	/// <summary>
+	/// Runs every task not run yet and returns once they are all done.
+	/// </summary>
+	/// <returns>false if the dependencies have a cycle, nothing is run then.</returns>
+	bool run();
+
+	/// <summary>
+	/// Returns the time between the start of the first run and the end of the last task, in ms.
+	/// </summary>
+	double totalMs() const;
+
+	/// <summary>
+	/// Returns the time spent in all the tasks, in ms.
+	/// </summary>
+	double workMs() const;
+
+	/// <summary>
+	/// Returns the duration of the longest chain of dependent tasks, in ms. No scheduling could run the
+	/// graph faster.
+	/// </summary>
+	double criticalPathMs() const;
+
+	/// <summary>
+	/// Prints the total, work and critical path times, the tasks of the critical path and the time spent
+	/// per kind.
+	/// </summary>
+	void printReport(const char* title) const;
+
+private:
+
+	typedef std::chrono::steady_clock Clock;
+
+	struct Task
+	{
+		const char* kind;
+		std::string name;
+		std::function<void()> function;
+		TaskThread thread;
+		std::vector<uint> dependents;
+		uint dependencies = 0;            //Not done when the run started
+		std::atomic<uint> remaining{ 0 }; //Dependencies left during the run
+		bool done = false;
+
+		Clock::time_point start;
+		Clock::time_point end;
+	};
+
+	std::vector<Task*> tasks;
+	Clock::time_point firstStart;
+	bool started = false;
+
+	Counter jobs;                        //The worker tasks of the current run
+	std::atomic<uint> finished{ 0 };     //Tasks of the current run done
+	std::mutex mainMutex;
+	std::vector<Task*> mainQueue;        //Main tasks ready to run
+
+	/// <summary>
+	/// Queues a main task for the thread running the graph, runs a worker task on the JobSystem.
+	/// </summary>
+	void schedule(Task* task);
+
+	/// <summary>
+	/// Runs the function of a task, then schedules the dependents it was the last dependency of.
+	/// </summary>
+	void execute(Task* task);
+
+	/// <summary>
+	/// Returns the tasks sorted so that every task comes after its' dependencies, empty if there's a cycle.
+	/// </summary>
+	std::vector<uint> sortTasks() const;
+
+	/// <summary>
+	/// Returns the tasks of the longest chain of dependent tasks, first to last.
+	/// </summary>
+	/// <param name="ms">Receives the duration of the chain.</param>
+	std::vector<uint> criticalPath(double& ms) const;
+
+	/// <summary>
+	/// Returns the duration of a task, in ms.
+	/// </summary>
+	static double durationMs(const Task* task);
+};
@@ -0,0 +1,60 @@
+#include "WorkStealingDeque.hpp"
+
+//Follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli)
+
+WorkStealingDeque::WorkStealingDeque() :
+	top(0), bottom(0)
+{
+	for (std::atomic<Job*>& job : jobs)
+		job.store(nullptr, std::memory_order_relaxed);
+}
+
+bool WorkStealingDeque::push(Job* job)
+{
+	int64_t b = bottom.load(std::memory_order_relaxed);
+	int64_t t = top.load(std::memory_order_acquire);
+	if (b - t >= (int64_t)CAPACITY)
+		return false;
+
+	jobs[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release); //Publishes the job to the thieves' acquire
+	return true;
+}
+
+Job* WorkStealingDeque::pop()
+{
+	int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+
+	if (t > b) //Empty
+	{
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (t == b) //Last job, thieves may be racing for it
+	{
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* WorkStealingDeque::steal()
+{
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t b = bottom.load(std::memory_order_acquire);
+
+	if (t >= b)
+		return nullptr;
+
+	Job* job = jobs[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
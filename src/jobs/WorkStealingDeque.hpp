@@ -0,0 +1,49 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+struct Job;
+
+/// <summary>
+/// A fixed capacity Chase-Lev deque of jobs. The owner thread pushes and pops at the bottom,
+/// any other thread can steal from the top, without locks.
+/// </summary>
+class WorkStealingDeque
+{
+public:
+
+	static constexpr uint CAPACITY = 4096; //Must be a power of 2
+
+	WorkStealingDeque();
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	/// <summary>
+	/// Pushes a job at the bottom. Only the owner thread can push.
+	/// </summary>
+	/// <returns>false if the deque is full.</returns>
+	bool push(Job* job);
+
+	/// <summary>
+	/// Pops the last pushed job. Only the owner thread can pop.
+	/// </summary>
+	/// <returns>nullptr if the deque is empty or a thief took the last job.</returns>
+	Job* pop();
+
+	/// <summary>
+	/// Takes the oldest job. Any thread can steal.
+	/// </summary>
+	/// <returns>nullptr if the deque is empty or another thread took the job first.</returns>
+	Job* steal();
+
+private:
+
+	//On separate cache lines, thieves write top while the owner writes bottom
+	alignas(64) std::atomic<int64_t> top;
+	alignas(64) std::atomic<int64_t> bottom;
+	alignas(64) std::atomic<Job*> jobs[CAPACITY];
+};
@@ -4,17 +4,123 @@
 
 #include "rendering/Model.hpp"
 #include "rendering/Loader.hpp"
+#include "rendering/BatchRenderer.hpp"
+#include "rendering/UniformBuffers.hpp"
+#include "rendering/GLRenderDevice.hpp"
+#include "rendering/NullRenderDevice.hpp"
+#include "bench/Benchmark.hpp"
+#include "jobs/JobSystem.hpp"
+#include "io/AssetPack.hpp"
 #include <string>
+#include <cstring>
+#include "glm/gtc/matrix_transform.hpp"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
 }
 
+/// <summary>
+/// Returns the projection * view matrix of the 2D camera, showing 10 units vertically.
+/// Its' depth covers every zIndex of BatchRenderer::sortKey(), with a margin so none lies on the far plane.
+/// </summary>
+glm::mat4 cameraMatrix(float aspectRatio)
+{
+	return glm::ortho(-5.0f * aspectRatio, 5.0f * aspectRatio, -5.0f, 5.0f, -32769.0f, 32769.0f);
+}
+
+/// <summary>
+/// Runs the engine without a window nor a GPU, for a fixed number of frames, then prints what
+/// would have been sent to the GPU.
+/// </summary>
+/// <param name="frames">The number of frames to run.</param>
+/// <param name="sprites">The number of sprites added to the scene, spread over all the textures.</param>
+int runHeadless(uint frames, uint sprites)
+{
+	NullRenderDevice device;
+	Loader::init(&device);
+	BatchRenderer::init();
+
+	std::vector<GameObject*> spriteObjects; //Deleted once the frames are run
+	uint textureCount = (uint)Texture::textures.size();
+	for (uint i = 0; i < sprites && textureCount > 0; i++)
+	{
+		Transform transform;
+		transform.position = glm::vec2((float)(i % 64), (float)(i / 64));
+		transform.rotation = (float)(i % 360);
+		GameObject* gameObject = new GameObject(i, "sprite", transform);
+		Renderer::create(i, *gameObject, Texture::textures[i % textureCount], nullptr);
+		spriteObjects.push_back(gameObject);
+	}
+
+	for (uint i = 0; i < frames; i++)
+	{
+		device.beginFrame();
+		Loader::update();
+		UniformBuffers::frame.projectionViewMatrix = cameraMatrix(4.0f / 3.0f);
+		UniformBuffers::updateFrame();
+		BatchRenderer::render();
+	}
+	device.beginFrame(); //Closes the last frame
+
+	const FrameStats& last = device.previousFrame();
+	const FrameStats& total = device.totalStats();
+	printf("Headless run: %u frames, %u sprites\n", frames, sprites);
+	printf("Last frame: %llu bytes uploaded, %u draw calls, %u state changes (%u redundant skipped), %u batches\n",
+		last.bytesUploaded, last.drawCalls, last.stateChanges, last.skippedStateChanges, (uint)BatchRenderer::lastBatches().size());
+	printf("Total (with loading): %llu bytes uploaded, %u draw calls, %u state changes (%u redundant skipped)\n",
+		total.bytesUploaded, total.drawCalls, total.stateChanges, total.skippedStateChanges);
+
+	for (GameObject* gameObject : spriteObjects)
+		delete gameObject; //Removes its' entity from the World
+	BatchRenderer::destroy();
+	Loader::destroy();
+	return 0;
+}
+
 //TODO Add textures, gameobjects and components correctly to JSON
 
-int main() {
+int main(int argc, char** argv) {
 
+	//The main thread is the first worker, the others start now
+	JobSystem::init();
+
+	//--json anywhere reads the JSON files even if the cooked assets are up to date
+	for (int i = 1; i < argc; i++)
+		if (strcmp(argv[i], "--json") == 0)
+			Loader::readJSON = true;
+
+	//--cook validates the JSON files and writes the cooked assets
+	if (argc > 1 && strcmp(argv[1], "--cook") == 0)
+	{
+		int result = Loader::cook();
+		JobSystem::destroy();
+		return result;
+	}
+
+	//--pack writes the loose files in the asset pack
+	if (argc > 1 && strcmp(argv[1], "--pack") == 0)
+	{
+		int result = AssetPack::build();
+		JobSystem::destroy();
+		return result;
+	}
+
+	//--headless [frames] [sprites] runs the engine on the Null device
+	if (argc > 1 && strcmp(argv[1], "--headless") == 0)
+	{
+		int result = runHeadless(argc > 2 ? std::stoi(argv[2]) : 60, argc > 3 ? std::stoi(argv[3]) : 0);
+		JobSystem::destroy();
+		return result;
+	}
+
+	//--benchmark <name> [arguments] runs a benchmark without a window
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+	{
+		int result = Benchmark::run(argc, argv);
+		JobSystem::destroy();
+		return result;
+	}
 
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -26,6 +132,7 @@ int main() {
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
 		glfwTerminate();
+		JobSystem::destroy();
 		return -1;
 	}
 	glfwMakeContextCurrent(window);
@@ -33,25 +140,37 @@ int main() {
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
+		JobSystem::destroy();
 		return -1;
 	}
 
 	glViewport(0, 0, 800, 600);
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-	
-	Loader::init();
+	GLRenderDevice device((GLADloadproc)glfwGetProcAddress);
+	Loader::hotReload = true;  //Only while iterating on the assets in a window
+	Loader::init(&device);
+	BatchRenderer::init();
 	int i = 5;
-		
+
 	while (!glfwWindowShouldClose(window))
 	{
+		device.beginFrame();
+		Loader::update();
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		UniformBuffers::frame.projectionViewMatrix = cameraMatrix(height > 0 ? (float)width / height : 1.0f);
+		UniformBuffers::updateFrame();
+		BatchRenderer::render();
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
+	BatchRenderer::destroy();
 	Loader::destroy();
+	JobSystem::destroy();
 
 	glfwTerminate();
 	return 0;
 }
-
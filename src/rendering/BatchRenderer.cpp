@@ -0,0 +1,181 @@
+#include "BatchRenderer.hpp"
+#include "Loader.hpp"
+#include "UniformBuffers.hpp"
+#include "jobs/JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "glm/trigonometric.hpp"
+
+uint BatchRenderer::instanceBuffer = 0;
+size_t BatchRenderer::instanceCapacity = 0;
+Query BatchRenderer::sprites(maskOf(ComponentType::TRANSFORM) | maskOf(ComponentType::RENDERER));
+std::vector<BatchRenderer::SortItem> BatchRenderer::items;
+std::vector<BatchRenderer::SortItem> BatchRenderer::sortScratch;
+std::vector<SpriteInstance> BatchRenderer::unsorted;
+std::vector<SpriteInstance> BatchRenderer::instances;
+std::vector<SpriteBatch> BatchRenderer::batches;
+
+void BatchRenderer::init()
+{
+	IRenderDevice* device = Loader::device;
+
+	instanceBuffer = device->createBuffer();
+	instanceCapacity = 0;
+
+	//The instance attributes are stored in the quads' vao, so binding the vao is enough to draw
+	device->bindVertexArray(RawModel::quad->vaoID);
+	device->bindBuffer(BufferTarget::ARRAY_BUFFER, instanceBuffer);
+	pointInstanceAttributes(0);
+}
+
+void BatchRenderer::destroy()
+{
+	Loader::device->deleteBuffers({ instanceBuffer });
+	instanceBuffer = 0;
+	instanceCapacity = 0;
+
+	items.clear();
+	sortScratch.clear();
+	unsorted.clear();
+	instances.clear();
+	batches.clear();
+}
+
+uint64 BatchRenderer::sortKey(uint shaderID, uint materialID, uint textureID, float zIndex)
+{
+	float z = std::round(std::clamp(zIndex, -32768.0f, 32767.0f));
+	uint64 biasedZ = (uint64)((int)z + 32768); //Negative zIndex are sorted before positive ones
+
+	return ((uint64)(shaderID   & 0xFFFF) << 48) |
+		   ((uint64)(materialID & 0xFFFF) << 32) |
+		   ((uint64)(textureID  & 0xFFFF) << 16) |
+		   biasedZ;
+}
+
+void BatchRenderer::pointInstanceAttributes(uint firstInstance)
+{
+	//GL 3.3 has no base instance, so each batch moves the attributes' offset instead
+	size_t offset = (size_t)firstInstance * sizeof(SpriteInstance);
+	Loader::device->vertexAttribute(INSTANCE_ATTRIBUTE,     4, AttribType::FLOAT, sizeof(SpriteInstance),
+		offset + offsetof(SpriteInstance, basis), 1);
+	Loader::device->vertexAttribute(INSTANCE_ATTRIBUTE + 1, 4, AttribType::FLOAT, sizeof(SpriteInstance),
+		offset + offsetof(SpriteInstance, translation), 1);
+	Loader::device->vertexAttribute(INSTANCE_ATTRIBUTE + 2, 4, AttribType::FLOAT, sizeof(SpriteInstance),
+		offset + offsetof(SpriteInstance, uvRect), 1);
+}
+
+void BatchRenderer::render()
+{
+	IRenderDevice* device = Loader::device;
+
+	//Used by the Renderers without their own, nothing is drawn without them
+	Material* defaultMaterial = Material::materials.empty() ? nullptr : Material::materials[0];
+	Texture* defaultTexture = Texture::textures.empty() ? nullptr : Texture::textures[0];
+
+	//1. Computing the instances and the sort keys, one linear sweep per chunk, chunks in parallel
+	const uint count = sprites.count();
+	unsorted.resize(count);
+	items.resize(count);
+	std::atomic<uint> skipped(0);
+	sprites.forEachParallel([&](Archetype& archetype, Chunk& chunk, uint firstRow)
+	{
+		const float* x = archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::POSITION_X);
+		const float* y = archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::POSITION_Y);
+		const float* z = archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::Z_INDEX);
+		const float* r = archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::ROTATION);
+		const float* s = archetype.column<float>(chunk, ComponentType::TRANSFORM, Transform::SCALE);
+		const Renderer* renderers = archetype.column<Renderer>(chunk, ComponentType::RENDERER);
+
+		//No branches and no aliasing between the columns, the compiler can vectorize it
+		SpriteInstance* out = unsorted.data() + firstRow;
+		for (uint i = 0; i < chunk.count; i++)
+		{
+			float angle = glm::radians(r[i]);
+			float c = std::cos(angle) * s[i];
+			float sn = std::sin(angle) * s[i];
+			out[i].basis = glm::vec4(c, sn, -sn, c);
+			out[i].translation = glm::vec4(x[i], y[i], z[i], 0);
+		}
+
+		SortItem* item = items.data() + firstRow;
+		uint disabled = 0;
+		for (uint i = 0; i < chunk.count; i++)
+		{
+			const Renderer& renderer = renderers[i];
+			Material* material = renderer.material != nullptr ? renderer.material : defaultMaterial;
+			Texture* texture = renderer.texture != nullptr ? renderer.texture : defaultTexture;
+			if (!renderer.enabled || material == nullptr || texture == nullptr)
+			{
+				item[i] = { SKIPPED, firstRow + i, nullptr, nullptr };
+				disabled++;
+				continue;
+			}
+
+			item[i] = { sortKey(material->shader.id, material->id, texture->textureID, z[i]), firstRow + i, material, texture };
+			out[i].uvRect = texture->uvRect;
+		}
+		skipped += disabled;
+	});
+
+	JobSystem::parallelSort(items, sortScratch,
+		[](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+	items.resize(count - skipped); //Skipped items are sorted last
+
+	//2. Writing the instances in sorted order and cutting them in batches
+	instances.resize(items.size());
+	batches.clear();
+
+	const uint64 bucketMask = ~(uint64)0xFFFF; //Everything but the zIndex
+	for (uint i = 0; i < items.size(); i++)
+	{
+		instances[i] = unsorted[items[i].instance];
+
+		if (i == 0 || (items[i].key & bucketMask) != (items[i - 1].key & bucketMask))
+			batches.push_back({ &items[i].material->shader, items[i].material, items[i].texture, i, 0 });
+		batches.back().count++;
+	}
+
+	if (instances.empty())
+		return;
+
+	//3. Streaming the instances, the buffer is orphaned so we never wait for the previous frame
+	size_t size = instances.size() * sizeof(SpriteInstance);
+	device->bindBuffer(BufferTarget::ARRAY_BUFFER, instanceBuffer);
+	if (instances.size() > instanceCapacity)
+		instanceCapacity = std::max(instances.size(), instanceCapacity * 2);
+	device->bufferData(BufferTarget::ARRAY_BUFFER, nullptr, instanceCapacity * sizeof(SpriteInstance), BufferUsage::STREAM_DRAW);
+	device->bufferSubData(BufferTarget::ARRAY_BUFFER, 0, instances.data(), size);
+
+	//4. One instanced draw per batch, in their order. The buckets aren't sorted by zIndex, so the depth test
+	//layers the sprites across them, spriteFragment.frag discarding the transparent texels
+	device->setBlending(false);
+	device->setDepthTest(true);
+	device->bindVertexArray(RawModel::quad->vaoID);
+	const Shader* currentShader = nullptr;
+	const Material* currentMaterial = nullptr;
+	uint currentTexture = 0;
+	for (const SpriteBatch& batch : batches)
+	{
+		if (batch.shader != currentShader) //The camera is in the Frame block, nothing to set
+		{
+			currentShader = batch.shader;
+			batch.shader->start();
+		}
+		if (batch.material != currentMaterial)
+		{
+			currentMaterial = batch.material;
+			UniformBuffers::bindMaterial(*batch.material);
+		}
+		if (batch.texture->textureID != currentTexture)
+		{
+			currentTexture = batch.texture->textureID;
+			device->bindTexture(0, batch.texture->textureID);
+		}
+		pointInstanceAttributes(batch.start);
+		device->drawElements(RawModel::quad->vertexCount, batch.count);
+	}
+	device->bindVertexArray(0);
+	Shader::stop();
+}
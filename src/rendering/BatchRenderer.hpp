@@ -0,0 +1,112 @@
+#pragma once
+
+#include "rendering/Model.hpp"
+#include "util/Utility.hpp"
+
+#include <vector>
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+
+/* The BatchRenderer draws every enabled Renderer with as few draw calls as possible.
+ *
+ * Each frame, the chunks of every entity having a Transform and a Renderer are swept in parallel to
+ * compute the instance data, and every Renderer gets a 64 bits sort key made of its' shader id,
+ * material id, texture in video RAM and zIndex (from the most to the least significant bits).
+ * Renderers are sorted by that key (in parallel, see JobSystem::parallelSort()), so the
+ * ones sharing a shader, a material and a texture end up next to each other and form a bucket.
+ * Sprites packed in the same page of the TextureAtlas share their texture, the region of the page
+ * each one uses is an instance attribute.
+ * Each bucket is drawn with one instanced draw call of RawModel::quad, the transforms of the sprites
+ * being streamed in a single instance buffer shared by all the buckets.
+ * The zIndex is the depth of the sprites, so the depth test layers them whatever the order of their
+ * buckets: the camera must cover [-32768, 32767] in depth, or the sprites outside of it are clipped.
+ * Their transparent texels are discarded, there's no blending.
+ */
+
+/// <summary>
+/// Per instance data sent to the GPU for every sprite, read by spriteVertex.vert.
+/// </summary>
+struct SpriteInstance
+{
+	glm::vec4 basis;       //2x2 rotation and scale matrix, column major
+	glm::vec4 translation; //x, y, zIndex, unused
+	glm::vec4 uvRect;      //Region of the texture, see Texture::uvRect
+};
+
+/// <summary>
+/// A range of consecutive instances drawn with the same shader, material and texture.
+/// </summary>
+struct SpriteBatch
+{
+	Shader* shader;
+	Material* material;
+	Texture* texture;
+	uint start; //Index of the first instance
+	uint count; //Number of instances
+};
+
+/// <summary>
+/// A static class that draws all the Renderers, batched by shader, material and texture.
+/// </summary>
+class BatchRenderer
+{
+public:
+
+	/// <summary>
+	/// Creates the instance buffer and binds it to the quad. Must be called after Loader::init().
+	/// </summary>
+	static void init();
+
+	/// <summary>
+	/// Draws all the enabled Renderers, with the camera of the Frame block (see UniformBuffers::updateFrame()).
+	/// </summary>
+	static void render();
+
+	/// <summary>
+	/// Frees the instance buffer. Must be called before Loader::destroy().
+	/// </summary>
+	static void destroy();
+
+	/// <summary>
+	/// Packs the sort key of a Renderer. Ids and textureID are truncated to 16 bits,
+	/// the zIndex is rounded and clamped to [-32768, 32767].
+	/// </summary>
+	static uint64 sortKey(uint shaderID, uint materialID, uint textureID, float zIndex);
+
+	/// <summary>
+	/// Returns the batches drawn during the last call to render().
+	/// </summary>
+	static const std::vector<SpriteBatch>& lastBatches() { return batches; }
+
+private:
+
+	/// <summary>
+	/// A Renderer and its' sort key.
+	/// </summary>
+	struct SortItem
+	{
+		uint64 key;
+		uint instance;            //Index in unsorted
+		Material* material;       //Of the Renderer, or the default one
+		Texture* texture;         //Of the Renderer, or the default one
+	};
+
+	static const uint64 SKIPPED = ~(uint64)0;   //Key of disabled Renderers and of those without material or texture
+	static const uint INSTANCE_ATTRIBUTE = 2; //First attribute location used by SpriteInstance
+
+	static uint instanceBuffer;
+	static size_t instanceCapacity;            //Number of instances the GPU buffer can hold
+
+	static Query sprites;                      //Every entity with a Transform and a Renderer
+
+	static std::vector<SortItem> items;        //Kept between frames to avoid reallocations
+	static std::vector<SortItem> sortScratch;
+	static std::vector<SpriteInstance> unsorted; //Instances in the order of the chunks
+	static std::vector<SpriteInstance> instances;
+	static std::vector<SpriteBatch> batches;
+
+	/// <summary>
+	/// Makes the instance attributes point at the given instance in the instance buffer.
+	/// </summary>
+	static void pointInstanceAttributes(uint firstInstance);
+};
@@ -0,0 +1,649 @@
+#include "GLRenderDevice.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+#pragma region Conversions
+
+static GLenum toGL(BufferTarget target)
+{
+	switch (target)
+	{
+	case BufferTarget::ARRAY_BUFFER:         return GL_ARRAY_BUFFER;
+	case BufferTarget::ELEMENT_ARRAY_BUFFER: return GL_ELEMENT_ARRAY_BUFFER;
+	case BufferTarget::UNIFORM_BUFFER:       return GL_UNIFORM_BUFFER;
+	case BufferTarget::PIXEL_UNPACK_BUFFER:  return GL_PIXEL_UNPACK_BUFFER;
+	}
+	return GL_ARRAY_BUFFER;
+}
+
+static GLenum toGL(BufferUsage usage)
+{
+	switch (usage)
+	{
+	case BufferUsage::STATIC_DRAW:  return GL_STATIC_DRAW;
+	case BufferUsage::DYNAMIC_DRAW: return GL_DYNAMIC_DRAW;
+	case BufferUsage::STREAM_DRAW:  return GL_STREAM_DRAW;
+	}
+	return GL_STATIC_DRAW;
+}
+
+static GLenum toGL(AttribType type)
+{
+	switch (type)
+	{
+	case AttribType::FLOAT:         return GL_FLOAT;
+	case AttribType::INT:           return GL_INT;
+	case AttribType::UINT:          return GL_UNSIGNED_INT;
+	case AttribType::UNSIGNED_BYTE: return GL_UNSIGNED_BYTE;
+	}
+	return GL_FLOAT;
+}
+
+static GLenum toGL(PixelFormat format)
+{
+	switch (format)
+	{
+	case PixelFormat::RED:  return GL_RED;
+	case PixelFormat::RG:   return GL_RG;
+	case PixelFormat::RGB:  return GL_RGB;
+	case PixelFormat::RGBA: return GL_RGBA;
+	}
+	return GL_RGBA;
+}
+
+//From EXT_texture_compression_s3tc, supported by every desktop driver but not in core
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+
+static GLenum toGL(CompressedFormat format)
+{
+	switch (format)
+	{
+	case CompressedFormat::BC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	case CompressedFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+	return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+static GLenum toGL(ShaderType type)
+{
+	switch (type)
+	{
+	case ShaderType::VERTEX_SHADER:   return GL_VERTEX_SHADER;
+	case ShaderType::GEOMETRY_SHADER: return GL_GEOMETRY_SHADER;
+	case ShaderType::FRAGMENT_SHADER: return GL_FRAGMENT_SHADER;
+	}
+	return GL_VERTEX_SHADER;
+}
+
+//From ARB_gpu_shader_fp64, core since OpenGL 4.0
+#define GL_DOUBLE_VEC2 0x8FFC
+#define GL_DOUBLE_VEC3 0x8FFD
+#define GL_DOUBLE_VEC4 0x8FFE
+
+static VarType toVarType(GLenum type)
+{
+	switch (type)
+	{
+	case GL_BOOL:              return VarType::BOOL;
+	case GL_INT:               return VarType::INT;
+	case GL_UNSIGNED_INT:      return VarType::UINT;
+	case GL_FLOAT:             return VarType::FLOAT;
+	case GL_DOUBLE:            return VarType::DOUBLE;
+	case GL_BOOL_VEC2:         return VarType::BVEC2;
+	case GL_BOOL_VEC3:         return VarType::BVEC3;
+	case GL_BOOL_VEC4:         return VarType::BVEC4;
+	case GL_INT_VEC2:          return VarType::IVEC2;
+	case GL_INT_VEC3:          return VarType::IVEC3;
+	case GL_INT_VEC4:          return VarType::IVEC4;
+	case GL_UNSIGNED_INT_VEC2: return VarType::UVEC2;
+	case GL_UNSIGNED_INT_VEC3: return VarType::UVEC3;
+	case GL_UNSIGNED_INT_VEC4: return VarType::UVEC4;
+	case GL_FLOAT_VEC2:        return VarType::VEC2;
+	case GL_FLOAT_VEC3:        return VarType::VEC3;
+	case GL_FLOAT_VEC4:        return VarType::VEC4;
+	case GL_DOUBLE_VEC2:       return VarType::DVEC2;
+	case GL_DOUBLE_VEC3:       return VarType::DVEC3;
+	case GL_DOUBLE_VEC4:       return VarType::DVEC4;
+	case GL_FLOAT_MAT2:        return VarType::MAT2;
+	case GL_FLOAT_MAT3:        return VarType::MAT3;
+	case GL_FLOAT_MAT4:        return VarType::MAT4;
+	case GL_FLOAT_MAT2x3:      return VarType::MAT2x3;
+	case GL_FLOAT_MAT2x4:      return VarType::MAT2x4;
+	case GL_FLOAT_MAT3x2:      return VarType::MAT3x2;
+	case GL_FLOAT_MAT3x4:      return VarType::MAT3x4;
+	case GL_FLOAT_MAT4x2:      return VarType::MAT4x2;
+	case GL_FLOAT_MAT4x3:      return VarType::MAT4x3;
+	case GL_SAMPLER_2D:        return VarType::SAMPLER2D;
+	}
+	return VarType::OTHER;
+}
+
+#pragma endregion
+
+//From ARB_get_program_binary, core since OpenGL 4.1, so not in the 3.3 glad
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+//From KHR_parallel_shader_compile, ARB_parallel_shader_compile has the same values
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+static GetProgramBinaryProc getProgramBinaryGL = nullptr;
+static ProgramBinaryProc programBinaryGL = nullptr;
+static ProgramParameteriProc programParameteriGL = nullptr;
+
+/// <summary>
+/// Returns a string of the driver, "" if it doesn't give it.
+/// </summary>
+static std::string driverString(GLenum name)
+{
+	const GLubyte* value = glGetString(name);
+	return value != nullptr ? (const char*)value : "";
+}
+
+GLRenderDevice::GLRenderDevice(ProcLoader getProcAddress)
+{
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); //Only toggled by setBlending()
+	driver = driverString(GL_VENDOR) + " " + driverString(GL_RENDERER) + " " + driverString(GL_VERSION);
+
+	int major = 0, minor = 0, extensionCount = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	bool supported = major > 4 || (major == 4 && minor >= 1);
+	const char* parallelExtension = nullptr;
+	for (int i = 0; i < extensionCount; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension == nullptr)
+			continue;
+		supported |= strcmp(extension, "GL_ARB_get_program_binary") == 0;
+		if (strcmp(extension, "GL_KHR_parallel_shader_compile") == 0)
+			parallelExtension = "glMaxShaderCompilerThreadsKHR";
+		else if (strcmp(extension, "GL_ARB_parallel_shader_compile") == 0 && parallelExtension == nullptr)
+			parallelExtension = "glMaxShaderCompilerThreadsARB";
+	}
+	if (getProcAddress == nullptr)
+		return;
+
+	if (parallelExtension != nullptr)
+	{
+		MaxShaderCompilerThreadsProc maxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)getProcAddress(parallelExtension);
+		if (maxShaderCompilerThreads != nullptr)
+		{
+			maxShaderCompilerThreads(0xFFFFFFFF); //As many threads as the driver wants
+			parallelCompile = true;
+		}
+	}
+	if (!supported)
+		return;
+
+	getProgramBinaryGL = (GetProgramBinaryProc)getProcAddress("glGetProgramBinary");
+	programBinaryGL = (ProgramBinaryProc)getProcAddress("glProgramBinary");
+	programParameteriGL = (ProgramParameteriProc)getProcAddress("glProgramParameteri");
+	int formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	programBinaries = getProgramBinaryGL != nullptr && programBinaryGL != nullptr && programParameteriGL != nullptr
+		&& formatCount > 0; //Some drivers expose the functions but no format
+}
+
+#pragma region Buffers
+
+uint GLRenderDevice::createVertexArray()
+{
+	uint vao;
+	glGenVertexArrays(1, &vao);
+	return vao;
+}
+
+void GLRenderDevice::bindVertexArray(uint vao)
+{
+	if (!filterStateChange(state.bindVertexArray(vao)))
+		return;
+	glBindVertexArray(vao);
+}
+
+void GLRenderDevice::deleteVertexArrays(const std::vector<uint>& vaos)
+{
+	state.vertexArraysDeleted(vaos);
+	glDeleteVertexArrays((GLsizei)vaos.size(), vaos.data());
+}
+
+uint GLRenderDevice::createBuffer()
+{
+	uint buffer;
+	glGenBuffers(1, &buffer);
+	return buffer;
+}
+
+void GLRenderDevice::bindBuffer(BufferTarget target, uint buffer)
+{
+	if (!filterStateChange(state.bindBuffer(target, buffer)))
+		return;
+	glBindBuffer(toGL(target), buffer);
+}
+
+void GLRenderDevice::bindBufferBase(BufferTarget target, uint index, uint buffer)
+{
+	if (!filterStateChange(state.bindBufferBase(target, index, buffer)))
+		return;
+	glBindBufferBase(toGL(target), index, buffer);
+}
+
+void GLRenderDevice::bufferData(BufferTarget target, const void* data, size_t size, BufferUsage usage)
+{
+	if (data != nullptr)
+		countUpload(size);
+	glBufferData(toGL(target), (GLsizeiptr)size, data, toGL(usage));
+}
+
+void GLRenderDevice::bufferSubData(BufferTarget target, size_t offset, const void* data, size_t size)
+{
+	countUpload(size);
+	glBufferSubData(toGL(target), (GLintptr)offset, (GLsizeiptr)size, data);
+}
+
+void* GLRenderDevice::mapBuffer(BufferTarget target, size_t size)
+{
+	//Unsynchronized: the caller waited for a fence, the driver doesn't have to
+	return glMapBufferRange(toGL(target), 0, (GLsizeiptr)size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+bool GLRenderDevice::unmapBuffer(BufferTarget target)
+{
+	return glUnmapBuffer(toGL(target)) == GL_TRUE;
+}
+
+void GLRenderDevice::deleteBuffers(const std::vector<uint>& buffers)
+{
+	state.buffersDeleted(buffers);
+	glDeleteBuffers((GLsizei)buffers.size(), buffers.data());
+}
+
+void GLRenderDevice::vertexAttribute(uint index, uint components, AttribType type, uint stride, size_t offset, uint divisor)
+{
+	countStateChange();
+	if (type == AttribType::FLOAT)
+		glVertexAttribPointer(index, components, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+	else
+		glVertexAttribIPointer(index, components, toGL(type), stride, (void*)offset);
+	glEnableVertexAttribArray(index);
+	glVertexAttribDivisor(index, divisor);
+}
+
+#pragma endregion
+
+#pragma region Textures
+
+uint GLRenderDevice::createTexture()
+{
+	uint texture;
+	glGenTextures(1, &texture);
+	return texture;
+}
+
+void GLRenderDevice::activeTexture(uint unit)
+{
+	if (activeUnit == unit)
+		return;
+	activeUnit = unit;
+	glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLRenderDevice::bindTexture(uint unit, uint texture)
+{
+	if (!filterStateChange(state.bindTexture(unit, texture)))
+		return;
+	activeTexture(unit);
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLRenderDevice::textureImage2D(uint width, uint height, PixelFormat format, const uint8* data, bool mipmaps)
+{
+	countUpload((size_t)width * height * ((int)format + 1)); //PixelFormat is ordered by channel count
+
+	activeTexture(0); //The texture of unit 0, even if binding it was skipped after binding another unit
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); //Rows of RGB images are not 4 bytes aligned
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, toGL(format), width, height, 0, toGL(format), GL_UNSIGNED_BYTE, data);
+	if (mipmaps)
+		glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+void GLRenderDevice::textureSubImage2D(uint x, uint y, uint width, uint height, PixelFormat format, const uint8* data)
+{
+	countUpload((size_t)width * height * ((int)format + 1));
+
+	activeTexture(0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, toGL(format), GL_UNSIGNED_BYTE, data);
+}
+
+void GLRenderDevice::compressedTextureImage2D(uint level, uint levels, uint width, uint height, CompressedFormat format, const uint8* data, size_t size)
+{
+	countUpload(size);
+
+	activeTexture(0);
+	if (level == 0)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1); //Complete without the levels under 1x1
+	}
+	glCompressedTexImage2D(GL_TEXTURE_2D, level, toGL(format), width, height, 0, (GLsizei)size, data);
+}
+
+void GLRenderDevice::generateMipmaps()
+{
+	activeTexture(0);
+	glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+void GLRenderDevice::deleteTextures(const std::vector<uint>& textures)
+{
+	state.texturesDeleted(textures);
+	glDeleteTextures((GLsizei)textures.size(), textures.data());
+}
+
+#pragma endregion
+
+#pragma region Shaders
+
+uint GLRenderDevice::compileShader(ShaderType type, const char* source)
+{
+	uint shader = glCreateShader(toGL(type));
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	return shader;
+}
+
+bool GLRenderDevice::shaderCompiled(uint shader, std::string& infoLog)
+{
+	int success;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		char log[512];
+		glGetShaderInfoLog(shader, 512, NULL, log);
+		infoLog = log;
+	}
+	return success;
+}
+
+bool GLRenderDevice::shaderReady(uint shader)
+{
+	if (!parallelCompile) //The status queries wait, as for any other driver
+		return true;
+	int done = GL_TRUE;
+	glGetShaderiv(shader, GL_COMPLETION_STATUS_KHR, &done);
+	return done;
+}
+
+void GLRenderDevice::deleteShader(uint shader)
+{
+	glDeleteShader(shader);
+}
+
+uint GLRenderDevice::createProgram()
+{
+	return glCreateProgram();
+}
+
+void GLRenderDevice::attachShader(uint program, uint shader)
+{
+	glAttachShader(program, shader);
+}
+
+void GLRenderDevice::detachShader(uint program, uint shader)
+{
+	glDetachShader(program, shader);
+}
+
+void GLRenderDevice::bindAttribLocation(uint program, uint index, const char* name)
+{
+	glBindAttribLocation(program, index, name);
+}
+
+void GLRenderDevice::linkProgram(uint program)
+{
+	if (programBinaries)
+		programParameteriGL(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(program);
+	state.programLinked(program);
+}
+
+bool GLRenderDevice::programLinked(uint program, std::string& infoLog)
+{
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		char log[512];
+		glGetProgramInfoLog(program, 512, NULL, log);
+		infoLog = log;
+	}
+	return success;
+}
+
+bool GLRenderDevice::programReady(uint program)
+{
+	if (!parallelCompile)
+		return true;
+	int done = GL_TRUE;
+	glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+	return done;
+}
+
+bool GLRenderDevice::getProgramBinary(uint program, uint& format, std::vector<uint8>& binary)
+{
+	if (!programBinaries)
+		return false;
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return false;
+
+	binary.resize(length);
+	GLsizei written = 0;
+	GLenum binaryFormat = 0;
+	getProgramBinaryGL(program, length, &written, &binaryFormat, binary.data());
+	binary.resize(written);
+	format = binaryFormat;
+	return written > 0;
+}
+
+void GLRenderDevice::programBinary(uint program, uint format, const uint8* binary, size_t size)
+{
+	if (programBinaries) //Otherwise the program stays unlinked, like a rejected binary
+		programBinaryGL(program, format, binary, (GLsizei)size);
+	state.programLinked(program);
+}
+
+void GLRenderDevice::useProgram(uint program)
+{
+	if (!filterStateChange(state.useProgram(program)))
+		return;
+	glUseProgram(program);
+}
+
+void GLRenderDevice::deleteProgram(uint program)
+{
+	state.programDeleted(program);
+	glDeleteProgram(program);
+}
+
+/// <summary>
+/// Removes the "[0]" the drivers add to the names of the arrays.
+/// </summary>
+static std::string variableName(const char* name)
+{
+	size_t length = strlen(name);
+	if (length > 3 && strcmp(name + length - 3, "[0]") == 0)
+		length -= 3;
+	return std::string(name, length);
+}
+
+std::vector<ActiveVariable> GLRenderDevice::activeVariables(uint program, VariableKind kind)
+{
+	std::vector<ActiveVariable> variables;
+	int count = 0, maxLength = 0;
+	switch (kind)
+	{
+	case VariableKind::UNIFORM:
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		break;
+	case VariableKind::ATTRIBUTE:
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+		break;
+	case VariableKind::UNIFORM_BLOCK:
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+		break;
+	}
+
+	std::vector<char> name(std::max(maxLength, 1));
+	for (int i = 0; i < count; i++)
+	{
+		int size = 1;
+		GLenum type = 0;
+		name[0] = '\0';
+		if (kind == VariableKind::UNIFORM)
+		{
+			int block = -1;
+			uint index = i;
+			glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+			if (block >= 0) //Set through the buffer of its' block
+				continue;
+			glGetActiveUniform(program, i, (GLsizei)name.size(), nullptr, &size, &type, name.data());
+			variables.push_back({ variableName(name.data()), toVarType(type), (uint)size, glGetUniformLocation(program, name.data()) });
+		}
+		else if (kind == VariableKind::ATTRIBUTE)
+		{
+			glGetActiveAttrib(program, i, (GLsizei)name.size(), nullptr, &size, &type, name.data());
+			variables.push_back({ variableName(name.data()), toVarType(type), (uint)size, glGetAttribLocation(program, name.data()) });
+		}
+		else
+		{
+			glGetActiveUniformBlockName(program, i, (GLsizei)name.size(), nullptr, name.data());
+			glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+			variables.push_back({ name.data(), VarType::OTHER, (uint)size, i });
+		}
+	}
+	return variables;
+}
+
+void GLRenderDevice::uniformBlockBinding(uint program, uint index, uint binding)
+{
+	glUniformBlockBinding(program, index, binding);
+}
+
+void GLRenderDevice::uniformInts(int location, uint count, const int* value)
+{
+	if (!filterStateChange(state.uniform(location, value, count * sizeof(int))))
+		return;
+	glUniform1iv(location, count, value);
+}
+
+void GLRenderDevice::uniformFloats(int location, uint components, uint count, const float* value)
+{
+	if (!filterStateChange(state.uniform(location, value, components * count * sizeof(float))))
+		return;
+	switch (components)
+	{
+	case 1: glUniform1fv(location, count, value); break;
+	case 2: glUniform2fv(location, count, value); break;
+	case 3: glUniform3fv(location, count, value); break;
+	case 4: glUniform4fv(location, count, value); break;
+	}
+}
+
+void GLRenderDevice::uniformMatrix4(int location, const float* value)
+{
+	if (!filterStateChange(state.uniform(location, value, 16 * sizeof(float))))
+		return;
+	glUniformMatrix4fv(location, 1, GL_FALSE, value);
+}
+
+#pragma endregion
+
+#pragma region Sync
+
+uint GLRenderDevice::createFence()
+{
+	GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	for (uint i = 0; i < fences.size(); i++)
+		if (fences[i] == nullptr)
+		{
+			fences[i] = sync;
+			return i + 1;
+		}
+	fences.push_back(sync);
+	return (uint)fences.size();
+}
+
+bool GLRenderDevice::fenceSignaled(uint fence)
+{
+	//Flushing so the fence is sure to be reached, a timeout of 0 only polls
+	GLenum status = glClientWaitSync((GLsync)fences[fence - 1], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void GLRenderDevice::deleteFence(uint fence)
+{
+	glDeleteSync((GLsync)fences[fence - 1]);
+	fences[fence - 1] = nullptr;
+}
+
+#pragma endregion
+
+#pragma region Pipeline
+
+void GLRenderDevice::setBlending(bool enabled)
+{
+	if (!filterStateChange(state.setBlending(enabled)))
+		return;
+	if (enabled)
+		glEnable(GL_BLEND);
+	else
+		glDisable(GL_BLEND);
+}
+
+void GLRenderDevice::setDepthTest(bool enabled)
+{
+	if (!filterStateChange(state.setDepthTest(enabled)))
+		return;
+	if (enabled)
+		glEnable(GL_DEPTH_TEST);
+	else
+		glDisable(GL_DEPTH_TEST);
+}
+
+#pragma endregion
+
+#pragma region Draw
+
+void GLRenderDevice::drawElements(uint indexCount, uint instanceCount, IndexType indexType)
+{
+	countDraw();
+	GLenum type = indexType == IndexType::UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	if (instanceCount == 1)
+		glDrawElements(GL_TRIANGLES, indexCount, type, 0);
+	else
+		glDrawElementsInstanced(GL_TRIANGLES, indexCount, type, 0, instanceCount);
+}
+
+#pragma endregion
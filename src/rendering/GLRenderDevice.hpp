@@ -0,0 +1,93 @@
+#pragma once
+
+#include "RenderDevice.hpp"
+#include "RenderStateCache.hpp"
+
+/// <summary>
+/// The OpenGL backend, forwards every call to glad. Needs a current OpenGL 3.3+ context.
+/// </summary>
+/// <seealso cref="IRenderDevice" />
+class GLRenderDevice : public IRenderDevice
+{
+public:
+
+	typedef void* (*ProcLoader)(const char* name); //Like GLADloadproc
+
+	/// <summary>
+	/// Reads the identity of the driver, loads the functions missing from glad and lets the driver
+	/// compile the shaders in parallel.
+	/// </summary>
+	/// <param name="getProcAddress">Loads the functions of the context, nullptr to not use program binaries.</param>
+	GLRenderDevice(ProcLoader getProcAddress = nullptr);
+
+	const char* name() const override { return "OpenGL"; }
+
+	uint createVertexArray() override;
+	void bindVertexArray(uint vao) override;
+	void deleteVertexArrays(const std::vector<uint>& vaos) override;
+
+	uint createBuffer() override;
+	void bindBuffer(BufferTarget target, uint buffer) override;
+	void bindBufferBase(BufferTarget target, uint index, uint buffer) override;
+	void bufferData(BufferTarget target, const void* data, size_t size, BufferUsage usage) override;
+	void bufferSubData(BufferTarget target, size_t offset, const void* data, size_t size) override;
+	void* mapBuffer(BufferTarget target, size_t size) override;
+	bool unmapBuffer(BufferTarget target) override;
+	void deleteBuffers(const std::vector<uint>& buffers) override;
+	void vertexAttribute(uint index, uint components, AttribType type, uint stride, size_t offset, uint divisor = 0) override;
+
+	uint createTexture() override;
+	void bindTexture(uint unit, uint texture) override;
+	void textureImage2D(uint width, uint height, PixelFormat format, const uint8* data, bool mipmaps) override;
+	void textureSubImage2D(uint x, uint y, uint width, uint height, PixelFormat format, const uint8* data) override;
+	void compressedTextureImage2D(uint level, uint levels, uint width, uint height, CompressedFormat format, const uint8* data, size_t size) override;
+	void generateMipmaps() override;
+	void deleteTextures(const std::vector<uint>& textures) override;
+
+	uint compileShader(ShaderType type, const char* source) override;
+	bool shaderCompiled(uint shader, std::string& infoLog) override;
+	bool shaderReady(uint shader) override;
+	void deleteShader(uint shader) override;
+
+	uint createProgram() override;
+	void attachShader(uint program, uint shader) override;
+	void detachShader(uint program, uint shader) override;
+	void bindAttribLocation(uint program, uint index, const char* name) override;
+	void linkProgram(uint program) override;
+	bool programLinked(uint program, std::string& infoLog) override;
+	bool programReady(uint program) override;
+	std::string driverIdentity() override { return driver; }
+	bool getProgramBinary(uint program, uint& format, std::vector<uint8>& binary) override;
+	void programBinary(uint program, uint format, const uint8* binary, size_t size) override;
+	void useProgram(uint program) override;
+	void deleteProgram(uint program) override;
+	std::vector<ActiveVariable> activeVariables(uint program, VariableKind kind) override;
+	void uniformBlockBinding(uint program, uint index, uint binding) override;
+	void uniformInts(int location, uint count, const int* value) override;
+	void uniformFloats(int location, uint components, uint count, const float* value) override;
+	void uniformMatrix4(int location, const float* value) override;
+
+	uint createFence() override;
+	bool fenceSignaled(uint fence) override;
+	void deleteFence(uint fence) override;
+
+	void setBlending(bool enabled) override;
+	void setDepthTest(bool enabled) override;
+
+	void drawElements(uint indexCount, uint instanceCount = 1, IndexType indexType = IndexType::UINT32) override;
+
+private:
+
+	std::vector<void*> fences; //GLsync objects by handle - 1, null when free
+	std::string driver;
+	bool programBinaries = false; //Whether the driver gives program binaries
+	bool parallelCompile = false; //Whether the driver compiles and links on threads of its' own
+
+	RenderStateCache state;
+	uint activeUnit = RenderStateCache::UNKNOWN; //Texture unit of glActiveTexture
+
+	/// <summary>
+	/// Selects the texture unit the texture calls use, if it's not already.
+	/// </summary>
+	void activeTexture(uint unit);
+};
@@ -0,0 +1,251 @@
+#include "HotReloader.hpp"
+#include "Loader.hpp"
+#include "Shader.hpp"
+#include "ShaderCache.hpp"
+#include "TextureAtlas.hpp"
+#include "TextureStreamer.hpp"
+#include "UniformBuffers.hpp"
+#include "io/AssetBlob.hpp"
+#include "io/FileIO.hpp"
+#include "io/FileWatcher.hpp"
+#include "io/JSON.hpp"
+#include "jobs/JobSystem.hpp"
+
+#include <cstdio>
+
+/// <summary>
+/// The stages of a program being read by a job.
+/// </summary>
+struct ShaderReload
+{
+	uint program;                //Index in HotReloader::programs
+	std::string path;            //The file that changed
+	std::chrono::steady_clock::time_point changed;
+	std::string sources[3];
+	bool read[3] = {};
+	Counter reads;
+};
+
+/// <summary>
+/// A JSON file being read by a job.
+/// </summary>
+struct DataReload
+{
+	std::string path;
+	std::chrono::steady_clock::time_point changed;
+	void(*reader)(AssetTables&);
+	AssetTables tables;
+	Counter reads;
+};
+
+static const ShaderType STAGE_TYPES[3] = { ShaderType::VERTEX_SHADER, ShaderType::GEOMETRY_SHADER, ShaderType::FRAGMENT_SHADER };
+
+static const std::pair<const char*, void(*)(AssetTables&)> DATA_READERS[] =
+{
+	{ "res/data/textures.json", readTextures },
+	{ "res/data/materials.json", readMaterials },
+	{ "res/data/gameobjects.json", readGameObjects },
+	{ "res/data/shaders.json", readShaders },
+	{ "res/data/vertexshaders.json", readShaders },
+	{ "res/data/geometryshaders.json", readShaders },
+	{ "res/data/fragmentshaders.json", readShaders },
+	{ "res/data/terrain_generation/biomes.json", readBiomes }
+};
+
+FileWatcher* HotReloader::watcher = nullptr;
+TextureStreamer* HotReloader::streamer = nullptr;
+TextureAtlas* HotReloader::atlas = nullptr;
+std::vector<HotReloader::Program> HotReloader::programs;
+std::unordered_map<std::string, HotReloader::Clock::time_point> HotReloader::settling;
+std::vector<std::unique_ptr<ShaderReload>> HotReloader::shaderReloads;
+std::vector<std::unique_ptr<DataReload>> HotReloader::dataReloads;
+std::vector<HotReloader::TextureReload> HotReloader::textureReloads;
+
+void HotReloader::init(TextureStreamer* textureStreamer, TextureAtlas* textureAtlas)
+{
+	streamer = textureStreamer;
+	atlas = textureAtlas;
+	watcher = new FileWatcher({ "res/shaders", "res/textures", "res/data" });
+	if (!watcher->isWatching())
+	{
+		printf("Couldn't watch the files of res, hot reload is disabled\n");
+		delete watcher;
+		watcher = nullptr;
+		return;
+	}
+
+	auto previous = streamer->done;
+	streamer->done = [previous](uint texture)
+	{
+		if (previous)
+			previous(texture);
+		textureDone(texture);
+	};
+	printf("Watching res/shaders, res/textures and res/data for changes\n");
+}
+
+void HotReloader::addProgram(uint id, constring name, constring vertex, constring geometry, constring fragment)
+{
+	programs.push_back({ id, name, { vertex, geometry, fragment } });
+}
+
+void HotReloader::update()
+{
+	if (watcher == nullptr)
+		return;
+
+	for (FileChange& change : watcher->poll())
+		settling[change.path] = change.time;
+	for (auto it = settling.begin(); it != settling.end();)
+	{
+		if (elapsedMs(it->second) < SETTLE_MS)
+		{
+			it++;
+			continue;
+		}
+		reload(it->first, it->second);
+		it = settling.erase(it);
+	}
+
+	for (auto it = dataReloads.begin(); it != dataReloads.end();)
+	{
+		DataReload& reload = **it;
+		if (!reload.reads.done())
+		{
+			it++;
+			continue;
+		}
+		if (reload.reader == readBiomes)
+		{
+			Loader::createBiomes(reload.tables.view());
+			printf("Reloaded %s in %.1f ms\n", reload.path.c_str(), elapsedMs(reload.changed));
+		}
+		else
+			printf("Validated %s in %.1f ms, restart to apply its' records\n", reload.path.c_str(), elapsedMs(reload.changed));
+		it = dataReloads.erase(it);
+	}
+
+	//Compiling and linking can take a while, so at most one program per frame
+	if (!shaderReloads.empty() && shaderReloads.front()->reads.done())
+	{
+		relink(*shaderReloads.front());
+		shaderReloads.erase(shaderReloads.begin());
+	}
+}
+
+void HotReloader::reload(const std::string& path, Clock::time_point changed)
+{
+	const std::string SHADERS = "res/shaders/", TEXTURES = "res/textures/";
+
+	if (path.compare(0, SHADERS.size(), SHADERS) == 0)
+	{
+		std::string stage = path.substr(SHADERS.size());
+		for (uint p = 0; p < programs.size(); p++)
+		{
+			const Program& program = programs[p];
+			if (stage != program.stages[0] && stage != program.stages[1] && stage != program.stages[2])
+				continue;
+
+			shaderReloads.push_back(std::make_unique<ShaderReload>());
+			ShaderReload* reload = shaderReloads.back().get();
+			reload->program = p;
+			reload->path = path;
+			reload->changed = changed;
+			JobSystem::run([reload, program]()
+			{
+				for (uint s = 0; s < 3; s++)
+				{
+					if (program.stages[s].empty())
+						continue;
+					reload->read[s] = readFile(std::string("res/shaders/") + program.stages[s], reload->sources[s]);
+					reload->sources[s] = UniformBuffers::expand(reload->sources[s]); //As the ShaderBases do
+				}
+			}, &reload->reads);
+		}
+	}
+	else if (path.compare(0, TEXTURES.size(), TEXTURES) == 0)
+	{
+		for (uint texture : atlas->reload(path.substr(TEXTURES.size()), *streamer))
+			textureReloads.push_back({ texture, path, changed });
+	}
+	else
+	{
+		for (const auto& [file, reader] : DATA_READERS)
+		{
+			if (path != file)
+				continue;
+			dataReloads.push_back(std::make_unique<DataReload>());
+			DataReload* reload = dataReloads.back().get();
+			reload->path = path;
+			reload->changed = changed;
+			reload->reader = reader;
+			JobSystem::run([reload]()
+			{
+				reload->reader(reload->tables);
+				releaseJSONArena();
+			}, &reload->reads);
+		}
+	}
+}
+
+void HotReloader::relink(ShaderReload& reload)
+{
+	const Program& program = programs[reload.program];
+	uint stages[3] = {};
+	bool compiled = true;
+	for (uint s = 0; s < 3 && compiled; s++)
+	{
+		if (program.stages[s].empty())
+			continue;
+		stages[s] = reload.read[s] ? compileShader(program.stages[s], STAGE_TYPES[s], reload.sources[s]) : 0;
+		compiled = stages[s] != 0; //Error management done in compileShader()
+	}
+
+	uint programID = 0;
+	if (compiled)
+		programID = linkProgram(stages[0], stages[1], stages[2], program.stages[0], program.stages[1], program.stages[2]);
+	if (programID == 0)
+	{
+		for (uint stage : stages)
+			if (stage != 0)
+				Loader::device->deleteShader(stage);
+		printf("Kept the previous version of the shader %s\n", program.name.c_str());
+		return;
+	}
+
+	ShaderCache::save(ShaderCache::key(reload.sources[0], reload.sources[1], reload.sources[2]), programID);
+	if (Shader* shader = Shader::find(program.id))
+		shader->relink(programID, stages[0], stages[1], stages[2]); //Reflects the new program
+	printf("Reloaded %s in the shader %s in %.1f ms\n", reload.path.c_str(), program.name.c_str(), elapsedMs(reload.changed));
+}
+
+void HotReloader::textureDone(uint texture)
+{
+	for (auto it = textureReloads.begin(); it != textureReloads.end(); it++)
+		if (it->texture == texture)
+		{
+			printf("Reloaded %s in %.1f ms\n", it->path.c_str(), elapsedMs(it->changed));
+			textureReloads.erase(it);
+			return;
+		}
+}
+
+void HotReloader::destroy()
+{
+	delete watcher;
+	watcher = nullptr;
+	for (const auto& reload : shaderReloads)
+		JobSystem::wait(reload->reads);
+	for (const auto& reload : dataReloads)
+		JobSystem::wait(reload->reads);
+	shaderReloads.clear();
+	dataReloads.clear();
+	textureReloads.clear();
+	settling.clear();
+	programs.clear();
+}
+
+double HotReloader::elapsedMs(Clock::time_point changed)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - changed).count();
+}
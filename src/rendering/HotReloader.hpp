@@ -0,0 +1,117 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class FileWatcher;
+class TextureAtlas;
+class TextureStreamer;
+struct ShaderReload;
+struct DataReload;
+
+/* The HotReloader applies the changes of the files of res/shaders, res/textures and res/data while the game
+ * runs, instead of restarting it. A FileWatcher reports the written files, which are handled once they
+ * haven't changed for SETTLE_MS, as editors often write them in several steps:
+ *
+ * - A shader stage: its' file and the other stages of the programs using it are read by a job, then
+ *   compiled and linked on the render thread, one program per frame. The program replaces the previous
+ *   one in the same Shader, so the materials keep using it. If it doesn't compile, the previous one stays.
+ * - A texture: streamed again by the TextureStreamer in its' texture or its' region of an atlas page, the
+ *   handle doesn't change and the previous image is shown until the new one is uploaded.
+ * - A JSON file: read and validated by a job. The biomes replace the previous ones, the chunks being
+ *   generated finish with the previous ones (see TerrainGenerator.hpp). The other records
+ *   are referenced by index by the objects created from them, they need a restart.
+ *
+ * The time from the change to the new asset being used is printed for every asset. Files read from the
+ * AssetPack can't change, the HotReloader only starts when the loose files are used.
+ */
+
+/// <summary>
+/// A static class that reloads the assets whose files changed. See the top of HotReloader.hpp.
+/// </summary>
+class HotReloader
+{
+public:
+
+	static constexpr double SETTLE_MS = 50;
+
+	/// <summary>
+	/// Starts watching the files. On the render thread, after the loading.
+	/// </summary>
+	static void init(TextureStreamer* streamer, TextureAtlas* atlas);
+
+	/// <summary>
+	/// Registers the stages of a shader program, to relink it when one of them changes.
+	/// </summary>
+	/// <param name="geometry">"" if it has no geometry stage.</param>
+	static void addProgram(uint id, constring name, constring vertex, constring geometry, constring fragment);
+
+	/// <summary>
+	/// Starts the reloads of the files that settled and applies the ones ready. On the render thread,
+	/// once per frame.
+	/// </summary>
+	static void update();
+
+	/// <summary>
+	/// Stops watching the files, waiting for the reloads running.
+	/// </summary>
+	static void destroy();
+
+private:
+
+	typedef std::chrono::steady_clock Clock;
+
+	/// <summary>
+	/// The stages of a shader program, relative to res/shaders.
+	/// </summary>
+	struct Program
+	{
+		uint id;
+		std::string name;
+		std::string stages[3];  //Vertex, geometry and fragment, "" if absent
+	};
+
+	/// <summary>
+	/// A texture streaming again, and when its' file changed.
+	/// </summary>
+	struct TextureReload
+	{
+		uint texture;
+		std::string path;
+		Clock::time_point changed;
+	};
+
+	static FileWatcher* watcher;
+	static TextureStreamer* streamer;
+	static TextureAtlas* atlas;
+	static std::vector<Program> programs;
+	static std::unordered_map<std::string, Clock::time_point> settling; //Last change of the files not handled yet
+	static std::vector<std::unique_ptr<ShaderReload>> shaderReloads;
+	static std::vector<std::unique_ptr<DataReload>> dataReloads;
+	static std::vector<TextureReload> textureReloads;
+
+	/// <summary>
+	/// Starts the reload of a file.
+	/// </summary>
+	static void reload(const std::string& path, Clock::time_point changed);
+
+	/// <summary>
+	/// Compiles and links a program whose stages were read, then replaces the previous one.
+	/// </summary>
+	static void relink(ShaderReload& reload);
+
+	/// <summary>
+	/// Called when the TextureStreamer is done with a texture, prints the reloads it ends.
+	/// </summary>
+	static void textureDone(uint texture);
+
+	/// <summary>
+	/// Returns the milliseconds elapsed since a change.
+	/// </summary>
+	static double elapsedMs(Clock::time_point changed);
+};
@@ -2,106 +2,475 @@
 #include "io/Error.hpp"
 #include "io/FileIO.hpp"
 #include "io/JSON.hpp"
+#include "io/AssetBlob.hpp"
+#include "io/AssetPack.hpp"
+#include "io/ObjLoader.hpp"
+#include "jobs/TaskGraph.hpp"
+#include "rendering/HotReloader.hpp"
+#include "rendering/TextureAtlas.hpp"
+#include "rendering/TextureStreamer.hpp"
+#include "rendering/Shader.hpp"
+#include "rendering/UniformBuffers.hpp"
+#include "terrain/TerrainGenerator.hpp"
 //#include "IO/WREN.hpp"
 
-#include <glad.h>
+#include <fstream>
+
+IRenderDevice* Loader::device = nullptr;
+bool Loader::readJSON = false;
+bool Loader::hotReload = false;
+TextureStreamer* Loader::textureStreamer = nullptr;
+TextureAtlas* Loader::atlas = nullptr;
 
 std::vector<unsigned int> Loader::vaos;
 std::vector<unsigned int> Loader::vbos;
 std::vector<unsigned int> Loader::textures;
 
-void Loader::init() //SAFE Add program exit on fatal errors
+void Loader::init(IRenderDevice* renderDevice) //SAFE Add program exit on fatal errors
 {
-	/* Every function here are reading a JSON file that specifies how to build the objects
-	* or interpret a file. Functions from Shader.h, FileIO.h, Loader.h and Wren.h are called
-	* from the JSON.h functions.
+	device = renderDevice;
+	printf("Render device: %s\n", device->name());
+	AssetPack::open(readJSON || hotReload);  //Every file is read from it from now on, compared with the loose files only while iterating on them
+
+	/* Loading runs as a TaskGraph, in three steps as each one decides the tasks of the next:
+	* 1. The errors are loaded, the cooked assets are checked and the quad is uploaded.
+	* 2. The records come from the cooked assets when they are up to date, or from all the JSON files
+	*    read in parallel otherwise.
+	* 3. The objects are created from the records: the workers read the shaders, the main thread loads the
+	*    programs from the ShaderCache or compiles and links them. The materials wait for the shaders they
+	*    use. A worker packs the textures in the pages of the TextureAtlas, then they're only requested, the
+	*    TextureStreamer keeps loading them in the background once the game runs (see update()).
+	* Functions from Shader.h, FileIO.h, Loader.h and Wren.h are called from the tasks.
 	*/
 
-	ErrorManager::init();            //Loads all the errors
-	readTextures();					 //Loads all the textures
-	RawModel::generateQuad();		 //Loads all the raw models
-	readMaterials();                 //Loads all the materials
+	TaskGraph graph;
+	AssetBlob blob;
+	AssetTables tables;
+	AssetView assets;
+	bool cooked = false;
+
+	uint errors = graph.add("errors", "errors.json", []()
+	{
+		ErrorManager::init();        //Loads all the errors
+		releaseJSONArena();
+	});
+	uint check = graph.add("records", AssetBlob::PATH, [&]() { cooked = openCookedAssets(blob); });
+	graph.add("models", "quad", []() { RawModel::generateQuad(); }, TaskThread::MAIN); //Loads all the raw models
+	graph.add("uniforms", "Frame", []() { UniformBuffers::init(); }, TaskThread::MAIN);
+	graph.run();
+
+	uint records = graph.add("records", "", [&]()
+	{
+		assets = cooked ? blob.view() : tables.view();
+		printf("Loading the %s\n", cooked ? "cooked assets" : "JSON files");
+	});
+	graph.depend(records, errors);
+	graph.depend(records, check);
+	if (!cooked)
+		addJSONTasks(graph, tables, errors, records);
+	graph.run();
+
+	uint layout = graph.add("textures", "layout", [&]()
+	{
+		atlas = new TextureAtlas(device);
+		for (const TextureRecord& record : assets.records<TextureRecord>())
+			atlas->add(record.id, assets.string(record.name), assets.string(record.path));
+		atlas->layout();
+	});
+	graph.depend(layout, records);
+	uint requests = graph.add("textures", "requests", [&]()    //Loads all the textures
+	{
+		textureStreamer = new TextureStreamer(device);
+		atlas->request(*textureStreamer);
+	}, TaskThread::MAIN);
+	graph.depend(requests, layout);
+	uint shaders = addShaderTasks(graph, assets, records);    //Loads all the shaders
+	uint materials = graph.add("materials", "materials", [&]() { createMaterials(assets); }, TaskThread::MAIN);
+	graph.depend(materials, shaders);
 	//Load components
-	readGameObjects();				 //Loads all the Gameobjects
-	readShaders();					 //Loads all the shaders
+	uint gameObjects = graph.add("gameobjects", "gameobjects", [&]() { createGameObjects(assets); });
+	graph.depend(gameObjects, records);
+	uint biomes = graph.add("biomes", "biomes", [&]() { createBiomes(assets); });
+	graph.depend(biomes, records);
+	graph.run();
+
+	graph.printReport("Loading");
+	if (hotReload && !AssetPack::isOpen())
+		HotReloader::init(textureStreamer, atlas);
 	//WrenManager::init();           <//Loads all the wren scripts
 
 	printf("Loading completed\n"); //TODO Mettre en vert
 }
 
+int Loader::cook()
+{
+	ErrorManager::init();
+
+	//Taken first, so files edited while cooking make the blob stale
+	uint64 sourceTime = AssetBlob::newestSource();
+	AssetTables tables;
+	readAssets(tables);
+	releaseJSONArena();
+
+	size_t size = tables.save(AssetBlob::PATH, sourceTime);
+	ErrorManager::destroy();
+	if (size == 0)
+	{
+		printf("Couldn't write %s\n", AssetBlob::PATH);
+		return 1;
+	}
+
+	printf("Cooked %u textures, %u materials, %u GameObjects, %u shaders and %u biomes in %s (%zu bytes)\n",
+		tables.count<TextureRecord>(), tables.count<MaterialRecord>(), tables.count<GameObjectRecord>(),
+		tables.count<ShaderRecord>(), tables.count<BiomeRecord>(), AssetBlob::PATH, size);
+	return 0;
+}
+
+void Loader::update()
+{
+	HotReloader::update();
+	bool loading = textureStreamer->pendingCount() > 0;
+	textureStreamer->update();
+	if (loading && textureStreamer->pendingCount() == 0)
+	{
+		textureStreamer->printStats();
+		atlas->printStats();
+	}
+}
+
 void Loader::destroy() //TODO Add model, textures, rawmodels, material and shader destroy
 {
-	glDeleteVertexArrays(vaos.size(), vaos.data());
-	glDeleteBuffers(vbos.size(), vbos.data());
-	glDeleteTextures(textures.size(), textures.data());
+	HotReloader::destroy();
+	UniformBuffers::destroy();
+	delete textureStreamer;
+	textureStreamer = nullptr;
+	delete atlas;
+	atlas = nullptr;
+
+	device->deleteVertexArrays(vaos);
+	device->deleteBuffers(vbos);
+	device->deleteTextures(textures);
 
 	vaos.clear();
 	vbos.clear();
 	textures.clear();
 
 	ErrorManager::destroy();
+	AssetPack::close();
+}
+
+#pragma region Assets
+
+bool Loader::openCookedAssets(AssetBlob& blob)
+{
+	if (readJSON || !blob.open(AssetBlob::PATH))
+		return false;
+
+	if (blob.sourceTime() < AssetBlob::newestSource())
+	{
+		printf("%s is older than the JSON files, run --cook to update it\n", AssetBlob::PATH);
+		return false;
+	}
+	return true;
+}
+
+void Loader::addJSONTasks(TaskGraph& graph, AssetTables& tables, uint errors, uint records)
+{
+	//Every reader fills its' own tables, the arena of the worker is freed as everything was copied out of it
+	const std::pair<const char*, void(*)(AssetTables&)> readers[] =
+	{
+		{ "textures.json", readTextures },
+		{ "materials.json", readMaterials },
+		{ "gameobjects.json", readGameObjects },
+		{ "shaders.json", readShaders },
+		{ "biomes.json", readBiomes }
+	};
+
+	for (const auto& [file, reader] : readers)
+	{
+		uint task = graph.add("records", file, [&tables, reader]()
+		{
+			reader(tables);
+			releaseJSONArena();
+		});
+		graph.depend(task, errors);
+		graph.depend(records, task);
+	}
+}
+
+/// <summary>
+/// The source of a shader stage, between its' reading and the creation of the stage.
+/// </summary>
+struct ShaderSource
+{
+	std::string code;
+	bool read = false;
+};
+
+/// <summary>
+/// Adds the tasks reading the shaders of a stage and creating them, in the order of the records as the
+/// shader programs refer to the stages by index. They're compiled by the links, only if needed.
+/// </summary>
+/// <typeparam name="Stage">The class of the stage, its' objects add themselves to its' static list.</typeparam>
+/// <typeparam name="Record">The record of the stage.</typeparam>
+/// <param name="created">The task waiting for all the stages.</param>
+template<typename Stage, typename Record>
+static void addStageTasks(TaskGraph& graph, const AssetView& assets, uint records, uint created)
+{
+	uint previous = records;
+	for (const Record& record : assets.records<Record>())
+	{
+		ShaderSource* source = new ShaderSource(); //Deleted by the creation
+		const Record* r = &record;
+
+		uint read = graph.add("shaders", std::string("read ") + assets.string(r->path), [&assets, r, source]()
+		{
+			source->read = readFile(std::string("res/shaders/") + assets.string(r->path), source->code);
+		});
+		graph.depend(read, records);
+
+		uint create = graph.add("shaders", std::string("create ") + assets.string(r->name), [&assets, r, source]()
+		{
+			if (source->read) //Error management done in readFile()
+				new Stage(r->id, assets.string(r->name), assets.string(r->path), std::move(source->code));
+			delete source;
+		});
+		graph.depend(create, read);
+		graph.depend(create, previous);
+		previous = create;
+	}
+	graph.depend(created, previous);
 }
 
+/// <summary>
+/// The shader programs submitted to the driver and not checked yet.
+/// </summary>
+struct PendingShaders
+{
+	std::vector<PendingShader> programs;   //In the order of the records
+	std::chrono::steady_clock::time_point start;
+};
+
+uint Loader::addShaderTasks(TaskGraph& graph, const AssetView& assets, uint records)
+{
+	//First things first, we read all the stages
+	uint created = graph.add("shaders", "", []()
+	{
+		printf("Read %d vertex shaders, %d geometry shaders, %d fragment shaders\n",
+			(int)VertexShader::vertexShaders.size(),
+			(int)GeometryShader::geometryShaders.size(),
+			(int)FragmentShader::fragmentShaders.size());
+	});
+	addStageTasks<VertexShader, VertexShaderRecord>(graph, assets, records, created);
+	addStageTasks<GeometryShader, GeometryShaderRecord>(graph, assets, records, created);
+	addStageTasks<FragmentShader, FragmentShaderRecord>(graph, assets, records, created);
+
+	/* Then we link them together. Every program is submitted before the first one is checked, so the
+	 * driver compiles and links them all at once instead of waiting for each one in turn. The programs
+	 * come from the ShaderCache when they're in it, the stages they need are compiled otherwise.
+	 * They're checked in order, the materials find their program by its' id once they're all done.
+	 */
+	PendingShaders* pending = new PendingShaders(); //Deleted once the stages are destroyed
+	pending->programs.resize(assets.records<ShaderRecord>().size());
+	uint previous = graph.add("shaders", "submit", [pending]() { pending->start = std::chrono::steady_clock::now(); }, TaskThread::MAIN);
+	graph.depend(previous, created);
+	for (uint p = 0; p < pending->programs.size(); p++)
+	{
+		const ShaderRecord* r = &assets.records<ShaderRecord>()[p];
+		PendingShader* shader = &pending->programs[p];
+		uint submit = graph.add("shaders", std::string("submit ") + assets.string(r->name), [&assets, r, shader]()
+		{
+			//TODO Display message saying that one or two are missing
+			if (r->vertex < 0 || r->vertex >= (int)VertexShader::vertexShaders.size()
+				|| r->fragment < 0 || r->fragment >= (int)FragmentShader::fragmentShaders.size()
+				|| r->geometry >= (int)GeometryShader::geometryShaders.size())
+				return; //We skip the shader if a stage is missing
+
+			shader->id = r->id;
+			shader->name = assets.string(r->name);
+			shader->vertexShader = VertexShader::vertexShaders[r->vertex];
+			shader->geometryShader = r->geometry >= 0 ? GeometryShader::geometryShaders[r->geometry] : nullptr;
+			shader->fragmentShader = FragmentShader::fragmentShaders[r->fragment];
+			submitShaders(*shader);
+		}, TaskThread::MAIN);
+		graph.depend(submit, previous);
+		previous = submit;
+	}
+
+	for (uint p = 0; p < pending->programs.size(); p++)
+	{
+		const ShaderRecord* r = &assets.records<ShaderRecord>()[p];
+		PendingShader* shader = &pending->programs[p];
+		uint check = graph.add("shaders", std::string("check ") + assets.string(r->name), [&assets, r, shader]()
+		{
+			if (shader->programID == 0 || finishShaders(*shader) == 0)
+				return; //Error managed in finishShaders()
+
+			HotReloader::addProgram(r->id, assets.string(r->name),
+				assets.string(assets.records<VertexShaderRecord>()[r->vertex].path),
+				r->geometry >= 0 ? assets.string(assets.records<GeometryShaderRecord>()[r->geometry].path) : "",
+				assets.string(assets.records<FragmentShaderRecord>()[r->fragment].path));
+		}, TaskThread::MAIN);
+		graph.depend(check, previous);
+		previous = check;
+	}
+
+	uint shaders = graph.add("shaders", "destroy stages", [pending]()
+	{
+		//Destroying the temporary sub Shaders
+		VertexShader::destroy();
+		GeometryShader::destroy();
+		FragmentShader::destroy();
+
+		printf("Loaded %d shaders in %.2f ms\n",
+			(int)Shader::shaders.size(),
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pending->start).count());
+		delete pending;
+	}, TaskThread::MAIN);
+	graph.depend(shaders, previous);
+	return shaders;
+}
+
+void Loader::createMaterials(const AssetView& assets)
+{
+	for (const MaterialRecord& record : assets.records<MaterialRecord>())
+	{
+		Shader* shader = Shader::find(record.shader);
+		if (shader == nullptr)
+			continue; //Its' shader didn't load, error management done in finishShaders()
+
+		MaterialUniforms uniforms = { record.shineDamper, record.reflectivity };
+		uint buffer = UniformBuffers::createMaterialBuffer(uniforms);
+		vbos.push_back(buffer); //Deleted with the other buffers
+		new Material(record.id, assets.string(record.name), *shader, uniforms, buffer);
+	}
+
+	printf("Loaded %d materials\n", (int)Material::materials.size());
+}
+
+void Loader::createGameObjects(const AssetView& assets)
+{
+	for (const GameObjectRecord& record : assets.records<GameObjectRecord>())
+	{
+		Transform transform;
+		transform.position.x = record.x;
+		transform.position.y = record.y;
+		transform.zIndex = record.zIndex;
+		transform.rotation = record.rotation;
+		transform.scale = record.scale;
+
+		new GameObject(record.id, assets.string(record.name), transform); //Adds itself to the static list of GameObjects
+	}
+
+	printf("Loaded %d GameObjects\n", (int)GameObject::gameobjects.size());
+}
+
+void Loader::createBiomes(const AssetView& assets)
+{
+	std::vector<Biome> biomes; //Built aside, chunks may be generated with the previous ones
+	for (const BiomeRecord& record : assets.records<BiomeRecord>())
+	{
+		Biome biome;
+		biome.id = record.id;
+		biome.name = assets.string(record.name);
+		biome.minTemperature = record.minTemperature;
+		biome.maxTemperature = record.maxTemperature;
+		biome.minPrecipitation = record.minPrecipitation;
+		biome.maxPrecipitation = record.maxPrecipitation;
+		biome.height = record.height;
+		biome.octaves = record.octaves;
+		biome.frequency = record.frequency;
+		biome.amplitude = record.amplitude;
+		biome.lacunarity = record.lacunarity;
+		biome.persistence = record.persistence;
+		biome.surface = (BlockID)record.surface;
+		biome.subsurface = (BlockID)record.subsurface;
+		biome.subsurfaceDepth = record.subsurfaceDepth;
+		biome.stone = (BlockID)record.stone;
+		biomes.push_back(biome);
+	}
+
+	printf("Loaded %d biomes\n", (int)biomes.size());
+	Biome::replace(std::move(biomes));
+}
+
+#pragma endregion
+
 #pragma region VAO STUFF
-RawModel* Loader::loadToVao(uint id, constring name, float* positions, unsigned int* indices, float* textureCoords, unsigned int vertexCount)
+RawModel* Loader::loadToVao(uint id, constring name, float* positions, uint dimensions, uint vertexCount, uint* indices, uint indexCount, float* textureCoords)
+{
+	unsigned int vaoID = createVAO();
+	device->bindVertexArray(vaoID);
+	unsigned int iboID = bindIndiceBuffer(indices, indexCount);
+	storeDataInVertexAttribute(0, dimensions, positions, vertexCount);
+	storeDataInVertexAttribute(1, 2, textureCoords, vertexCount);
+	//Be careful, there's no unbinding of the vbos and the vao
+	return new RawModel(id, name, vaoID, iboID, indexCount);
+}
+
+RawModel* Loader::loadToVao(uint id, constring name, const ObjMesh& mesh)
 {
 	unsigned int vaoID = createVAO();
-	glBindVertexArray(vaoID);
-	unsigned int iboID = bindIndiceBuffer(indices);
-	storeDataInVertexAttribute(0, positions);
-	storeDataInVertexAttribute(1, textureCoords);
+	device->bindVertexArray(vaoID);
+
+	unsigned int iboID = createVBO();
+	device->bindBuffer(BufferTarget::ELEMENT_ARRAY_BUFFER, iboID);
+	device->bufferData(BufferTarget::ELEMENT_ARRAY_BUFFER, mesh.indexData(), mesh.indexSize(), BufferUsage::STATIC_DRAW);
+
+	unsigned int vboID = createVBO();
+	device->bindBuffer(BufferTarget::ARRAY_BUFFER, vboID);
+	device->bufferData(BufferTarget::ARRAY_BUFFER, mesh.vertices.data(), mesh.vertices.size() * sizeof(ObjVertex), BufferUsage::STATIC_DRAW);
+	device->vertexAttribute(0, 3, AttribType::FLOAT, sizeof(ObjVertex), offsetof(ObjVertex, position));
+	device->vertexAttribute(1, 2, AttribType::FLOAT, sizeof(ObjVertex), offsetof(ObjVertex, textureCoords));
+	device->vertexAttribute(2, 3, AttribType::FLOAT, sizeof(ObjVertex), offsetof(ObjVertex, normal));
 	//Be careful, there's no unbinding of the vbos and the vao
-	return new RawModel(id, name, vaoID, iboID, vertexCount);
+	return new RawModel(id, name, vaoID, iboID, mesh.indexCount(), mesh.indexType());
 }
 
 unsigned int Loader::createVAO()
 {
-	unsigned int vaoID;
-	glGenVertexArrays(1, &vaoID);
+	unsigned int vaoID = device->createVertexArray();
 	vaos.push_back(vaoID);
 	return vaoID;
 }
 
 unsigned int Loader::createVBO()
 {
-	unsigned int vboID;
-	glGenBuffers(1, &vboID);
+	unsigned int vboID = device->createBuffer();
 	vbos.push_back(vboID);
 	return vboID;
 }
 
-unsigned int Loader::bindIndiceBuffer(unsigned int* indices)
+unsigned int Loader::bindIndiceBuffer(uint* indices, uint count)
 {
 	unsigned int iboID = Loader::createVBO();
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	device->bindBuffer(BufferTarget::ELEMENT_ARRAY_BUFFER, iboID);
+	device->bufferData(BufferTarget::ELEMENT_ARRAY_BUFFER, indices, count * sizeof(uint), BufferUsage::STATIC_DRAW);
 	return iboID;
 }
 
-void Loader::storeDataInVertexAttribute(int attribNumber, float* data)
+void Loader::storeDataInVertexAttribute(int attribNumber, uint components, float* data, uint vertexCount)
 {
 	unsigned int vboID = Loader::createVBO();
-	glBindBuffer(GL_ARRAY_BUFFER, vboID);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
-	glVertexAttribPointer(attribNumber, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	device->bindBuffer(BufferTarget::ARRAY_BUFFER, vboID);
+	device->bufferData(BufferTarget::ARRAY_BUFFER, data, vertexCount * components * sizeof(float), BufferUsage::STATIC_DRAW);
+	device->vertexAttribute(attribNumber, components, AttribType::FLOAT, components * sizeof(float), 0);
 }
 
-void Loader::storeDataInVertexAttribute(int attribNumber, uint8* data)
+void Loader::storeDataInVertexAttribute(int attribNumber, uint components, uint8* data, uint vertexCount)
 {
 	unsigned int vboID = Loader::createVBO();
-	glBindBuffer(GL_ARRAY_BUFFER, vboID);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
-	glVertexAttribIPointer(attribNumber, 3, GL_UNSIGNED_BYTE, sizeof(uint8), (void*)0);
+	device->bindBuffer(BufferTarget::ARRAY_BUFFER, vboID);
+	device->bufferData(BufferTarget::ARRAY_BUFFER, data, vertexCount * components * sizeof(uint8), BufferUsage::STATIC_DRAW);
+	device->vertexAttribute(attribNumber, components, AttribType::UNSIGNED_BYTE, components * sizeof(uint8), 0);
 }
 
-Texture* Loader::loadTexture(uint id, constring name, unsigned char* data, int width, int height)
+Texture* Loader::loadTexture(uint id, constring name, unsigned char* data, int width, int height, int channels)
 {
-	unsigned int texture;
-	glGenTextures(1,&texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+	unsigned int texture = device->createTexture();
+	textures.push_back(texture);
+	device->bindTexture(0, texture);
+	device->textureImage2D(width, height, pixelFormatOf(channels), data, true);
 	return new Texture(id, name, texture);
 }
 
@@ -1,17 +1,29 @@
 #pragma once
 
-#include "Rendering/Model.hpp"
+#include "rendering/Model.hpp"
+#include "rendering/RenderDevice.hpp"
 #include "util/Utility.hpp"
 #include <string>
 #include <vector>
 #include <array>
 
+class AssetBlob;
+class AssetTables;
+class AssetView;
+class TaskGraph;
+class TextureStreamer;
+class TextureAtlas;
+struct ObjMesh;
+
 /// <summary>
-/// A static class that manage the creation of vbos, textures and link them to vaos
+/// A static class that manage the creation of vbos, textures and link them to vaos.
+/// Everything is created through the RenderDevice given at initialisation.
 /// </summary>
 class Loader
 {
 private:
+	friend class HotReloader;
+
 	static std::vector<unsigned int> vaos;
 	static std::vector<unsigned int> vbos;
 	static std::vector<unsigned int> textures;
@@ -32,29 +44,89 @@ private:
 	/// Binds the indices to the current binded vao.
 	/// </summary>
 	/// <param name="indices">The indices.</param>
+	/// <param name="count">The number of indices.</param>
 	/// <returns>The buffers' ID</returns>
-	static unsigned int bindIndiceBuffer(unsigned int* indices);
+	static unsigned int bindIndiceBuffer(uint* indices, uint count);
 	
 	/// <summary>
 	/// Stores the data in a vertex attribute binded to the current vao.
 	/// </summary>
 	/// <param name="attribNumber">The attribute number.</param>
+	/// <param name="components">The number of components per vertex.</param>
 	/// <param name="data">The data.</param>
-	static void storeDataInVertexAttribute(int attribNumber, float* data);
+	/// <param name="vertexCount">The number of vertices.</param>
+	static void storeDataInVertexAttribute(int attribNumber, uint components, float* data, uint vertexCount);
 
 	/// <summary>
 	/// Stores the data in a vertex attribute binded to the current vao.
 	/// </summary>
 	/// <param name="attribNumber">The attribute number.</param>
+	/// <param name="components">The number of components per vertex.</param>
 	/// <param name="data">The data.</param>
-	static void storeDataInVertexAttribute(int attribNumber, uint8* data);
+	/// <param name="vertexCount">The number of vertices.</param>
+	static void storeDataInVertexAttribute(int attribNumber, uint components, uint8* data, uint vertexCount);
+
+	/// <summary>
+	/// Opens the cooked assets, unless --json was given or they are missing or older than the JSON files.
+	/// </summary>
+	/// <returns>Whether the records come from the cooked assets.</returns>
+	static bool openCookedAssets(AssetBlob& blob);
+
+	/// <summary>
+	/// Adds the tasks reading every JSON file in the tables.
+	/// </summary>
+	/// <param name="errors">The task loading the errors, the readers report their errors.</param>
+	/// <param name="records">The task waiting for all the records.</param>
+	static void addJSONTasks(TaskGraph& graph, AssetTables& tables, uint errors, uint records);
+
+	/// <summary>
+	/// Adds the tasks reading the shader stages of the records, compiling them and linking them in the
+	/// shader programs of the records on the main thread.
+	/// </summary>
+	/// <param name="records">The task after which the records are available.</param>
+	/// <returns>The task waiting for all the shader programs.</returns>
+	static uint addShaderTasks(TaskGraph& graph, const AssetView& assets, uint records);
+
+	/// <summary>
+	/// Creates the materials of the records and their uniform buffers, on the main thread.
+	/// </summary>
+	static void createMaterials(const AssetView& assets);
+
+	/// <summary>
+	/// Creates the GameObjects of the records.
+	/// </summary>
+	static void createGameObjects(const AssetView& assets);
+
+	/// <summary>
+	/// Creates the biomes of the records, replacing the previous ones.
+	/// </summary>
+	static void createBiomes(const AssetView& assets);
 	
 public:
 
+	static IRenderDevice* device; //The backend every graphic call goes through
+	static bool readJSON;         //Whether to read the JSON files even if the cooked assets are up to date
+	static bool hotReload;        //Whether to reload the assets whose files change, see HotReloader.hpp
+	static TextureStreamer* textureStreamer; //Loads the textures while the game runs
+	static TextureAtlas* atlas;              //The pages the sprites are packed in
+
 	/// <summary>
 	/// Initialise the loading of the game
 	/// </summary>
-	static void init();	//OPTI  Can be optimized by passing more strings by reference instead of copy
+	/// <param name="renderDevice">The backend used to create every graphic object.</param>
+	static void init(IRenderDevice* renderDevice);	//OPTI  Can be optimized by passing more strings by reference instead of copy
+
+	/// <summary>
+	/// Uploads the textures loaded since the last frame, within the budget of the TextureStreamer.
+	/// Call it once per frame.
+	/// </summary>
+	static void update();
+
+	/// <summary>
+	/// Validates the JSON files and writes their records in the cooked assets (see AssetBlob.hpp).
+	/// </summary>
+	/// <returns>The exit code of the program.</returns>
+	static int cook();
 
 	/// <summary>
 	/// Unload all of the vaos
@@ -65,12 +137,19 @@ public:
 	/// Loads the given data to a vao.
 	/// </summary>
 	/// <param name="positions">The positions.</param>
+	/// <param name="dimensions">The number of components of a position, 2 or 3.</param>
+	/// <param name="vertexCount">The vertex count.</param>
 	/// <param name="indices">The indices.</param>
+	/// <param name="indexCount">The index count.</param>
 	/// <param name="textureCoords">The texture coords.</param>
-	/// <param name="normals">The normals ID.</param>
-	/// <param name="vertexCount">The vertex count.</param>
 	/// <returns>A reference to a RawModel representing the data</returns>
-	static RawModel* loadToVao(uint id, constring name, float* positions, uint* indices, float* textureCoords, uint vertexCount);	
+	static RawModel* loadToVao(uint id, constring name, float* positions, uint dimensions, uint vertexCount, uint* indices, uint indexCount, float* textureCoords);	
+
+	/// <summary>
+	/// Loads a parsed model to a vao, its' vertices interleaved in a single vbo.
+	/// </summary>
+	/// <returns>A reference to a RawModel representing the data</returns>
+	static RawModel* loadToVao(uint id, constring name, const ObjMesh& mesh);
 	
 	/// <summary>
 	/// Loads the given data to a Texture.
@@ -78,8 +157,9 @@ public:
 	/// <param name="data">The data.</param>
 	/// <param name="width">The width of the image.</param>
 	/// <param name="height">The height of the image.</param>
+	/// <param name="channels">The number of channels of the pixels, 1 to 4.</param>
 	/// <returns>A reference to a Texture object.</returns>
-	static Texture* loadTexture(uint id, constring name, uint8* data, int width, int height);
+	static Texture* loadTexture(uint id, constring name, uint8* data, int width, int height, int channels);
 };
 
 
@@ -0,0 +1,251 @@
+#include "MeshOptimizer.hpp"
+#include "io/ObjLoader.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+static const uint NONE = ~0u;
+
+/// <summary>
+/// Simulates the access of a vertex in a FIFO cache: a vertex is cached while fewer than cacheSize vertices
+/// missed after it, so the time only advances on a miss.
+/// </summary>
+/// <returns>Whether it missed.</returns>
+static bool access(std::vector<uint>& timestamps, uint& time, uint vertex, uint cacheSize)
+{
+	if (time - timestamps[vertex] <= cacheSize)
+		return false;
+	timestamps[vertex] = time++;
+	return true;
+}
+
+float computeACMR(const uint* indices, size_t indexCount, uint vertexCount, uint cacheSize)
+{
+	if (indexCount < 3)
+		return 0;
+	std::vector<uint> timestamps(vertexCount, 0);
+	uint time = cacheSize + 1;
+	size_t misses = 0;
+	for (size_t i = 0; i < indexCount; i++)
+		misses += access(timestamps, time, indices[i], cacheSize);
+	return (float)misses / (indexCount / 3);
+}
+
+void optimizeVertexCache(uint* indices, size_t indexCount, uint vertexCount, std::vector<uint>* clusters, uint cacheSize)
+{
+	size_t triangleCount = indexCount / 3;
+	if (clusters != nullptr)
+		clusters->clear();
+	if (triangleCount == 0)
+		return;
+
+	//The triangles of every vertex, in compressed rows, and how many of them are left to emit
+	std::vector<uint> live(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		live[indices[i]]++;
+	std::vector<uint> offsets(vertexCount + 1, 0);
+	for (uint v = 0; v < vertexCount; v++)
+		offsets[v + 1] = offsets[v] + live[v];
+	std::vector<uint> adjacency(triangleCount * 3);
+	std::vector<uint> filled(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacency[filled[indices[i]]++] = (uint)(i / 3);
+
+	std::vector<uint> timestamps(vertexCount, 0);
+	std::vector<uint8> emitted(triangleCount, 0);
+	std::vector<uint> deadEnds;    //The vertices of the emitted triangles, the most recent last
+	std::vector<uint> candidates;  //The vertices of the triangles emitted around the current one
+	std::vector<uint> output;
+	deadEnds.reserve(triangleCount * 3);
+	output.reserve(triangleCount * 3);
+	uint time = cacheSize + 1;
+	uint cursor = 0;               //The vertices before it have no triangle left
+	bool boundary = true;
+
+	for (uint fanning = indices[0]; fanning != NONE;)
+	{
+		//Emits every triangle left around the vertex
+		candidates.clear();
+		for (uint k = offsets[fanning]; k < offsets[fanning + 1]; k++)
+		{
+			uint triangle = adjacency[k];
+			if (emitted[triangle])
+				continue;
+			if (boundary && clusters != nullptr)
+				clusters->push_back((uint)(output.size() / 3));
+			boundary = false;
+			for (uint c = 0; c < 3; c++)
+			{
+				uint vertex = indices[triangle * 3 + c];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+				access(timestamps, time, vertex, cacheSize);
+			}
+			emitted[triangle] = 1;
+		}
+
+		//Fans next around the oldest candidate that stays in the cache while its' triangles are emitted,
+		//or any candidate with triangles left if none does
+		uint next = NONE;
+		int best = -1;
+		for (uint vertex : candidates)
+		{
+			if (live[vertex] == 0)
+				continue;
+			int priority = 0;
+			if (time - timestamps[vertex] + 2 * live[vertex] <= cacheSize)
+				priority = (int)(time - timestamps[vertex]);
+			if (priority > best)
+			{
+				best = priority;
+				next = vertex;
+			}
+		}
+
+		//Dead end, goes back to the most recent vertex with triangles left, or to the next one in the mesh
+		if (next == NONE)
+		{
+			boundary = true;
+			while (!deadEnds.empty() && next == NONE)
+			{
+				uint vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (live[vertex] > 0)
+					next = vertex;
+			}
+			for (; next == NONE && cursor < vertexCount; cursor++)
+				if (live[cursor] > 0)
+					next = cursor;
+		}
+		fanning = next;
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint));
+}
+
+void optimizeOverdraw(uint* indices, size_t indexCount, const float* positions, size_t stride, uint vertexCount,
+	const std::vector<uint>& clusters, float threshold, uint cacheSize)
+{
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || clusters.empty())
+		return;
+
+	//Cuts the clusters again as soon as their ACMR, the cache starting empty, is close to the one of the mesh
+	float limit = threshold * computeACMR(indices, triangleCount * 3, vertexCount, cacheSize);
+	std::vector<uint> starts;
+	std::vector<uint> timestamps(vertexCount, 0);
+	uint time = cacheSize + 1;
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		uint start = clusters[c];
+		uint end = c + 1 < clusters.size() ? clusters[c + 1] : (uint)triangleCount;
+		starts.push_back(start);
+		time += cacheSize + 1;
+		uint misses = 0;
+		for (uint triangle = start; triangle < end; triangle++)
+		{
+			for (uint corner = 0; corner < 3; corner++)
+				misses += access(timestamps, time, indices[triangle * 3 + corner], cacheSize);
+			if (misses <= limit * (triangle + 1 - start) && triangle + 1 < end)
+			{
+				starts.push_back(triangle + 1);
+				time += cacheSize + 1;
+				misses = 0;
+				start = triangle + 1;
+			}
+		}
+	}
+
+	auto position = [&](uint vertex) {
+		const float* p = (const float*)((const uint8*)positions + vertex * stride);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	glm::vec3 center(0);
+	for (uint v = 0; v < vertexCount; v++)
+		center += position(v);
+	center /= (float)std::max(vertexCount, 1u);
+
+	//Sorts the clusters by how much they face away from the center, with their area weighted normal
+	struct Cluster
+	{
+		uint start, end;
+		float outwards;
+	};
+	std::vector<Cluster> sorted(starts.size());
+	for (size_t c = 0; c < starts.size(); c++)
+	{
+		Cluster& cluster = sorted[c];
+		cluster.start = starts[c];
+		cluster.end = c + 1 < starts.size() ? starts[c + 1] : (uint)triangleCount;
+
+		glm::vec3 normal(0), centroid(0);
+		float area = 0;
+		for (uint triangle = cluster.start; triangle < cluster.end; triangle++)
+		{
+			glm::vec3 a = position(indices[triangle * 3]);
+			glm::vec3 b = position(indices[triangle * 3 + 1]);
+			glm::vec3 c = position(indices[triangle * 3 + 2]);
+			glm::vec3 cross = glm::cross(b - a, c - a);
+			float triangleArea = glm::length(cross);
+			normal += cross;
+			centroid += (a + b + c) * (triangleArea / 3);
+			area += triangleArea;
+		}
+		float length = glm::length(normal);
+		cluster.outwards = area > 0 && length > 0 ? glm::dot(centroid / area - center, normal / length) : 0;
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.outwards > b.outwards; });
+
+	std::vector<uint> output;
+	output.reserve(triangleCount * 3);
+	for (const Cluster& cluster : sorted)
+		output.insert(output.end(), indices + cluster.start * 3, indices + cluster.end * 3);
+	memcpy(indices, output.data(), output.size() * sizeof(uint));
+}
+
+uint optimizeVertexFetch(uint* indices, size_t indexCount, void* vertices, uint vertexCount, size_t vertexSize)
+{
+	std::vector<uint> remap(vertexCount, NONE);
+	std::vector<uint8> reordered(vertexCount * vertexSize);
+	uint used = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint& vertex = remap[indices[i]];
+		if (vertex == NONE)
+		{
+			memcpy(reordered.data() + used * vertexSize, (const uint8*)vertices + indices[i] * vertexSize, vertexSize);
+			vertex = used++;
+		}
+		indices[i] = vertex;
+	}
+	memcpy(vertices, reordered.data(), used * vertexSize);
+	return used;
+}
+
+MeshStats optimizeMesh(ObjMesh& mesh)
+{
+	uint vertexCount = (uint)mesh.vertices.size();
+	MeshStats stats = {};
+	stats.triangles = (uint)(mesh.indices.size() / 3);
+	stats.acmrBefore = computeACMR(mesh.indices.data(), mesh.indices.size(), vertexCount);
+	if (stats.triangles == 0)
+		return stats;
+
+	std::vector<uint> clusters;
+	optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount, &clusters);
+	optimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.vertices[0].position, sizeof(ObjVertex),
+		vertexCount, clusters);
+	vertexCount = optimizeVertexFetch(mesh.indices.data(), mesh.indices.size(), mesh.vertices.data(), vertexCount,
+		sizeof(ObjVertex));
+	mesh.vertices.resize(vertexCount);
+
+	stats.vertices = vertexCount;
+	stats.acmrAfter = computeACMR(mesh.indices.data(), mesh.indices.size(), vertexCount);
+	return stats;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+#include <vector>
+
+struct ObjMesh;
+
+/* Reorders the triangles and the vertices of the loaded models for the GPU, in three passes:
+ *
+ * - Vertex cache: the triangles are reordered with Tipsify (Sander, Nehab and Barczak, 2007), which fans
+ *   around the vertices still in a simulated cache and jumps to the most recently used vertex that has
+ *   triangles left when it reaches a dead end. Linear in the number of triangles.
+ * - Overdraw: the order is cut in clusters, at the dead ends of Tipsify and wherever the cache behaviour
+ *   of a cluster is already good enough, then the clusters facing away from the center of the model are
+ *   drawn first, as they're more likely to hide the others. The triangles of a cluster keep their order,
+ *   so the cache efficiency is barely changed.
+ * - Vertex fetch: the vertices are renumbered in the order the triangles first use them, so the vertex
+ *   buffer is read sequentially. Unused vertices are dropped.
+ *
+ * The cache efficiency is measured as the ACMR, the average number of vertices transformed per triangle,
+ * with a FIFO post transform cache of CACHE_SIZE vertices: 3 at worst, 0.5 at best for a large grid.
+ */
+
+/// <summary>
+/// The number of vertices in the simulated post transform cache.
+/// </summary>
+const uint CACHE_SIZE = 16;
+
+/// <summary>
+/// The ACMR of a mesh before and after optimizeMesh.
+/// </summary>
+struct MeshStats
+{
+	uint triangles, vertices;
+	float acmrBefore, acmrAfter;
+};
+
+/// <summary>
+/// Returns the average number of vertices missing a FIFO cache per triangle.
+/// </summary>
+float computeACMR(const uint* indices, size_t indexCount, uint vertexCount, uint cacheSize = CACHE_SIZE);
+
+/// <summary>
+/// Reorders triangles for the post transform cache with Tipsify.
+/// </summary>
+/// <param name="clusters">If not null, receives the first triangle of every run of triangles ended by a dead end.</param>
+void optimizeVertexCache(uint* indices, size_t indexCount, uint vertexCount, std::vector<uint>* clusters = nullptr,
+	uint cacheSize = CACHE_SIZE);
+
+/// <summary>
+/// Reorders the clusters of triangles of optimizeVertexCache to reduce overdraw.
+/// </summary>
+/// <param name="positions">The position of the first vertex, 3 floats.</param>
+/// <param name="stride">The number of bytes between the positions of 2 vertices.</param>
+/// <param name="threshold">How much the ACMR of a cluster may exceed the one of the mesh, higher values
+/// give smaller clusters to sort, but less cache efficiency.</param>
+void optimizeOverdraw(uint* indices, size_t indexCount, const float* positions, size_t stride, uint vertexCount,
+	const std::vector<uint>& clusters, float threshold = 1.05f, uint cacheSize = CACHE_SIZE);
+
+/// <summary>
+/// Renumbers the vertices in the order the triangles first use them, reordering the vertices.
+/// </summary>
+/// <param name="vertexSize">The size of a vertex in bytes.</param>
+/// <returns>The number of vertices left, the unused ones are dropped.</returns>
+uint optimizeVertexFetch(uint* indices, size_t indexCount, void* vertices, uint vertexCount, size_t vertexSize);
+
+/// <summary>
+/// Runs the three passes on a parsed model, before its' indices are narrowed.
+/// </summary>
+MeshStats optimizeMesh(ObjMesh& mesh);
@@ -2,10 +2,14 @@
 #include "Loader.hpp"
 #include "io/FileIO.hpp"
 
+#include <algorithm>
+
 #pragma region RawModel
 
-RawModel::RawModel(uint id, std::string name, uint vaoID, uint iboID, uint vertexCount) :
-	id(id), name(name), vaoID(vaoID), iboID(iboID), vertexCount(vertexCount) {}
+RawModel* RawModel::quad = nullptr;
+
+RawModel::RawModel(uint id, std::string name, uint vaoID, uint iboID, uint vertexCount, IndexType indexType) :
+	id(id), name(name), vaoID(vaoID), iboID(iboID), vertexCount(vertexCount), indexType(indexType) {}
 
 void RawModel::generateQuad()
 {
@@ -28,60 +32,82 @@ void RawModel::generateQuad()
 		1, 0
 	};
 
-	RawModel::quad = Loader::loadToVao(0, "quad", positions, indices, texCoords, 6);
+	RawModel::quad = Loader::loadToVao(0, "quad", positions, 2, 4, indices, 6, texCoords);
 }
 #pragma endregion
 
 #pragma region Texture
 
-std::vector<Texture&> Texture::textures;
+std::vector<Texture*> Texture::textures;
 
-Texture::Texture(uint id, std::string name, uint textureID) :
-	id(id), name(name), textureID(textureID)
+Texture::Texture(uint id, std::string name, uint textureID, int page, glm::vec4 uvRect) :
+	id(id), name(name), textureID(textureID), page(page), uvRect(uvRect)
 {
-	Texture::textures.push_back(*this);
+	Texture::textures.push_back(this);
 }
 
 #pragma endregion
 
 #pragma region Material
 
-std::vector<Material&> Material::materials;
+std::vector<Material*> Material::materials;
 	
-Material::Material(uint id, std::string name, Shader& shader) :
-	id(id), name(name), shader(shader)
+Material::Material(uint id, std::string name, Shader& shader, MaterialUniforms uniforms, uint uniformBuffer) :
+	id(id), name(name), shader(shader), uniforms(uniforms), uniformBuffer(uniformBuffer)
 {
-	Material::materials.push_back(*this);
+	Material::materials.push_back(this);
 }
 
 #pragma endregion
 
 #pragma region GameObject
 
-std::vector<GameObject&> GameObject::gameobjects;
+std::vector<GameObject*> GameObject::gameobjects;
+
+GameObject::GameObject(uint id, std::string name, const Transform& transform) :
+	id(id), name(name), entity(World::create(maskOf(ComponentType::TRANSFORM)))
+{
+	GameObject::gameobjects.push_back(this);
+	setTransform(transform);
+}
 
-GameObject::GameObject(uint id, std::string name) :
-	id(id), name(name)
+GameObject::~GameObject()
 {
-	GameObject::gameobjects.push_back(*this);
-	transform = *(new Transform());
+	World::destroy(entity);
+
+	gameobjects.erase(std::find(gameobjects.begin(), gameobjects.end(), this));
 }
 
-Component& GameObject::getComponent(uint position)
+Transform GameObject::getTransform() const
 {
-	return components[position];
+	Transform transform;
+	transform.position.x = *World::get<float>(entity, ComponentType::TRANSFORM, Transform::POSITION_X);
+	transform.position.y = *World::get<float>(entity, ComponentType::TRANSFORM, Transform::POSITION_Y);
+	transform.zIndex = *World::get<float>(entity, ComponentType::TRANSFORM, Transform::Z_INDEX);
+	transform.rotation = *World::get<float>(entity, ComponentType::TRANSFORM, Transform::ROTATION);
+	transform.scale = *World::get<float>(entity, ComponentType::TRANSFORM, Transform::SCALE);
+	return transform;
 }
 
+void GameObject::setTransform(const Transform& transform)
+{
+	*World::get<float>(entity, ComponentType::TRANSFORM, Transform::POSITION_X) = transform.position.x;
+	*World::get<float>(entity, ComponentType::TRANSFORM, Transform::POSITION_Y) = transform.position.y;
+	*World::get<float>(entity, ComponentType::TRANSFORM, Transform::Z_INDEX) = transform.zIndex;
+	*World::get<float>(entity, ComponentType::TRANSFORM, Transform::ROTATION) = transform.rotation;
+	*World::get<float>(entity, ComponentType::TRANSFORM, Transform::SCALE) = transform.scale;
+}
 
 #pragma endregion
 
-std::vector<Renderer&> Renderer::renderers;
+#pragma region Renderer
 
-Renderer::Renderer(uint id,GameObject& gameObject, Texture* texture, Material* material) :
-	Component{ id, gameObject }, texture{ texture }, material{ material }
+Renderer& Renderer::create(uint id, GameObject& gameObject, Texture* texture, Material* material)
 {
-	renderers.push_back(*this);
-	gameObject.components.push_back(*this);
+	World::addComponent(gameObject.entity, ComponentType::RENDERER);
+	Renderer* renderer = World::get<Renderer>(gameObject.entity);
+	*renderer = Renderer(id, gameObject.entity, texture, material);
+	return *renderer;
 }
 
-
+#pragma endregion
@@ -3,90 +3,69 @@
 #include "util/Utility.hpp"
 #include "util/Color.hpp"
 #include "Shader.hpp"
+#include "UniformBuffers.hpp"
+#include "ecs/World.hpp"
 
 #include <string>
 #include <unordered_map>
 #include "glm/vec2.hpp"
+#include "glm/vec4.hpp"
 
 /* This class contains all the declaration of structs and classes related to the GameObjects.
- * GameObjects consists of a Transform, a name, an ID (which is for now manually assigned through JSON),
- * and a list of components.
+ * GameObjects consists of a name, an ID (which is for now manually assigned through JSON),
+ * and an entity of the World holding its' Transform and its' components.
  * 
- * Components are stored in giant "lists" and reference their GameObject. They cannot live without being 
- * attached to a GameObject, and it cannot be changed after instantiation. Thus, once instantiated, they
- * immediately take effect on the GameObject. The "lists" can vary depending on the needs of the Component.
+ * Components are stored in the World (see World.hpp), grouped by archetype, and reference their
+ * GameObject by its' entity. They cannot live without being attached to a GameObject, and it cannot
+ * be changed after instantiation. Thus, once instantiated, they immediately take effect on the GameObject.
+ * The component types themselves are declared in Components.hpp.
  * 
  * For example:
- * Rigidbodies are used by the Physics Engine one by one without a particular order, so a Vector is used.
- * Renderers however are grouped by their Shaders and their Texture to batch the rendering, Shaders are
- * loaded once, and Textures once too. (Isn't implemented yet)
+ * Renderers are never accessed one by one: each frame the BatchRenderer sweeps every chunk having a
+ * Transform and a Renderer, and groups the sprites by their Shaders and their Texture to batch the rendering.
  */
 
 //TODO static methods to destroy all of the references of these classes properly
 
 
 
-#pragma region Components
-
-enum class ComponentType
-{
-	RENDERER
-};
-
-/// <summary>
-/// The base class for all Components. Components are added to GameObjects only by instantiating them
-/// </summary>
-struct Component
-{
-	const uint id;          //Is unique for each type of component (for now defined through JSON)
-	GameObject& gameObject; //Reference to the GameObject that has this component
-	bool enabled = true;    //If disabled, the component will be skipped during it's processing
-		
-	Component(uint id, GameObject& gameObject) :
-		id{ id }, gameObject{ gameObject }{}
-};
-
-/// <summary>
-/// The main Rendering component for all sprites.
-/// </summary>
-struct Renderer : Component
-{
-	Texture* texture;     //Pointer to the texture rendered (defaults to blank square if null)
-	Material* material;   //Pointer to the material used by the renderer (defaults to default material)
-
-	//TODO replace by map<shader, map<Texture,vector<gameObjects>>
-	static std::vector<Renderer&> renderers; //Static list of reference to all renderers	
-	
-	Renderer(uint id, GameObject& gameObject, Texture* texture, Material* material);
-};
-
-#pragma endregion
-
-struct Transform
-{
-	glm::vec2 position;
-	float zIndex;
-	float rotation;
-	float scale;
-
-};
-
 /// <summary>
 /// Represents any object in the game. It has a transform, and then components.
+/// The transform and the components are stored in the World, under the entity of the GameObject.
 /// </summary>
 struct GameObject
 {
 	const uint id;				//Is unique for all GameObjects
 	std::string name;		    //The public name displayed in the editor
-	Transform& transform;		//Reference to the transform attached to the GameObject
+	const Entity entity;		//Handle of the transform and the components in the World
+
+	static std::vector<GameObject*> gameobjects; //Static list of all GameObjects
+
+	GameObject(uint id, std::string name, const Transform& transform = Transform());
+	~GameObject();
+
+	/// <summary>
+	/// Returns a copy of the transform of the GameObject.
+	/// </summary>
+	Transform getTransform() const;
 
-	static std::vector<GameObject&> gameobjects; //Static list of reference of all GameObjects
-	std::vector<Component&> components; //TODO Change for a map<Enum Type, Component>
+	/// <summary>
+	/// Overwrites the transform of the GameObject.
+	/// </summary>
+	void setTransform(const Transform& transform);
 
-	GameObject(uint id, std::string name);
+	/// <summary>
+	/// Returns the component of the given type, nullptr if there's none.
+	/// The pointer is valid until an entity changes archetype.
+	/// </summary>
+	template<typename T>
+	T* getComponent() const { return World::get<T>(entity); }
 
-	//TODO replace by template<typename T> 	(or Type)
-	Component& getComponent(uint position);
+	/// <summary>
+	/// Returns whether the GameObject has a component of the given type.
+	/// </summary>
+	template<typename T>
+	bool hasComponent() const { return World::has(entity, T::TYPE); }
 
 };
 
@@ -101,11 +80,12 @@ struct RawModel
 	std::string name;
 	const uint vaoID;
 	const uint iboID;
-	const uint vertexCount;
+	const uint vertexCount;      //Number of indices drawn
+	const IndexType indexType;   //Type of the indices of the ibo
 
 	static RawModel* quad;
 
-	RawModel(uint id, std::string name, uint vaoID, uint iboID, uint vertexCount);	
+	RawModel(uint id, std::string name, uint vaoID, uint iboID, uint vertexCount, IndexType indexType = IndexType::UINT32);	
 	//Quad used to draw basically everything
 	static void generateQuad();
 };
@@ -114,11 +94,13 @@ struct Texture
 {
 	const uint id;          //Unique ID
 	std::string name;       //Name displayed in the editor
-	const uint textureID;   //ID of the texture in video RAM
+	const uint textureID;   //ID of the texture in video RAM, the page if it's in the atlas
+	const int page;         //Page of the TextureAtlas, -1 if it has its' own texture
+	const glm::vec4 uvRect; //Region of the texture used: offset in xy, scale in zw
 
-	static std::vector<Texture&> textures;  //Static vector of references of all of the textures
+	static std::vector<Texture*> textures;  //Static vector of pointers to all of the textures
 
-	Texture(uint id, std::string name, uint textureID);
+	Texture(uint id, std::string name, uint textureID, int page = -1, glm::vec4 uvRect = glm::vec4(0, 0, 1, 1));
 };
 
 //TODO Content must be dynamically added based on the shader attributes and uniforms
@@ -128,13 +110,15 @@ struct Material
 	const uint id;          //Unique id
 	std::string name;       //Name displayed in the editor
 	Shader& shader;         //Reference of the Shader used by this material
+	const MaterialUniforms uniforms; //Read by the Material block of the shaders
+	const uint uniformBuffer;        //Holds uniforms, bound when the material is drawn
 
 	//Example of property that could be used in a Material:
 	//Color color;          //Color used by the Renderer on top of the texture (
 
-	static std::vector<Material&> materials; //Static vector of references of all of the materials
+	static std::vector<Material*> materials; //Static vector of pointers to all of the materials
 
-	Material(uint id, std::string name, Shader& shader);
+	Material(uint id, std::string name, Shader& shader, MaterialUniforms uniforms, uint uniformBuffer);
 };
 
 
@@ -0,0 +1,203 @@
+#include "NullRenderDevice.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+void* NullRenderDevice::mapBuffer(BufferTarget target, size_t size)
+{
+	//The content is never read, the writes of every mapping can go to the same memory
+	if (mapped.size() < size)
+		mapped.resize(size);
+	return mapped.data();
+}
+
+void NullRenderDevice::textureImage2D(uint width, uint height, PixelFormat format, const uint8* data, bool mipmaps)
+{
+	//PixelFormat is ordered by channel count. Mipmaps are generated by the GPU so they're not uploaded
+	countUpload((size_t)width * height * ((int)format + 1));
+}
+
+void NullRenderDevice::textureSubImage2D(uint x, uint y, uint width, uint height, PixelFormat format, const uint8* data)
+{
+	countUpload((size_t)width * height * ((int)format + 1));
+}
+
+uint NullRenderDevice::compileShader(ShaderType type, const char* source)
+{
+	sources[++lastID] = { type, source };
+	return lastID;
+}
+
+void NullRenderDevice::deleteProgram(uint program)
+{
+	state.programDeleted(program);
+	attached.erase(program);
+	for (auto& reflection : reflections)
+		reflection.erase(program);
+}
+
+#pragma region Reflection
+
+/// <summary>
+/// The GLSL types, with their' size and base alignment in a std140 uniform block.
+/// </summary>
+struct GLSLType
+{
+	const char* name;
+	VarType type;
+	uint size, alignment;
+};
+
+static const GLSLType GLSL_TYPES[] =
+{
+	{ "bool", VarType::BOOL, 4, 4 },     { "int", VarType::INT, 4, 4 },       { "uint", VarType::UINT, 4, 4 },
+	{ "float", VarType::FLOAT, 4, 4 },   { "double", VarType::DOUBLE, 8, 8 },
+	{ "bvec2", VarType::BVEC2, 8, 8 },   { "bvec3", VarType::BVEC3, 12, 16 }, { "bvec4", VarType::BVEC4, 16, 16 },
+	{ "ivec2", VarType::IVEC2, 8, 8 },   { "ivec3", VarType::IVEC3, 12, 16 }, { "ivec4", VarType::IVEC4, 16, 16 },
+	{ "uvec2", VarType::UVEC2, 8, 8 },   { "uvec3", VarType::UVEC3, 12, 16 }, { "uvec4", VarType::UVEC4, 16, 16 },
+	{ "vec2", VarType::VEC2, 8, 8 },     { "vec3", VarType::VEC3, 12, 16 },   { "vec4", VarType::VEC4, 16, 16 },
+	{ "dvec2", VarType::DVEC2, 16, 16 }, { "dvec3", VarType::DVEC3, 24, 32 }, { "dvec4", VarType::DVEC4, 32, 32 },
+	{ "mat2", VarType::MAT2, 32, 16 },   { "mat3", VarType::MAT3, 48, 16 },   { "mat4", VarType::MAT4, 64, 16 },
+	{ "mat2x3", VarType::MAT2x3, 32, 16 }, { "mat2x4", VarType::MAT2x4, 32, 16 },
+	{ "mat3x2", VarType::MAT3x2, 48, 16 }, { "mat3x4", VarType::MAT3x4, 48, 16 },
+	{ "mat4x2", VarType::MAT4x2, 64, 16 }, { "mat4x3", VarType::MAT4x3, 64, 16 },
+	{ "sampler2D", VarType::SAMPLER2D, 0, 0 }
+};
+
+static const GLSLType& glslType(const std::string& name)
+{
+	static const GLSLType OTHER = { "", VarType::OTHER, 16, 16 };
+	for (const GLSLType& type : GLSL_TYPES)
+		if (name == type.name)
+			return type;
+	return OTHER;
+}
+
+/// <summary>
+/// Splits a source in identifiers, numbers and single characters, without the comments and the
+/// preprocessor lines.
+/// </summary>
+static std::vector<std::string> tokenize(const std::string& source)
+{
+	std::vector<std::string> tokens;
+	for (size_t i = 0; i < source.size();)
+	{
+		char c = source[i];
+		if (c == '/' && i + 1 < source.size() && source[i + 1] == '/')
+			i = std::min(source.find('\n', i), source.size());
+		else if (c == '/' && i + 1 < source.size() && source[i + 1] == '*')
+			i = std::min(source.find("*/", i + 2), source.size() - 2) + 2;
+		else if (c == '#')
+			i = std::min(source.find('\n', i), source.size());
+		else if (isalnum((uint8)c) || c == '_')
+		{
+			size_t start = i;
+			while (i < source.size() && (isalnum((uint8)source[i]) || source[i] == '_'))
+				i++;
+			tokens.push_back(source.substr(start, i - start));
+		}
+		else
+		{
+			if (!isspace((uint8)c))
+				tokens.push_back(std::string(1, c));
+			i++;
+		}
+	}
+	return tokens;
+}
+
+void NullRenderDevice::linkProgram(uint program)
+{
+	state.programLinked(program);
+	std::vector<ActiveVariable> variables[3];
+	int nextLocation = 0;
+	auto declared = [&](VariableKind kind, const std::string& name) //By another stage, the program has it once
+	{
+		for (const ActiveVariable& variable : variables[(int)kind])
+			if (variable.name == name)
+				return true;
+		return false;
+	};
+	for (uint shader : attached[program])
+	{
+		auto source = sources.find(shader);
+		if (source == sources.end())
+			continue;
+		ShaderType stage = source->second.first;
+		std::vector<std::string> tokens = tokenize(source->second.second);
+		std::unordered_map<std::string, uint> constants; //The const ints, sizes of arrays
+		auto token = [&](size_t i) { return i < tokens.size() ? tokens[i] : std::string(); };
+		auto arraySize = [&](size_t& i) //Reads "[N]" if there's one
+		{
+			if (token(i) != "[")
+				return 1u;
+			const std::string& size = token(i + 1);
+			i += 3;
+			return isdigit((uint8)size[0]) ? (uint)std::stoul(size) : constants[size];
+		};
+
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			int location = -1;
+			if (tokens[i] == "const" && token(i + 1) == "int" && token(i + 3) == "=" && isdigit((uint8)token(i + 4)[0]))
+				constants[token(i + 2)] = (uint)std::stoul(token(i + 4));
+			else if (tokens[i] == "layout")
+			{
+				//layout(location = N) of the next declaration
+				for (i++; i < tokens.size() && tokens[i] != ")"; i++)
+					if (tokens[i] == "location" && token(i + 1) == "=")
+						location = std::stoi(token(i + 2));
+				i++;
+			}
+			if (i >= tokens.size())
+				break;
+
+			if (tokens[i] == "uniform" && token(i + 2) == "{")
+			{
+				uint size = 0;
+				std::string name = token(i + 1);
+				for (i += 3; i < tokens.size() && tokens[i] != "}"; i++)
+				{
+					const GLSLType& type = glslType(tokens[i]);
+					i += 2;
+					uint count = arraySize(i);
+					uint alignment = count > 1 ? 16 : type.alignment;          //Arrays have a stride of vec4s
+					uint stride = count > 1 ? (type.size + 15) / 16 * 16 : type.size;
+					size = (size + alignment - 1) / alignment * alignment + stride * count;
+				}
+				if (!declared(VariableKind::UNIFORM_BLOCK, name))
+					variables[(int)VariableKind::UNIFORM_BLOCK].push_back({ name, VarType::OTHER, (size + 15) / 16 * 16,
+						(int)variables[(int)VariableKind::UNIFORM_BLOCK].size() });
+			}
+			else if (tokens[i] == "uniform")
+			{
+				VarType type = glslType(token(i + 1)).type;
+				std::string name = token(i + 2);
+				i += 3;
+				uint count = arraySize(i);
+				if (declared(VariableKind::UNIFORM, name))
+					continue;
+				variables[(int)VariableKind::UNIFORM].push_back({ name, type, count, nextLocation });
+				nextLocation += count;
+			}
+			else if (tokens[i] == "in" && stage == ShaderType::VERTEX_SHADER)
+			{
+				auto& attributes = variables[(int)VariableKind::ATTRIBUTE];
+				if (location < 0)
+					location = attributes.empty() ? 0 : attributes.back().location + 1;
+				attributes.push_back({ token(i + 2), glslType(token(i + 1)).type, 1, location });
+			}
+		}
+	}
+
+	for (uint kind = 0; kind < 3; kind++)
+		reflections[kind][program] = std::move(variables[kind]);
+}
+
+std::vector<ActiveVariable> NullRenderDevice::activeVariables(uint program, VariableKind kind)
+{
+	auto reflection = reflections[(int)kind].find(program);
+	return reflection != reflections[(int)kind].end() ? reflection->second : std::vector<ActiveVariable>();
+}
+
+#pragma endregion
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "RenderDevice.hpp"
+#include "RenderStateCache.hpp"
+
+#include <unordered_map>
+
+/// <summary>
+/// The headless backend. Nothing is sent to a GPU, every call is only counted in the FrameStats,
+/// and every shader compiles and links successfully. The reflection of a program lists what its' stages
+/// declare, nothing is optimized out. Used on machines without a GPU and to measure the batching and the
+/// upload cost deterministically.
+/// </summary>
+/// <seealso cref="IRenderDevice" />
+class NullRenderDevice : public IRenderDevice
+{
+public:
+
+	const char* name() const override { return "Null"; }
+
+	uint createVertexArray() override { return ++lastID; }
+	void bindVertexArray(uint vao) override { filterStateChange(state.bindVertexArray(vao)); }
+	void deleteVertexArrays(const std::vector<uint>& vaos) override { state.vertexArraysDeleted(vaos); }
+
+	uint createBuffer() override { return ++lastID; }
+	void bindBuffer(BufferTarget target, uint buffer) override { filterStateChange(state.bindBuffer(target, buffer)); }
+	void bindBufferBase(BufferTarget target, uint index, uint buffer) override { filterStateChange(state.bindBufferBase(target, index, buffer)); }
+	void bufferData(BufferTarget target, const void* data, size_t size, BufferUsage usage) override { if (data != nullptr) countUpload(size); }
+	void bufferSubData(BufferTarget target, size_t offset, const void* data, size_t size) override { countUpload(size); }
+	void* mapBuffer(BufferTarget target, size_t size) override;
+	bool unmapBuffer(BufferTarget target) override { return true; }
+	void deleteBuffers(const std::vector<uint>& buffers) override { state.buffersDeleted(buffers); }
+	void vertexAttribute(uint index, uint components, AttribType type, uint stride, size_t offset, uint divisor = 0) override { countStateChange(); }
+
+	uint createTexture() override { return ++lastID; }
+	void bindTexture(uint unit, uint texture) override { filterStateChange(state.bindTexture(unit, texture)); }
+	void textureImage2D(uint width, uint height, PixelFormat format, const uint8* data, bool mipmaps) override;
+	void textureSubImage2D(uint x, uint y, uint width, uint height, PixelFormat format, const uint8* data) override;
+	void compressedTextureImage2D(uint level, uint levels, uint width, uint height, CompressedFormat format, const uint8* data, size_t size) override { countUpload(size); }
+	void generateMipmaps() override {}
+	void deleteTextures(const std::vector<uint>& textures) override { state.texturesDeleted(textures); }
+
+	uint compileShader(ShaderType type, const char* source) override;
+	bool shaderCompiled(uint shader, std::string& infoLog) override { return true; }
+	bool shaderReady(uint shader) override { return true; }
+	void deleteShader(uint shader) override { sources.erase(shader); }
+
+	uint createProgram() override { return ++lastID; }
+	void attachShader(uint program, uint shader) override { attached[program].push_back(shader); }
+	void detachShader(uint program, uint shader) override {}
+	void bindAttribLocation(uint program, uint index, const char* name) override {}
+	void linkProgram(uint program) override;
+	bool programLinked(uint program, std::string& infoLog) override { return true; }
+	bool programReady(uint program) override { return true; }
+	std::string driverIdentity() override { return "Null"; }
+	bool getProgramBinary(uint program, uint& format, std::vector<uint8>& binary) override { return false; }
+	void programBinary(uint program, uint format, const uint8* binary, size_t size) override { state.programLinked(program); }
+	void useProgram(uint program) override { filterStateChange(state.useProgram(program)); }
+	void deleteProgram(uint program) override;
+	std::vector<ActiveVariable> activeVariables(uint program, VariableKind kind) override;
+	void uniformBlockBinding(uint program, uint index, uint binding) override {}
+	void uniformInts(int location, uint count, const int* value) override { filterStateChange(state.uniform(location, value, count * sizeof(int))); }
+	void uniformFloats(int location, uint components, uint count, const float* value) override { filterStateChange(state.uniform(location, value, components * count * sizeof(float))); }
+	void uniformMatrix4(int location, const float* value) override { filterStateChange(state.uniform(location, value, 16 * sizeof(float))); }
+
+	uint createFence() override { return ++lastID; }
+	bool fenceSignaled(uint fence) override { return true; }
+	void deleteFence(uint fence) override {}
+
+	void setBlending(bool enabled) override { filterStateChange(state.setBlending(enabled)); }
+	void setDepthTest(bool enabled) override { filterStateChange(state.setDepthTest(enabled)); }
+
+	void drawElements(uint indexCount, uint instanceCount = 1, IndexType indexType = IndexType::UINT32) override { countDraw(); }
+
+private:
+
+	uint lastID = 0;            //Every object gets a different id, whatever its' type
+	std::vector<uint8> mapped;  //Memory returned by mapBuffer, shared by all the buffers
+	RenderStateCache state;     //Filters the state changes as the OpenGL backend does
+
+	std::unordered_map<uint, std::pair<ShaderType, std::string>> sources;  //Of the shaders, to reflect them
+	std::unordered_map<uint, std::vector<uint>> attached;                 //Shaders by program
+	std::unordered_map<uint, std::vector<ActiveVariable>> reflections[3]; //By VariableKind and linked program
+};
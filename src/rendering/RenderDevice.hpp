@@ -0,0 +1,432 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+#include <string>
+#include <vector>
+
+/* Every call that reaches the graphics API goes through a RenderDevice. The Loader, the Shaders and
+ * the renderers never call glad directly, they call the device stored in Loader::device.
+ *
+ * Two devices exist:
+ * GLRenderDevice forwards everything to OpenGL, it is the one used when a window is opened.
+ * NullRenderDevice only records what would have been sent to the GPU (bytes uploaded, draw calls,
+ * state changes), so the whole pipeline can run and be measured on machines without a GPU.
+ *
+ * Both filter the state changes that change nothing through a RenderStateCache, so the counters are
+ * the calls that would reach the driver.
+ *
+ * Handles returned by a device are plain uints, 0 always meaning "no object", like in OpenGL.
+ */
+
+#pragma region Enums
+
+enum class BufferTarget
+{
+	ARRAY_BUFFER,
+	ELEMENT_ARRAY_BUFFER,
+	UNIFORM_BUFFER,
+	PIXEL_UNPACK_BUFFER
+};
+
+enum class BufferUsage
+{
+	STATIC_DRAW,
+	DYNAMIC_DRAW,
+	STREAM_DRAW
+};
+
+enum class AttribType
+{
+	FLOAT,
+	INT,
+	UINT,
+	UNSIGNED_BYTE
+};
+
+enum class PixelFormat
+{
+	RED,
+	RG,
+	RGB,
+	RGBA
+};
+
+/// <summary>
+/// Returns the format of pixels of 1 to 4 channels, RGBA for any other count.
+/// </summary>
+inline PixelFormat pixelFormatOf(int channels) { return channels >= 1 && channels <= 4 ? (PixelFormat)(channels - 1) : PixelFormat::RGBA; }
+
+/// <summary>
+/// Block compressed formats, made of 4x4 pixel blocks.
+/// </summary>
+enum class CompressedFormat
+{
+	BC1,  //RGB, 8 bytes per block
+	BC3   //RGBA, 16 bytes per block: BC1 colors and interpolated alpha
+};
+
+/// <summary>
+/// Returns the size of an image in a compressed format, the blocks on the right and bottom edges being
+/// partially used.
+/// </summary>
+inline size_t compressedSize(CompressedFormat format, uint width, uint height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * (format == CompressedFormat::BC1 ? 8 : 16);
+}
+
+enum class IndexType
+{
+	UINT16,
+	UINT32
+};
+
+enum class ShaderType
+{
+	VERTEX_SHADER,
+	GEOMETRY_SHADER,
+	FRAGMENT_SHADER
+	//COMPUTE_SHADER Upgrade to opengl 4.6
+};
+
+enum class VarType
+{
+	BOOL,
+	INT,
+	UINT,
+	FLOAT,
+	DOUBLE,
+	BVEC2, BVEC3, BVEC4,
+	IVEC2, IVEC3, IVEC4,
+	UVEC2, UVEC3, UVEC4,
+	VEC2, VEC3, VEC4,
+	DVEC2, DVEC3, DVEC4,//
+	MAT2, MAT3, MAT4,   //
+	MAT2x3, MAT2x4,     //
+	MAT3x2, MAT3x4,     //
+	MAT4x2, MAT4x3,     //
+	SAMPLER2D,          //
+	STRUCT,             //Can only be used as uniform
+	OTHER               //Any type the engine doesn't use, like the other samplers
+};
+
+/// <summary>
+/// What the reflection of a program lists.
+/// </summary>
+enum class VariableKind
+{
+	UNIFORM,        //Outside of the uniform blocks
+	ATTRIBUTE,      //Inputs of the vertex stage
+	UNIFORM_BLOCK
+};
+
+#pragma endregion
+
+/// <summary>
+/// An active uniform, attribute or uniform block of a linked program, as the driver reports it.
+/// </summary>
+struct ActiveVariable
+{
+	std::string name;   //Without the "[0]" of the arrays
+	VarType type;       //OTHER for the blocks
+	uint size;          //The length of an array, 1 otherwise. In bytes for the blocks
+	int location;       //The index for the blocks
+};
+
+/// <summary>
+/// Counters of everything sent to a device during one frame.
+/// </summary>
+struct FrameStats
+{
+	uint64 bytesUploaded = 0; //Bytes sent to buffers and textures
+	uint drawCalls = 0;       //Draw calls issued
+	uint stateChanges = 0;    //Binds, program changes, uniforms... issued
+	uint skippedStateChanges = 0; //Redundant ones, filtered by the RenderStateCache of the backend
+};
+
+/// <summary>
+/// Interface of all the render backends. See the top of RenderDevice.hpp.
+/// </summary>
+class IRenderDevice
+{
+public:
+
+	virtual ~IRenderDevice() = default;
+
+	/// <summary>
+	/// Returns the name of the backend, printed when loading.
+	/// </summary>
+	virtual const char* name() const = 0;
+
+	/// <summary>
+	/// Starts a new frame. The counters of the previous frame are kept in lastFrame.
+	/// </summary>
+	void beginFrame() { lastFrame = frame; frame = FrameStats(); frameCount++; }
+
+	/// <summary>
+	/// Returns the counters of the current frame.
+	/// </summary>
+	const FrameStats& currentFrame() const { return frame; }
+
+	/// <summary>
+	/// Returns the counters of the previous frame.
+	/// </summary>
+	const FrameStats& previousFrame() const { return lastFrame; }
+
+	/// <summary>
+	/// Returns the counters accumulated since the creation of the device.
+	/// </summary>
+	const FrameStats& totalStats() const { return total; }
+
+	/// <summary>
+	/// Returns the number of frames begun on this device.
+	/// </summary>
+	uint frames() const { return frameCount; }
+
+#pragma region Buffers
+
+	virtual uint createVertexArray() = 0;
+	virtual void bindVertexArray(uint vao) = 0;
+	virtual void deleteVertexArrays(const std::vector<uint>& vaos) = 0;
+
+	virtual uint createBuffer() = 0;
+	virtual void bindBuffer(BufferTarget target, uint buffer) = 0;
+	virtual void bindBufferBase(BufferTarget target, uint index, uint buffer) = 0;
+
+	/// <summary>
+	/// (Re)allocates the storage of the buffer bound to the target and fills it with data.
+	/// </summary>
+	/// <param name="data">The data, can be nullptr to only allocate.</param>
+	/// <param name="size">The size of the data in bytes.</param>
+	virtual void bufferData(BufferTarget target, const void* data, size_t size, BufferUsage usage) = 0;
+
+	/// <summary>
+	/// Updates a part of the buffer bound to the target.
+	/// </summary>
+	virtual void bufferSubData(BufferTarget target, size_t offset, const void* data, size_t size) = 0;
+
+	/// <summary>
+	/// Maps the first size bytes of the buffer bound to the target for writing, discarding its' content.
+	/// The GPU must be done reading it, see createFence().
+	/// </summary>
+	/// <returns>nullptr if it couldn't be mapped.</returns>
+	virtual void* mapBuffer(BufferTarget target, size_t size) = 0;
+
+	/// <summary>
+	/// Unmaps the buffer bound to the target.
+	/// </summary>
+	/// <returns>false if its' content was lost while it was mapped.</returns>
+	virtual bool unmapBuffer(BufferTarget target) = 0;
+	virtual void deleteBuffers(const std::vector<uint>& buffers) = 0;
+
+	/// <summary>
+	/// Describes a vertex attribute stored in the buffer bound to ARRAY_BUFFER.
+	/// Float attributes are read as floats, integer attributes are read as integers by the shader.
+	/// </summary>
+	/// <param name="divisor">0 for per vertex data, 1 for per instance data.</param>
+	virtual void vertexAttribute(uint index, uint components, AttribType type, uint stride, size_t offset, uint divisor = 0) = 0;
+
+#pragma endregion
+
+#pragma region Textures
+
+	virtual uint createTexture() = 0;
+	virtual void bindTexture(uint unit, uint texture) = 0;
+
+	/// <summary>
+	/// Uploads an image to the texture bound to unit 0. When a buffer is bound to PIXEL_UNPACK_BUFFER, the
+	/// image is read from it and data is an offset in it.
+	/// </summary>
+	virtual void textureImage2D(uint width, uint height, PixelFormat format, const uint8* data, bool mipmaps) = 0;
+
+	/// <summary>
+	/// Overwrites a region of the first level of the texture bound to unit 0, read from the
+	/// PIXEL_UNPACK_BUFFER like textureImage2D().
+	/// </summary>
+	virtual void textureSubImage2D(uint x, uint y, uint width, uint height, PixelFormat format, const uint8* data) = 0;
+
+	/// <summary>
+	/// Uploads a level of a compressed image to the texture bound to unit 0, read from the
+	/// PIXEL_UNPACK_BUFFER like textureImage2D(). Level 0 sets the filtering of the texture for levels
+	/// levels, each one must then be uploaded.
+	/// </summary>
+	/// <param name="size">The size of the level in bytes, see compressedSize().</param>
+	virtual void compressedTextureImage2D(uint level, uint levels, uint width, uint height, CompressedFormat format, const uint8* data, size_t size) = 0;
+
+	/// <summary>
+	/// Computes the mipmaps of the texture bound to unit 0 from its' first level.
+	/// </summary>
+	virtual void generateMipmaps() = 0;
+	virtual void deleteTextures(const std::vector<uint>& textures) = 0;
+
+#pragma endregion
+
+#pragma region Shaders
+
+	/// <summary>
+	/// Creates and compiles a shader stage.
+	/// </summary>
+	/// <returns>The id of the shader, compiled or not. Use shaderCompiled() to know if it succeeded</returns>
+	virtual uint compileShader(ShaderType type, const char* source) = 0;
+
+	/// <summary>
+	/// Returns whether the shader compiled, waiting for the driver. If not, infoLog is filled with the error.
+	/// </summary>
+	virtual bool shaderCompiled(uint shader, std::string& infoLog) = 0;
+
+	/// <summary>
+	/// Returns whether the driver is done compiling the shader, without waiting. Always true if the
+	/// driver doesn't compile in parallel.
+	/// </summary>
+	virtual bool shaderReady(uint shader) = 0;
+	virtual void deleteShader(uint shader) = 0;
+
+	virtual uint createProgram() = 0;
+	virtual void attachShader(uint program, uint shader) = 0;
+	virtual void detachShader(uint program, uint shader) = 0;
+	virtual void bindAttribLocation(uint program, uint index, const char* name) = 0;
+	virtual void linkProgram(uint program) = 0;
+
+	/// <summary>
+	/// Returns whether the program linked, waiting for the driver. If not, infoLog is filled with the error.
+	/// </summary>
+	virtual bool programLinked(uint program, std::string& infoLog) = 0;
+
+	/// <summary>
+	/// Returns whether the driver is done linking the program, without waiting. Always true if the driver
+	/// doesn't link in parallel.
+	/// </summary>
+	virtual bool programReady(uint program) = 0;
+
+	/// <summary>
+	/// Returns the vendor, renderer and version of the driver. Program binaries only load on the driver
+	/// that made them.
+	/// </summary>
+	virtual std::string driverIdentity() = 0;
+
+	/// <summary>
+	/// Gets the binary of a linked program, in a format of the driver.
+	/// </summary>
+	/// <returns>false if the driver can't give program binaries.</returns>
+	virtual bool getProgramBinary(uint program, uint& format, std::vector<uint8>& binary) = 0;
+
+	/// <summary>
+	/// Loads a binary from getProgramBinary() in a program, instead of attaching and linking its' stages.
+	/// Drivers reject binaries once updated: check it with programLinked().
+	/// </summary>
+	virtual void programBinary(uint program, uint format, const uint8* binary, size_t size) = 0;
+	virtual void useProgram(uint program) = 0;
+	virtual void deleteProgram(uint program) = 0;
+
+	/// <summary>
+	/// Lists the active uniforms, attributes or uniform blocks of a linked program. This is slow, the
+	/// Shaders reflect their program once, see Shader::uniformLocation().
+	/// </summary>
+	virtual std::vector<ActiveVariable> activeVariables(uint program, VariableKind kind) = 0;
+
+	/// <summary>
+	/// Makes a uniform block of a program read the buffer bound to a binding point, see bindBufferBase().
+	/// </summary>
+	/// <param name="index">The index of the block, from activeVariables().</param>
+	virtual void uniformBlockBinding(uint program, uint index, uint binding) = 0;
+
+	/// <summary>
+	/// Sets an int, bool or sampler uniform of the program in use, or count elements of an array.
+	/// </summary>
+	virtual void uniformInts(int location, uint count, const int* value) = 0;
+
+	/// <summary>
+	/// Sets a float or vec uniform of the program in use, or count elements of an array.
+	/// </summary>
+	/// <param name="components">1 for a float, 2 to 4 for a vec.</param>
+	virtual void uniformFloats(int location, uint components, uint count, const float* value) = 0;
+
+	/// <summary>
+	/// Sets a mat4 uniform of the program in use.
+	/// </summary>
+	virtual void uniformMatrix4(int location, const float* value) = 0;
+
+#pragma endregion
+
+#pragma region Sync
+
+	/// <summary>
+	/// Inserts a fence after the commands issued so far.
+	/// </summary>
+	virtual uint createFence() = 0;
+
+	/// <summary>
+	/// Returns whether the GPU executed every command issued before the fence, without waiting.
+	/// </summary>
+	virtual bool fenceSignaled(uint fence) = 0;
+	virtual void deleteFence(uint fence) = 0;
+
+#pragma endregion
+
+#pragma region Pipeline
+
+	/// <summary>
+	/// Enables or disables the alpha blending: the color drawn is mixed with the one below by its' alpha.
+	/// </summary>
+	virtual void setBlending(bool enabled) = 0;
+
+	/// <summary>
+	/// Enables or disables the depth test, the fragments behind the depth buffer being discarded.
+	/// </summary>
+	virtual void setDepthTest(bool enabled) = 0;
+
+#pragma endregion
+
+#pragma region Draw
+
+	/// <summary>
+	/// Draws triangles using the bound vao and its' element buffer.
+	/// </summary>
+	/// <param name="indexCount">The number of indices to draw.</param>
+	/// <param name="instanceCount">The number of instances, 1 for a regular draw.</param>
+	/// <param name="indexType">The type of the indices of the element buffer.</param>
+	virtual void drawElements(uint indexCount, uint instanceCount = 1, IndexType indexType = IndexType::UINT32) = 0;
+
+#pragma endregion
+
+protected:
+
+	/// <summary>
+	/// Records an upload of size bytes.
+	/// </summary>
+	void countUpload(size_t size) { frame.bytesUploaded += size; total.bytesUploaded += size; }
+
+	/// <summary>
+	/// Records a draw call.
+	/// </summary>
+	void countDraw() { frame.drawCalls++; total.drawCalls++; }
+
+	/// <summary>
+	/// Records a state change.
+	/// </summary>
+	void countStateChange() { frame.stateChanges++; total.stateChanges++; }
+
+	/// <summary>
+	/// Records a state change if it changes something, a skipped one otherwise.
+	/// </summary>
+	/// <param name="changed">What the RenderStateCache of the backend returned.</param>
+	/// <returns>changed, whether the call must be issued.</returns>
+	bool filterStateChange(bool changed)
+	{
+		if (!changed)
+		{
+			frame.skippedStateChanges++;
+			total.skippedStateChanges++;
+			return false;
+		}
+		countStateChange();
+		return true;
+	}
+
+private:
+
+	FrameStats frame;
+	FrameStats lastFrame;
+	FrameStats total;
+	uint frameCount = 0;
+};
@@ -0,0 +1,123 @@
+#include "RenderStateCache.hpp"
+
+#include <cstring>
+
+bool RenderStateCache::bindSlot(std::vector<uint>& slots, uint slot, uint object)
+{
+	if (slot >= slots.size())
+		slots.resize(slot + 1, UNKNOWN);
+	if (slots[slot] == object)
+		return false;
+	slots[slot] = object;
+	return true;
+}
+
+bool RenderStateCache::setFlag(int8& flag, bool enabled)
+{
+	if (flag == (int8)enabled)
+		return false;
+	flag = enabled;
+	return true;
+}
+
+bool RenderStateCache::useProgram(uint program)
+{
+	if (this->program == program)
+		return false;
+	this->program = program;
+	return true;
+}
+
+bool RenderStateCache::bindVertexArray(uint vao)
+{
+	if (this->vao == vao)
+		return false;
+	this->vao = vao;
+	buffers[(int)BufferTarget::ELEMENT_ARRAY_BUFFER] = UNKNOWN; //Part of the state of the vao
+	return true;
+}
+
+bool RenderStateCache::bindBuffer(BufferTarget target, uint buffer)
+{
+	uint& bound = buffers[(int)target];
+	if (bound == buffer)
+		return false;
+	bound = buffer;
+	return true;
+}
+
+bool RenderStateCache::bindBufferBase(BufferTarget target, uint index, uint buffer)
+{
+	if (target != BufferTarget::UNIFORM_BUFFER) //No binding index, let the driver report it
+		return true;
+	if (!bindSlot(uniformBuffers, index, buffer))
+		return false;
+	buffers[(int)target] = buffer; //Also binds the target
+	return true;
+}
+
+bool RenderStateCache::bindTexture(uint unit, uint texture)
+{
+	return bindSlot(textures, unit, texture);
+}
+
+bool RenderStateCache::setBlending(bool enabled)
+{
+	return setFlag(blending, enabled);
+}
+
+bool RenderStateCache::setDepthTest(bool enabled)
+{
+	return setFlag(depthTest, enabled);
+}
+
+bool RenderStateCache::uniform(int location, const void* value, size_t size)
+{
+	if (program == UNKNOWN || program == 0)
+		return true;
+	std::vector<uint8>& shadow = uniforms[program][location];
+	if (shadow.size() == size && memcmp(shadow.data(), value, size) == 0)
+		return false;
+	shadow.assign((const uint8*)value, (const uint8*)value + size);
+	return true;
+}
+
+void RenderStateCache::programLinked(uint program)
+{
+	uniforms.erase(program);
+}
+
+void RenderStateCache::programDeleted(uint program)
+{
+	uniforms.erase(program);
+	if (this->program == program)
+		this->program = UNKNOWN; //Still in use until another one is, but its' id can be given again
+}
+
+void RenderStateCache::vertexArraysDeleted(const std::vector<uint>& vaos)
+{
+	for (uint deleted : vaos)
+		if (vao == deleted)
+		{
+			vao = UNKNOWN;
+			buffers[(int)BufferTarget::ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+		}
+}
+
+void RenderStateCache::buffersDeleted(const std::vector<uint>& deleted)
+{
+	for (uint buffer : deleted)
+	{
+		for (uint& bound : buffers)
+			bound = bound == buffer ? UNKNOWN : bound;
+		for (uint& bound : uniformBuffers)
+			bound = bound == buffer ? UNKNOWN : bound;
+	}
+}
+
+void RenderStateCache::texturesDeleted(const std::vector<uint>& deleted)
+{
+	for (uint texture : deleted)
+		for (uint& bound : textures)
+			bound = bound == texture ? UNKNOWN : bound;
+}
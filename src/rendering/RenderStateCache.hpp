@@ -0,0 +1,79 @@
+#pragma once
+
+#include "RenderDevice.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+/* The renderers set the state they need without knowing what is bound: a frame starts by binding the
+ * instance buffer and the quad, every batch sets the projectionView of its' shader again. Most of these
+ * calls change nothing, yet each one costs a validation in the driver.
+ *
+ * A RenderStateCache shadows what a backend has bound: the program, the vao, the buffer of every target
+ * and uniform binding, the texture of every unit, the blending, the depth test and the value of every
+ * uniform of every program. The backends ask it before each call and only issue the ones that change
+ * something, counting the others as skipped in the FrameStats.
+ *
+ * Everything starts unknown, so the first call of each kind is always issued, and forgetting is always
+ * safe. Deleting an object forgets where it was bound, as its' id can be given again to a new one.
+ */
+
+/// <summary>
+/// The state a backend has bound, to filter the redundant calls. See the top of RenderStateCache.hpp.
+/// </summary>
+class RenderStateCache
+{
+public:
+
+	static constexpr uint UNKNOWN = 0xFFFFFFFF; //No object has this id
+
+	/// <summary>
+	/// Each function records the new state and returns whether it differs from the one bound,
+	/// so whether the call must be issued.
+	/// </summary>
+	bool useProgram(uint program);
+	bool bindVertexArray(uint vao);
+	bool bindBuffer(BufferTarget target, uint buffer);
+	bool bindBufferBase(BufferTarget target, uint index, uint buffer);
+	bool bindTexture(uint unit, uint texture);
+	bool setBlending(bool enabled);
+	bool setDepthTest(bool enabled);
+
+	/// <summary>
+	/// Records the value of a uniform of the program in use and returns whether it changed. A location is
+	/// compared as a whole, so the arrays must always be set from their first location.
+	/// </summary>
+	/// <param name="size">The size of the value in bytes.</param>
+	bool uniform(int location, const void* value, size_t size);
+
+	/// <summary>
+	/// Forgets the uniforms of a program, reset to their defaults by linking or loading a binary.
+	/// </summary>
+	void programLinked(uint program);
+	void programDeleted(uint program);
+	void vertexArraysDeleted(const std::vector<uint>& vaos);
+	void buffersDeleted(const std::vector<uint>& buffers);
+	void texturesDeleted(const std::vector<uint>& textures);
+
+private:
+
+	uint program = UNKNOWN;
+	uint vao = UNKNOWN;
+	uint buffers[4] = { UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN }; //By BufferTarget
+	std::vector<uint> uniformBuffers;                         //By binding index
+	std::vector<uint> textures;                               //By unit
+	int8 blending = -1;                                       //-1 when unknown
+	int8 depthTest = -1;
+
+	std::unordered_map<uint, std::unordered_map<int, std::vector<uint8>>> uniforms; //Values by location, by program
+
+	/// <summary>
+	/// Records an object in a slot of a table, growing it with unknown slots.
+	/// </summary>
+	static bool bindSlot(std::vector<uint>& slots, uint slot, uint object);
+
+	/// <summary>
+	/// Records a flag, -1 meaning unknown.
+	/// </summary>
+	static bool setFlag(int8& flag, bool enabled);
+};
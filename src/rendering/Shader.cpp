@@ -1,32 +1,39 @@
 #include "Shader.hpp"
+#include "Loader.hpp"
+#include "ShaderCache.hpp"
+#include "UniformBuffers.hpp"
 #include "io/FileIO.hpp"
 #include "io/Error.hpp"
 
+#include <algorithm>
 #include <stdio.h>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 
 
 uint loadShader(constring path, ShaderType shaderType, std::string& shaderCode)
 {
-	std::ifstream file;
-	if (!openFile(&file, "res/shaders/" + path))     //First we open the file and return 0 if couldn't be opened
+	if (!readFile("res/shaders/" + path, shaderCode))     //First we read the file and return 0 if couldn't be opened
 		return 0;
 
-	readFile(file, shaderCode);           //Read the bytes from the file
+    return compileShader(path, shaderType, shaderCode);
+}
+
+uint compileShader(constring path, ShaderType shaderType, const std::string& shaderCode)
+{
+    uint shader = Loader::device->compileShader(shaderType, shaderCode.c_str());
+    return checkShader(path, shaderType, shader) ? shader : 0;
+}
 
-    const char* constShaderCode = shaderCode.c_str();
-    uint shader = glCreateShader((GLenum)shaderType);
-    glShaderSource(shader, 1, &constShaderCode, NULL);
-    glCompileShader(shader);
+bool checkShader(constring path, ShaderType shaderType, uint shader)
+{
     // check for shader compile errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    std::string infoLog;
+    if (!Loader::device->shaderCompiled(shader, infoLog))
     {
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
         ShaderError errorType;
         switch (shaderType)
         {
@@ -42,105 +49,206 @@ uint loadShader(constring path, ShaderType shaderType, std::string& shaderCode)
         }
         ErrorManager::printShaderError(errorType, path, infoLog);
         
-        return 0;
+        return false;
     }
-    return shader;
+    return true;
 }
 
-uint linkShaders(uint id, std::string name, const VertexShader* vertexShader, const GeometryShader* geometryShader, const FragmentShader* fragmentShader)
+/// <summary>
+/// Creates a program, attaches the stages and links it, without waiting for the driver.
+/// </summary>
+static uint submitLink(uint vShaderID, uint gShaderID, uint fShaderID)
 {
-    uint shaderProgram = glCreateProgram();
-    int success;
-    char infoLog[512];
+    IRenderDevice* device = Loader::device;
+    uint shaderProgram = device->createProgram();
+
+    device->attachShader(shaderProgram, vShaderID);
+    if (gShaderID != 0)
+        device->attachShader(shaderProgram, gShaderID);
+    device->attachShader(shaderProgram, fShaderID);
+    device->linkProgram(shaderProgram);
+    return shaderProgram;
+}
 
-    glAttachShader(shaderProgram, vertexShader->shaderID);
-    if (geometryShader != nullptr)
-        glAttachShader(shaderProgram, geometryShader->shaderID);
-    glAttachShader(shaderProgram, fragmentShader->shaderID);
-    glLinkProgram(shaderProgram);
+uint linkProgram(uint vShaderID, uint gShaderID, uint fShaderID, constring vertexName, constring geometryName, constring fragmentName)
+{
+    uint shaderProgram = submitLink(vShaderID, gShaderID, fShaderID);
+    return checkProgram(shaderProgram, vertexName, geometryName, fragmentName) ? shaderProgram : 0;
+}
 
+bool checkProgram(uint programID, constring vertexName, constring geometryName, constring fragmentName)
+{
     // check for linking errors
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
+    std::string infoLog;
+    if (!Loader::device->programLinked(programID, infoLog))
+    {
+        ErrorManager::printShaderError(ShaderError::CANT_LINK, "", infoLog, vertexName, geometryName, fragmentName);
+        Loader::device->deleteProgram(programID);
+        return false;
+    }
+    return true;
+}
+
+/// <summary>
+/// Submits the compilation of the stages of a program not compiled yet, then its' link.
+/// </summary>
+static void submitStages(PendingShader& shader)
+{
+    //Stages shared with programs submitted before are already compiling
+    shader.programID = submitLink(shader.vertexShader->compile(),
+        shader.geometryShader != nullptr ? shader.geometryShader->compile() : 0,
+        shader.fragmentShader->compile());
+    shader.cached = false;
+}
+
+void submitShaders(PendingShader& shader)
+{
+    shader.start = std::chrono::steady_clock::now();
+    shader.key = ShaderCache::key(shader.vertexShader->code,
+        shader.geometryShader != nullptr ? shader.geometryShader->code : "",
+        shader.fragmentShader->code);
+    shader.programID = ShaderCache::load(shader.key);
+    shader.cached = shader.programID != 0;
+    if (!shader.cached)
+        submitStages(shader);
+}
+
+uint finishShaders(PendingShader& shader)
+{
+    IRenderDevice* device = Loader::device;
+    auto elapsedMs = [&]() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shader.start).count(); };
+    auto wait = [&]() //Polled, the driver keeps working on the other programs meanwhile
     {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        ErrorManager::printShaderError(ShaderError::CANT_LINK, "", infoLog, 
-            vertexShader->name, 
-            geometryShader != nullptr? geometryShader->name : "", 
-            fragmentShader->name);
+        while (!device->programReady(shader.programID))
+            std::this_thread::yield();
+    };
+
+    wait();
+    if (shader.cached)
+    {
+        std::string infoLog;
+        if (device->programLinked(shader.programID, infoLog))
+        {
+            new Shader(shader.id, shader.name, shader.programID, 0, 0, 0, 0); //No stage to delete
+            printf("Loaded the shader %s from the cache in %.2f ms\n", shader.name.c_str(), elapsedMs());
+            return shader.programID;
+        }
+        device->deleteProgram(shader.programID);
+        ShaderCache::reject(shader.key);
+        submitStages(shader);
+        wait();
+    }
+
+    //The errors of the stages explain the failure of the link, and every one of them is printed
+    bool compiled = shader.vertexShader->check();
+    compiled &= shader.geometryShader == nullptr || shader.geometryShader->check();
+    compiled &= shader.fragmentShader->check();
+    if (!compiled)
+    {
+        device->deleteProgram(shader.programID);
         return 0;
     }
-    new Shader(id, name, shaderProgram, 0, 
-        vertexShader->shaderID, 
-        geometryShader != nullptr? geometryShader->shaderID : 0, 
-        fragmentShader->shaderID);
+    if (!checkProgram(shader.programID, shader.vertexShader->name,
+        shader.geometryShader != nullptr ? shader.geometryShader->name : "", shader.fragmentShader->name))
+        return 0;
 
-    return shaderProgram;
+    new Shader(shader.id, shader.name, shader.programID, 0,
+        shader.vertexShader->shaderID,
+        shader.geometryShader != nullptr ? shader.geometryShader->shaderID : 0,
+        shader.fragmentShader->shaderID);
+    double linked = elapsedMs();
+
+    ShaderCache::save(shader.key, shader.programID);
+    printf("Compiled and linked the shader %s in %.2f ms\n", shader.name.c_str(), linked);
+    return shader.programID;
 }
 
 
 #pragma region ShaderBase
 
-ShaderBase::ShaderBase(uint id, std::string name, uint shaderID):
-    id(id), name(name), shaderID(shaderID){}
+ShaderBase::ShaderBase(uint id, std::string name, std::string path, ShaderType type, std::string code):
+    id(id), name(name), path(path), type(type), code(UniformBuffers::expand(code)){}
 
 ShaderBase::~ShaderBase()
 {
 
 }
 
-VertexShader::VertexShader(uint id, std::string name, uint shaderID) : ShaderBase(id,name,shaderID)
+uint ShaderBase::compile()
+{
+    if (shaderID == 0)
+        shaderID = Loader::device->compileShader(type, code.c_str());
+    return shaderID;
+}
+
+bool ShaderBase::check()
+{
+    if (!checked)
+    {
+        checked = true;
+        valid = checkShader(path, type, shaderID);
+    }
+    return valid;
+}
+
+std::vector<VertexShader*> VertexShader::vertexShaders;
+VertexShader::VertexShader(uint id, std::string name, std::string path, std::string code) :
+    ShaderBase(id, name, path, ShaderType::VERTEX_SHADER, std::move(code))
 {
     VertexShader::vertexShaders.push_back(this);
 }
 
 VertexShader::~VertexShader()
 {
-    VertexShader::vertexShaders.erase(VertexShader::vertexShaders.begin() + id); //Remove the shader from the static array
+    VertexShader::vertexShaders.erase(std::find(VertexShader::vertexShaders.begin(), VertexShader::vertexShaders.end(), this)); //Remove the shader from the static array
 }
 
-GeometryShader::GeometryShader(uint id, std::string name, uint shaderID) : ShaderBase(id, name, shaderID)
+std::vector<GeometryShader*> GeometryShader::geometryShaders;
+GeometryShader::GeometryShader(uint id, std::string name, std::string path, std::string code) :
+    ShaderBase(id, name, path, ShaderType::GEOMETRY_SHADER, std::move(code))
 {
     GeometryShader::geometryShaders.push_back(this);
 }
 
 GeometryShader::~GeometryShader()
 {
-    GeometryShader::geometryShaders.erase(GeometryShader::geometryShaders.begin() + id); //Remove the shader from the static array
+    GeometryShader::geometryShaders.erase(std::find(GeometryShader::geometryShaders.begin(), GeometryShader::geometryShaders.end(), this)); //Remove the shader from the static array
 }
 
-FragmentShader::FragmentShader(uint id, std::string name, uint shaderID) : ShaderBase(id, name, shaderID)
+std::vector<FragmentShader*> FragmentShader::fragmentShaders;
+FragmentShader::FragmentShader(uint id, std::string name, std::string path, std::string code) :
+    ShaderBase(id, name, path, ShaderType::FRAGMENT_SHADER, std::move(code))
 {
     FragmentShader::fragmentShaders.push_back(this);
 }
 
 FragmentShader::~FragmentShader()
 {
-    FragmentShader::fragmentShaders.erase(FragmentShader::fragmentShaders.begin() + id); //Remove the shader from the static array
+    FragmentShader::fragmentShaders.erase(std::find(FragmentShader::fragmentShaders.begin(), FragmentShader::fragmentShaders.end(), this)); //Remove the shader from the static array
 }
 
 void VertexShader::destroy()
 {
-    for (const VertexShader* s : vertexShaders)
+    while (!vertexShaders.empty())
     {
-        delete s;
+        delete vertexShaders.back(); //Removes itself from the static array
     }
 }
 
 void GeometryShader::destroy()
 {
-    for (const GeometryShader* s : geometryShaders)
+    while (!geometryShaders.empty())
     {
-        delete s;
+        delete geometryShaders.back(); //Removes itself from the static array
     }
 }
 
 
 void FragmentShader::destroy()
 {
-    for (const FragmentShader* s : fragmentShaders)
+    while (!fragmentShaders.empty())
     {
-        delete s;
+        delete fragmentShaders.back(); //Removes itself from the static array
     }
 }
 
@@ -151,46 +259,159 @@ void FragmentShader::destroy()
 
 void Shader::start()
 {
-    glUseProgram(programID);
+    Loader::device->useProgram(programID);
 }
 
 void Shader::stop()
 {
-    glUseProgram(0);
+    Loader::device->useProgram(0);
 }
 
 void Shader::bindAttribute(uint attribute, const char* attribName)
 {
-    glBindAttribLocation(programID, attribute, attribName);
+    Loader::device->bindAttribLocation(programID, attribute, attribName);
 }
 
-std::vector<Shader&> Shader::shaders;
+std::vector<std::string> Shader::names;
+std::unordered_map<std::string, uint> Shader::nameIds;
+
+uint Shader::nameId(constring name)
+{
+    auto [it, added] = nameIds.try_emplace(name, (uint)names.size());
+    if (added)
+        names.push_back(name);
+    return it->second;
+}
+
+constring Shader::nameOf(uint nameId)
+{
+    return names[nameId];
+}
+
+void Shader::setUniform(uint nameId, int value) const
+{
+    int location = uniformLocation(nameId);
+    if (location >= 0)
+        Loader::device->uniformInts(location, 1, &value);
+}
+
+void Shader::setUniform(uint nameId, float value) const
+{
+    int location = uniformLocation(nameId);
+    if (location >= 0)
+        Loader::device->uniformFloats(location, 1, 1, &value);
+}
+
+void Shader::setUniform(uint nameId, const glm::vec2& value) const
+{
+    int location = uniformLocation(nameId);
+    if (location >= 0)
+        Loader::device->uniformFloats(location, 2, 1, &value.x);
+}
+
+void Shader::setUniform(uint nameId, const glm::vec3& value) const
+{
+    int location = uniformLocation(nameId);
+    if (location >= 0)
+        Loader::device->uniformFloats(location, 3, 1, &value.x);
+}
+
+void Shader::setUniform(uint nameId, const glm::vec4& value) const
+{
+    int location = uniformLocation(nameId);
+    if (location >= 0)
+        Loader::device->uniformFloats(location, 4, 1, &value.x);
+}
+
+void Shader::setUniform(uint nameId, const glm::mat4& value) const
+{
+    int location = uniformLocation(nameId);
+    if (location >= 0)
+        Loader::device->uniformMatrix4(location, &value[0][0]);
+}
+
+void Shader::setUniform(uint nameId, const glm::vec3* values, uint count) const
+{
+    int location = uniformLocation(nameId);
+    if (location >= 0 && count > 0)
+        Loader::device->uniformFloats(location, 3, count, &values[0].x);
+}
+
+void Shader::reflect()
+{
+    IRenderDevice* device = Loader::device;
+    uniforms.clear();
+    attributes.clear();
+    blocks.clear();
+    locations.clear();
+
+    for (const ActiveVariable& uniform : device->activeVariables(programID, VariableKind::UNIFORM))
+    {
+        uint name = nameId(uniform.name);
+        uniforms.push_back({ name, uniform.type, uniform.size, uniform.location });
+        if (name >= locations.size())
+            locations.resize(name + 1, -1);
+        locations[name] = uniform.location;
+    }
+    for (const ActiveVariable& attribute : device->activeVariables(programID, VariableKind::ATTRIBUTE))
+        attributes.push_back({ nameId(attribute.name), attribute.type, attribute.size, attribute.location });
+    for (const ActiveVariable& block : device->activeVariables(programID, VariableKind::UNIFORM_BLOCK))
+    {
+        blocks.push_back({ nameId(block.name), block.size, (uint)block.location });
+        UniformBuffers::bindBlock(programID, name, (uint)block.location, block.name, block.size);
+    }
+}
+
+std::vector<Shader*> Shader::shaders;
 Shader::Shader(uint id, std::string name, uint programID, uint attribCount, uint vShaderID, uint gShaderID, uint fShaderID) :
     id(id), name(name), programID(programID), attribCount(attribCount), vertexShaderID(vShaderID), geometryShaderID(gShaderID), fragmentShaderID(fShaderID)
 {
-    shaders.push_back(*this);
+    shaders.push_back(this);
+    reflect();
 }
 
 Shader::~Shader()
 {
-    glDetachShader(programID, vertexShaderID);
-    glDeleteProgram(vertexShaderID);
-    if (geometryShaderID != 0)
+    deleteProgram();
+    Shader::shaders.erase(std::find(Shader::shaders.begin(), Shader::shaders.end(), this)); //Remove the shader from the static array
+}
+
+Shader* Shader::find(uint id)
+{
+    for (Shader* shader : shaders)
+        if (shader->id == id)
+            return shader;
+    return nullptr;
+}
+
+void Shader::relink(uint programID, uint vShaderID, uint gShaderID, uint fShaderID)
+{
+    deleteProgram();
+    this->programID = programID;
+    vertexShaderID = vShaderID;
+    geometryShaderID = gShaderID;
+    fragmentShaderID = fShaderID;
+    reflect();
+}
+
+void Shader::deleteProgram()
+{
+    IRenderDevice* device = Loader::device;
+    for (uint stage : { vertexShaderID, geometryShaderID, fragmentShaderID })
     {
-        glDetachShader(programID, geometryShaderID);
-        glDeleteProgram(geometryShaderID);
+        if (stage == 0) //Absent, or the program came from the ShaderCache
+            continue;
+        device->detachShader(programID, stage);
+        device->deleteShader(stage);
     }
-    glDetachShader(programID, fragmentShaderID);
-    glDeleteProgram(fragmentShaderID);
-    glDeleteProgram(programID);
-    Shader::shaders.erase(Shader::shaders.begin() + id); //Remove the shader from the static array
+    device->deleteProgram(programID);
 }
 
 void Shader::destroy()
 {
-    for (const Shader* s : shaders)
+    while (!shaders.empty())
     {
-        delete s;
+        delete shaders.back(); //Removes itself from the static array
     }
 }
 
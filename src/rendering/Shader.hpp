@@ -1,83 +1,92 @@
 #pragma once
 
 #include "util/Utility.hpp"
-#include <glad.h>
+#include "RenderDevice.hpp"
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+#include <chrono>
+#include <unordered_map>
 #include <vector>
 
 #pragma region Classes
 
-enum class ShaderType
-{
-	VERTEX_SHADER,
-	GEOMETRY_SHADER,
-	FRAGMENT_SHADER
-	//COMPUTE_SHADER Upgrade to opengl 4.6
-};
-
-enum class VarType
-{
-	BOOL,
-	INT,
-	UINT,
-	FLOAT,
-	DOUBLE,
-	BVEC2, BVEC3, BVEC4,
-	IVEC2, IVEC3, IVEC4,
-	UVEC2, UVEC3, UVEC4,
-	VEC2, VEC3, VEC4,
-	DVEC2, DVEC3, DVEC4,//
-	MAT2, MAT3, MAT4,   //
-	MAT2x3, MAT2x4,     //
-	MAT3x2, MAT3x4,     //
-	MAT4x2, MAT4x3,     //
-	SAMPLER2D,          //
-	STRUCT              //Can only be used as uniform
-};
-
-
 /// <summary>
 /// Represents an attribute or a uniform in a shader.
 /// </summary>
 struct UniformAttrib
 {
+	uint name;      //Interned, see Shader::nameId()
 	VarType type;
-	std::string name;
-	bool isArray;
+	uint size;      //The length of an array, 1 otherwise
+	int location;
 };
 
 /// <summary>
-/// Represents a Vertex, Geometry or Fragment shader. This is temporary data that is deleted after loading
+/// Represents a uniform block in a shader.
+/// </summary>
+struct UniformBlock
+{
+	uint name;      //Interned, see Shader::nameId()
+	uint size;      //In bytes
+	uint index;
+};
+
+/// <summary>
+/// Represents a Vertex, Geometry or Fragment shader. This is temporary data that is deleted after loading.
+/// A stage is only compiled when a program using it isn't in the ShaderCache.
 /// </summary>
 struct ShaderBase
 {
 	const uint id;
 	const std::string name;
-	const uint shaderID;
+	const std::string path;   //Relative to res/shaders
+	const ShaderType type;
+	const std::string code;
+	uint shaderID = 0;        //0 until compiled
 
-	ShaderBase(uint id, std::string name, uint shaderID);
+	ShaderBase(uint id, std::string name, std::string path, ShaderType type, std::string code);
 	~ShaderBase();
+
+	/// <summary>
+	/// Submits the compilation of the stage the first time it's called, without waiting for the driver.
+	/// On the thread of the render device.
+	/// </summary>
+	/// <returns>The shaderID.</returns>
+	uint compile();
+
+	/// <summary>
+	/// Returns whether the stage compiled, waiting for the driver. The error is printed the first time.
+	/// </summary>
+	bool check();
+
+private:
+
+	bool checked = false;
+	bool valid = false;       //Whether it compiled, once checked
 };
 
 struct VertexShader :ShaderBase
 {
-	static std::vector<const VertexShader*> vertexShaders;
-	VertexShader(uint id, std::string name, uint shaderID);
+	static std::vector<VertexShader*> vertexShaders;
+	VertexShader(uint id, std::string name, std::string path, std::string code);
 	~VertexShader();
 	static void destroy();
 };
 
 struct GeometryShader :ShaderBase
 {
-	static std::vector<const GeometryShader*> geometryShaders;
-	GeometryShader(uint id, std::string name, uint shaderID);
+	static std::vector<GeometryShader*> geometryShaders;
+	GeometryShader(uint id, std::string name, std::string path, std::string code);
 	~GeometryShader();
 	static void destroy();
 };
 
 struct FragmentShader :ShaderBase
 {
-	static std::vector<const FragmentShader*> fragmentShaders;
-	FragmentShader(uint id, std::string name, uint shaderID);
+	static std::vector<FragmentShader*> fragmentShaders;
+	FragmentShader(uint id, std::string name, std::string path, std::string code);
 	~FragmentShader();
 	static void destroy();
 };
@@ -91,10 +100,16 @@ public:
 
 	const uint id;
 	const std::string name;
-	std::vector<const int> uniforms;  //Uniforms stored in order of appearance in the shader
-	std::vector<const int> attributes;//Attributes stored in order of appearance in the shader
+	std::vector<UniformAttrib> uniforms;  //Active uniforms outside of the blocks, reflected after the link
+	std::vector<UniformAttrib> attributes;//Active attributes, reflected after the link
+	std::vector<UniformBlock> blocks;     //Active uniform blocks, reflected after the link
 
-	static std::vector<Shader&> shaders;
+	static std::vector<Shader*> shaders;  //In their order of loading, not indexed by id
+
+	/// <summary>
+	/// Returns the shader with the given id, nullptr if it isn't loaded.
+	/// </summary>
+	static Shader* find(uint id);
 
 	void start();
 
@@ -102,9 +117,48 @@ public:
 
 	void bindAttribute(uint attribute, const char* attribName);
 
+	/// <summary>
+	/// Returns the id of a name of uniform, attribute or block, the same in every shader. Get it once,
+	/// then use it instead of the string. On the thread of the render device.
+	/// </summary>
+	static uint nameId(constring name);
+
+	/// <summary>
+	/// Returns the name of an id from nameId().
+	/// </summary>
+	static constring nameOf(uint nameId);
+
+	/// <summary>
+	/// Returns the location of an uniform, -1 if it isn't active in this shader. Read from the reflection,
+	/// the driver isn't queried.
+	/// </summary>
+	int uniformLocation(uint nameId) const { return nameId < locations.size() ? locations[nameId] : -1; }
+
+	/// <summary>
+	/// Sets an uniform of the shader, which must be started. Does nothing if it isn't active, as the
+	/// driver does.
+	/// </summary>
+	/// <param name="nameId">From nameId().</param>
+	void setUniform(uint nameId, int value) const;
+	void setUniform(uint nameId, float value) const;
+	void setUniform(uint nameId, const glm::vec2& value) const;
+	void setUniform(uint nameId, const glm::vec3& value) const;
+	void setUniform(uint nameId, const glm::vec4& value) const;
+	void setUniform(uint nameId, const glm::mat4& value) const;
+
+	/// <summary>
+	/// Sets the first count elements of an array uniform of the shader, which must be started.
+	/// </summary>
+	void setUniform(uint nameId, const glm::vec3* values, uint count) const;
+
 	Shader(uint id, std::string name, uint programID, uint attribCount, uint vShaderID, uint gShaderID, uint fShaderID);
 	~Shader();															
 
+	/// <summary>
+	/// Replaces the program and the stages by newly linked ones, deleting the old ones, then reflects it.
+	/// </summary>
+	void relink(uint programID, uint vShaderID, uint gShaderID, uint fShaderID);
+
 	/// <summary>
 	/// Destroys all the shaders stored and unloads them 
 	/// </summary>
@@ -112,15 +166,46 @@ public:
 
 private:
 
-	const uint programID;
+	uint programID;           //Replaced when it's hot reloaded
 	const uint attribCount;
-	const uint vertexShaderID;
-	const uint geometryShaderID;
-	const uint fragmentShaderID;
+	uint vertexShaderID;
+	uint geometryShaderID;
+	uint fragmentShaderID;
+	std::vector<int> locations; //Of the uniforms, by name id, -1 if not active
+
+	static std::vector<std::string> names;                //By id
+	static std::unordered_map<std::string, uint> nameIds;
+
+	/// <summary>
+	/// Fills the uniforms, attributes, blocks and locations from the driver.
+	/// </summary>
+	void reflect();
+
+	/// <summary>
+	/// Detaches and deletes the stages, then deletes the program.
+	/// </summary>
+	void deleteProgram();
 };
 
 #pragma endregion
 
+/// <summary>
+/// A shader program submitted to the driver, between submitShaders() and finishShaders().
+/// </summary>
+struct PendingShader
+{
+	uint id = 0;
+	std::string name;
+	VertexShader* vertexShader = nullptr;
+	GeometryShader* geometryShader = nullptr;    //nullptr to not link one
+	FragmentShader* fragmentShader = nullptr;
+
+	uint programID = 0;                          //Set by submitShaders()
+	uint64 key = 0;                              //In the ShaderCache
+	bool cached = false;                         //Whether the program is loaded from its' binary
+	std::chrono::steady_clock::time_point start;
+};
+
 /// <summary>
 /// Loads and compile a shader.
 /// </summary>
@@ -130,14 +215,46 @@ private:
 uint loadShader(constring path, ShaderType shaderType, std::string& shaderCode);
 
 /// <summary>
-/// Links shaders together and makes a shader program.
+/// Compiles a shader already read, on the thread of the render device.
 /// </summary>
-/// <param name="id"> The id of the shader program. </param>
-/// <param name="name"> The name of the shader program. </param>
-/// <param name="vertexShader"> The vertex shader to link. </param>
-/// <param name="geometryShader"> The geometry shader to link. Put nullptr to not link one.</param>
-/// <param name="fragmentShader"> The fragment shader to link. </param>
-/// <returns> 0 if a problem occured, the programID otherwise. </returns>
-uint linkShaders(uint id, std::string name, const VertexShader* vertexShader, const GeometryShader* geometryShader, const FragmentShader* fragmentShader);
+/// <param name="path">The path to the shader, for the errors.</param>
+/// <param name="shaderType">The type of the shader: Vertex, Fragment or Geometry.</param>
+/// <returns> 0 if an error occured, the id of the shader otherwise. </returns>
+uint compileShader(constring path, ShaderType shaderType, const std::string& shaderCode);
+
+/// <summary>
+/// Returns whether a shader compiled, waiting for the driver. Prints the error if it didn't.
+/// </summary>
+/// <param name="path">The path to the shader, for the errors.</param>
+bool checkShader(constring path, ShaderType shaderType, uint shader);
+
+/// <summary>
+/// Links compiled stages in a new program, on the thread of the render device.
+/// </summary>
+/// <param name="gShaderID"> The geometry stage, 0 to not link one.</param>
+/// <param name="vertexName"> The names of the stages, for the errors.</param>
+/// <returns> 0 if a problem occured, the program being deleted, the programID otherwise. </returns>
+uint linkProgram(uint vShaderID, uint gShaderID, uint fShaderID, constring vertexName, constring geometryName, constring fragmentName);
 
+/// <summary>
+/// Returns whether a program linked, waiting for the driver. Prints the error and deletes the program
+/// if it didn't.
+/// </summary>
+/// <param name="vertexName"> The names of the stages, for the errors.</param>
+bool checkProgram(uint programID, constring vertexName, constring geometryName, constring fragmentName);
+
+/// <summary>
+/// Submits a shader program to the driver without waiting for it: its' binary from the ShaderCache, or
+/// the compilation of its' stages and their link. Drivers supporting GL_KHR_parallel_shader_compile work
+/// on it while the next programs are submitted. On the thread of the render device.
+/// </summary>
+/// <param name="shader"> Its' id, name and stages must be set.</param>
+void submitShaders(PendingShader& shader);
+
+/// <summary>
+/// Waits for a program from submitShaders(), then makes a Shader of it and caches its' binary if it
+/// linked. Compiles it from its' stages if the driver rejected its' binary. Prints the time it took.
+/// </summary>
+/// <returns> 0 if a problem occured, the programID otherwise. </returns>
+uint finishShaders(PendingShader& shader);
 
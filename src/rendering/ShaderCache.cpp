@@ -0,0 +1,112 @@
+#include "ShaderCache.hpp"
+#include "Loader.hpp"
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+static_assert(std::endian::native == std::endian::little, "Cached programs are little endian");
+
+struct ProgramHeader
+{
+	char magic[4];
+	uint version;
+	uint64 key;      //Also in the file name, checked against collisions of truncated names
+	uint format;     //Of the driver
+	uint size;       //Of the binary, a truncated file is rejected
+};
+
+static const char MAGIC[4] = { 'P', 'X', 'S', 'C' };
+
+/// <summary>
+/// Hashes a string and its' size in an FNV-1a hash, so "ab" + "c" and "a" + "bc" differ.
+/// </summary>
+static void hashString(uint64& hash, const std::string& string)
+{
+	uint64 size = string.size();
+	uint8 sizeBytes[sizeof(size)];
+	for (uint i = 0; i < sizeof(size); i++)
+		sizeBytes[i] = (uint8)(size >> (i * 8));
+	hash = fnv1a(sizeBytes, sizeof(sizeBytes), hash);
+	hash = fnv1a(string.data(), string.size(), hash);
+}
+
+uint64 ShaderCache::key(const std::string& vertex, const std::string& geometry, const std::string& fragment)
+{
+	uint64 hash = FNV_OFFSET_BASIS;
+	hashString(hash, Loader::device->driverIdentity());
+	hashString(hash, vertex);
+	hashString(hash, geometry);
+	hashString(hash, fragment);
+	return hash;
+}
+
+std::string ShaderCache::pathOf(uint64 key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx.pxs", key);
+	return DIRECTORY + std::string(name);
+}
+
+uint ShaderCache::load(uint64 key)
+{
+	std::string path = pathOf(key);
+	std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file)
+		return 0; //Not cached yet
+
+	std::vector<uint8> bytes((size_t)file.tellg());
+	file.seekg(0);
+	ProgramHeader header;
+	bool valid = file.read((char*)bytes.data(), bytes.size()) && bytes.size() >= sizeof(ProgramHeader);
+	if (valid)
+	{
+		memcpy(&header, bytes.data(), sizeof(header));
+		valid = memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION && header.key == key
+			&& header.size == bytes.size() - sizeof(ProgramHeader);
+	}
+	file.close();
+
+	if (!valid)
+	{
+		printf("Ignoring %s: corrupted\n", path.c_str());
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		return 0;
+	}
+
+	IRenderDevice* device = Loader::device;
+	uint program = device->createProgram();
+	device->programBinary(program, header.format, bytes.data() + sizeof(ProgramHeader), header.size);
+	return program;
+}
+
+void ShaderCache::reject(uint64 key)
+{
+	std::string path = pathOf(key);
+	printf("Ignoring %s: rejected by the driver\n", path.c_str());
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
+
+void ShaderCache::save(uint64 key, uint program)
+{
+	ProgramHeader header = {};
+	std::vector<uint8> binary;
+	if (!Loader::device->getProgramBinary(program, header.format, binary))
+		return;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.key = key;
+	header.size = (uint)binary.size();
+
+	std::error_code error;
+	std::filesystem::create_directories(DIRECTORY, error);
+	std::string path = pathOf(key);
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.write((const char*)&header, sizeof(header)) || !file.write((const char*)binary.data(), binary.size()))
+		printf("Couldn't write %s\n", path.c_str());
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+#include <string>
+
+/* Compiling the stages and linking a program can take hundreds of milliseconds per program on some
+ * drivers. Once linked, the binary of a program is written in res/cache/shaders under a key hashing the
+ * sources of its' stages and the identity of the driver. The next launches load it with programBinary()
+ * and only compile the stages when it's not there or the driver rejects it.
+ *
+ * Layout, little endian:
+ *   ProgramHeader
+ *   the binary, in the format of the driver
+ *
+ * Editing a stage or updating the driver changes the key, so the cache is never stale, files of old
+ * versions are left behind. A binary rejected anyway (some drivers don't put all their state in the
+ * identity) is removed, then replaced once the program is linked again.
+ */
+
+/// <summary>
+/// A static class that caches the binaries of the linked programs. See the top of ShaderCache.hpp.
+/// </summary>
+class ShaderCache
+{
+public:
+
+	static constexpr uint VERSION = 1;
+	static constexpr const char* DIRECTORY = "res/cache/shaders";
+
+	/// <summary>
+	/// Returns the key of a program, for the driver of Loader::device.
+	/// </summary>
+	/// <param name="geometry">"" if it has no geometry stage.</param>
+	static uint64 key(const std::string& vertex, const std::string& geometry, const std::string& fragment);
+
+	/// <summary>
+	/// Creates a program from its' cached binary, without waiting for the driver: check it with
+	/// programLinked(), then call reject() if it failed. On the thread of the render device.
+	/// </summary>
+	/// <returns>The program, 0 if it's not cached.</returns>
+	static uint load(uint64 key);
+
+	/// <summary>
+	/// Removes a binary the driver rejected.
+	/// </summary>
+	static void reject(uint64 key);
+
+	/// <summary>
+	/// Writes the binary of a linked program in the cache, if the driver gives one. On the thread of the
+	/// render device.
+	/// </summary>
+	static void save(uint64 key, uint program);
+
+private:
+
+	/// <summary>
+	/// Returns the path of the cached binary of a key.
+	/// </summary>
+	static std::string pathOf(uint64 key);
+};
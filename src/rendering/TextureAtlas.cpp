@@ -0,0 +1,234 @@
+#include "TextureAtlas.hpp"
+#include "TextureStreamer.hpp"
+#include "io/FileIO.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+#pragma region SkylinePacker
+
+SkylinePacker::SkylinePacker(uint width, uint height) :
+	width(width), height(height)
+{
+	skyline.push_back({ 0, 0, width });
+}
+
+bool SkylinePacker::fits(uint segment, uint width, uint height, uint& y) const
+{
+	uint x = skyline[segment].x;
+	if (x + width > this->width)
+		return false;
+
+	//The rectangle lies on the highest segment under it
+	y = 0;
+	uint left = width;
+	for (uint i = segment; left > 0; i++)
+	{
+		y = std::max(y, skyline[i].y);
+		if (y + height > this->height)
+			return false;
+		left -= std::min(left, skyline[i].width);
+	}
+	return true;
+}
+
+bool SkylinePacker::insert(uint width, uint height, uint& x, uint& y)
+{
+	//Lowest top first, the segments go from left to right so the leftmost one wins the ties
+	int best = -1;
+	uint bestY = 0;
+	for (uint i = 0; i < skyline.size(); i++)
+	{
+		uint top;
+		if (fits(i, width, height, top) && (best < 0 || top < bestY))
+		{
+			best = (int)i;
+			bestY = top;
+		}
+	}
+	if (best < 0)
+		return false;
+
+	x = skyline[best].x;
+	y = bestY;
+	usedArea += (uint64)width * height;
+
+	//The new segment replaces the parts of the ones under the rectangle
+	Segment added{ x, y + height, width };
+	uint first = (uint)best;
+	uint last = first;
+	while (last < skyline.size() && skyline[last].x + skyline[last].width <= x + width)
+		last++;
+	if (last < skyline.size() && skyline[last].x < x + width)
+	{
+		uint cut = x + width - skyline[last].x;
+		skyline[last].x += cut;
+		skyline[last].width -= cut;
+	}
+	skyline.erase(skyline.begin() + first, skyline.begin() + last);
+	skyline.insert(skyline.begin() + first, added);
+
+	//Merging the neighbours at the same height
+	for (uint i = 0; i + 1 < skyline.size();)
+	{
+		if (skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else
+			i++;
+	}
+	return true;
+}
+
+#pragma endregion
+
+#pragma region TextureAtlas
+
+TextureAtlas::TextureAtlas(IRenderDevice* device, const AtlasSettings& settings) :
+	settings(settings), device(device) {}
+
+TextureAtlas::~TextureAtlas()
+{
+	std::vector<uint> textures;
+	for (const Page& page : pages)
+		textures.push_back(page.texture);
+	device->deleteTextures(textures);
+}
+
+void TextureAtlas::add(uint id, constring name, constring fileName)
+{
+	Sprite sprite;
+	sprite.id = id;
+	sprite.name = name;
+	sprite.fileName = fileName;
+	sprites.push_back(sprite);
+}
+
+void TextureAtlas::layout()
+{
+	for (Sprite& sprite : sprites)
+		if (!readTextureSize(sprite.fileName, sprite.width, sprite.height))
+			sprite.width = sprite.height = 0; //Gets its' own texture, the streamer reports the error
+
+	//Tallest first, the skyline stays flat longer
+	std::vector<uint> order(sprites.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [this](uint a, uint b)
+	{
+		return sprites[a].height != sprites[b].height ? sprites[a].height > sprites[b].height : sprites[a].width > sprites[b].width;
+	});
+
+	std::vector<SkylinePacker> packers;
+	const uint padding = settings.padding;
+	for (uint i : order)
+	{
+		Sprite& sprite = sprites[i];
+		uint width = sprite.width + 2 * padding;
+		uint height = sprite.height + 2 * padding;
+		if (sprite.width == 0 || width > settings.pageSize || height > settings.pageSize)
+			continue;
+
+		uint x, y;
+		for (uint page = 0; page < settings.maxPages && sprite.page < 0; page++)
+		{
+			if (page == packers.size())
+				packers.emplace_back(settings.pageSize, settings.pageSize);
+			if (packers[page].insert(width, height, x, y))
+			{
+				sprite.page = (int)page;
+				sprite.x = x + padding;
+				sprite.y = y + padding;
+			}
+		}
+	}
+
+	pages.resize(packers.size());
+	for (uint i = 0; i < packers.size(); i++)
+		pages[i].occupancy = packers[i].occupancy();
+}
+
+void TextureAtlas::request(TextureStreamer& streamer)
+{
+	//Pages start transparent, sprites appear as they're streamed in
+	std::vector<uint8> clear((size_t)settings.pageSize * settings.pageSize * 4, 0);
+	for (Page& page : pages)
+	{
+		page.texture = device->createTexture();
+		device->bindTexture(0, page.texture);
+		device->textureImage2D(settings.pageSize, settings.pageSize, PixelFormat::RGBA, clear.data(), true);
+	}
+
+	streamer.done = [this](uint texture) { spriteDone(texture); };
+
+	const float scale = 1.0f / settings.pageSize;
+	for (Sprite& sprite : sprites)
+	{
+		if (sprite.page < 0)
+		{
+			sprite.texture = streamer.request(sprite.id, sprite.name, sprite.fileName)->textureID;
+			continue;
+		}
+
+		Page& page = pages[sprite.page];
+		sprite.texture = page.texture;
+		glm::vec4 uvRect(sprite.x * scale, sprite.y * scale, sprite.width * scale, sprite.height * scale);
+		new Texture(sprite.id, sprite.name, page.texture, sprite.page, uvRect); //Adds itself to the static list of Textures
+		streamer.requestRegion(page.texture, sprite.fileName, sprite.x, sprite.y, settings.padding);
+		page.pending++;
+	}
+}
+
+std::vector<uint> TextureAtlas::reload(constring fileName, TextureStreamer& streamer)
+{
+	std::vector<uint> reloaded;
+	for (const Sprite& sprite : sprites)
+	{
+		if (sprite.fileName != fileName || sprite.texture == 0)
+			continue;
+		if (sprite.page < 0)
+		{
+			streamer.reload(sprite.texture, fileName);
+			reloaded.push_back(sprite.texture);
+			continue;
+		}
+
+		int width, height;
+		if (!readTextureSize(fileName, width, height) || width != sprite.width || height != sprite.height)
+		{
+			printf("%s changed size, restart to pack it again\n", fileName.c_str());
+			continue;
+		}
+		streamer.requestRegion(sprite.texture, fileName, sprite.x, sprite.y, settings.padding);
+		pages[sprite.page].pending++; //Its' mipmaps are computed again once the sprite arrived
+		reloaded.push_back(sprite.texture);
+	}
+	return reloaded;
+}
+
+void TextureAtlas::spriteDone(uint texture)
+{
+	for (Page& page : pages)
+		if (page.texture == texture && page.pending > 0 && --page.pending == 0)
+		{
+			device->bindTexture(0, page.texture);
+			device->generateMipmaps();
+		}
+}
+
+void TextureAtlas::printStats() const
+{
+	uint packed = 0;
+	for (const Sprite& sprite : sprites)
+		if (sprite.page >= 0)
+			packed++;
+
+	printf("Packed %u/%u sprites in %u pages of %upx:", packed, (uint)sprites.size(), (uint)pages.size(), settings.pageSize);
+	for (const Page& page : pages)
+		printf(" %.0f%%", page.occupancy * 100);
+	printf("\n");
+}
+
+#pragma endregion
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "rendering/Model.hpp"
+#include "rendering/RenderDevice.hpp"
+
+#include <string>
+#include <vector>
+
+class TextureStreamer;
+
+/* The TextureAtlas packs the sprites of res/textures in a few large textures, the pages, so sprites
+ * drawn with the same shader and material end up in the same batch whatever their texture.
+ *
+ * layout() reads the size of every sprite from the header of its' file, then packs them from the
+ * tallest to the shortest with a SkylinePacker, page after page. Each sprite is surrounded by padding
+ * pixels repeating its' border, so the linear filtering and the first mipmaps never read a neighbour.
+ * Sprites too large for a page, or left over once every page is full, get their own texture.
+ *
+ * request() creates the pages and the Texture of every sprite: its' texture is the page, and its' uvRect
+ * the region of the page it occupies. The pixels are streamed in by the TextureStreamer, and the mipmaps
+ * of a page are computed once its' last sprite arrived.
+ */
+
+/// <summary>
+/// Packs rectangles in a fixed size area with the skyline bottom-left heuristic: the top of the packed
+/// rectangles is kept as a list of horizontal segments, and each rectangle goes where its' top is the
+/// lowest, then the leftmost.
+/// </summary>
+class SkylinePacker
+{
+public:
+
+	SkylinePacker(uint width, uint height);
+
+	/// <summary>
+	/// Finds room for a rectangle and marks it as used.
+	/// </summary>
+	/// <returns>false if it doesn't fit anywhere.</returns>
+	bool insert(uint width, uint height, uint& x, uint& y);
+
+	/// <summary>
+	/// Returns the fraction of the area used by the rectangles.
+	/// </summary>
+	float occupancy() const { return (float)((double)usedArea / ((double)width * height)); }
+
+private:
+
+	/// <summary>
+	/// A horizontal segment of the skyline, from x to x + width at the height y.
+	/// </summary>
+	struct Segment
+	{
+		uint x, y, width;
+	};
+
+	uint width, height;
+	uint64 usedArea = 0;
+	std::vector<Segment> skyline; //From left to right, covering the whole width
+
+	/// <summary>
+	/// Returns the height the rectangle would lie at if its' left was at the segment, or false if it
+	/// would stick out of the area.
+	/// </summary>
+	bool fits(uint segment, uint width, uint height, uint& y) const;
+};
+
+/// <summary>
+/// The tuning of a TextureAtlas.
+/// </summary>
+struct AtlasSettings
+{
+	uint pageSize = 2048;  //Width and height of the pages, in pixels
+	uint maxPages = 4;     //Sprites left over once they're full get their own texture
+	uint padding = 2;      //Pixels repeating the border of every sprite, on each side
+};
+
+/// <summary>
+/// Packs the sprites in shared textures. See the top of TextureAtlas.hpp.
+/// </summary>
+class TextureAtlas
+{
+public:
+
+	AtlasSettings settings;
+
+	TextureAtlas(IRenderDevice* device, const AtlasSettings& settings = AtlasSettings());
+
+	/// <summary>
+	/// Deletes the pages.
+	/// </summary>
+	~TextureAtlas();
+
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	/// <summary>
+	/// Adds a sprite to pack.
+	/// </summary>
+	/// <param name="fileName">Relative file name from res/textures.</param>
+	void add(uint id, constring name, constring fileName);
+
+	/// <summary>
+	/// Reads the size of the sprites and packs them. Doesn't touch the device, any thread can call it.
+	/// </summary>
+	void layout();
+
+	/// <summary>
+	/// Creates the pages and the Textures of the sprites in the order they were added, and streams their
+	/// pixels. On the render thread, once layout() returned.
+	/// </summary>
+	void request(TextureStreamer& streamer);
+
+	/// <summary>
+	/// Streams the pixels of the sprites of a file again, in their texture or their region of a page.
+	/// Sprites whose size changed are skipped, they would need to be packed again.
+	/// </summary>
+	/// <param name="fileName">Relative file name from res/textures.</param>
+	/// <returns>The textures reloaded, pages or textures of their own.</returns>
+	std::vector<uint> reload(constring fileName, TextureStreamer& streamer);
+
+	/// <summary>
+	/// Returns the number of pages used.
+	/// </summary>
+	uint pageCount() const { return (uint)pages.size(); }
+
+	/// <summary>
+	/// Prints the number of sprites packed and the occupancy of the pages.
+	/// </summary>
+	void printStats() const;
+
+private:
+
+	/// <summary>
+	/// A sprite and its' place in the pages.
+	/// </summary>
+	struct Sprite
+	{
+		uint id;
+		std::string name;
+		std::string fileName;
+		int width = 0, height = 0;
+		int page = -1;    //-1 if it has its' own texture
+		uint x = 0, y = 0; //Padding excluded
+		uint texture = 0;  //Its' own texture or the page, once requested
+	};
+
+	/// <summary>
+	/// A page and the number of its' sprites still streaming.
+	/// </summary>
+	struct Page
+	{
+		uint texture = 0;
+		uint pending = 0;
+		float occupancy = 0;
+	};
+
+	IRenderDevice* device;
+	std::vector<Sprite> sprites;
+	std::vector<Page> pages;
+
+	/// <summary>
+	/// Called when a sprite of a page arrived, computes the mipmaps of the page after its' last one.
+	/// </summary>
+	void spriteDone(uint texture);
+};
@@ -0,0 +1,379 @@
+#include "TextureCompression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#pragma region Mip chain
+
+static float toLinear(uint8 value)
+{
+	static const std::array<float, 256> table = []()
+	{
+		std::array<float, 256> table;
+		for (uint i = 0; i < 256; i++)
+		{
+			float s = i / 255.0f;
+			table[i] = s <= 0.04045f ? s / 12.92f : std::pow((s + 0.055f) / 1.055f, 2.4f);
+		}
+		return table;
+	}();
+	return table[value];
+}
+
+static uint8 toSRGB(float linear)
+{
+	linear = std::clamp(linear, 0.0f, 1.0f);
+	float s = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1 / 2.4f) - 0.055f;
+	return (uint8)(s * 255 + 0.5f);
+}
+
+/// <summary>
+/// A pixel of the previous level and its' weight in a pixel of the next one.
+/// </summary>
+struct Tap
+{
+	uint index;
+	float weight;
+};
+
+/// <summary>
+/// Returns the taps of every pixel of the next level along an axis, for a tent filter two pixels of
+/// the previous level wide. Pixels past the edges repeat the edge ones.
+/// </summary>
+static std::vector<std::vector<Tap>> filterTaps(uint size, uint nextSize)
+{
+	float ratio = (float)size / nextSize;
+	std::vector<std::vector<Tap>> taps(nextSize);
+	for (uint i = 0; i < nextSize; i++)
+	{
+		float center = (i + 0.5f) * ratio - 0.5f; //In pixels of the previous level
+		float total = 0;
+		for (int s = (int)std::ceil(center - ratio); s <= (int)std::floor(center + ratio); s++)
+		{
+			float weight = 1 - std::abs(s - center) / ratio;
+			if (weight <= 0)
+				continue;
+			taps[i].push_back({ (uint)std::clamp(s, 0, (int)size - 1), weight });
+			total += weight;
+		}
+		for (Tap& tap : taps[i])
+			tap.weight /= total;
+	}
+	return taps;
+}
+
+std::vector<MipLevel> buildMipChain(const uint8* pixels, uint width, uint height)
+{
+	//Linear colors premultiplied by alpha, the transparent pixels don't bleed in the visible ones
+	std::vector<float> current((size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		float alpha = pixels[i * 4 + 3] / 255.0f;
+		for (uint c = 0; c < 3; c++)
+			current[i * 4 + c] = toLinear(pixels[i * 4 + c]) * alpha;
+		current[i * 4 + 3] = alpha;
+	}
+
+	std::vector<MipLevel> levels;
+	std::vector<float> rows, next;
+	while (width > 1 || height > 1)
+	{
+		uint nextWidth = std::max(width / 2, 1u);
+		uint nextHeight = std::max(height / 2, 1u);
+		std::vector<std::vector<Tap>> xTaps = filterTaps(width, nextWidth);
+		std::vector<std::vector<Tap>> yTaps = filterTaps(height, nextHeight);
+
+		//Separable, the rows first
+		rows.assign((size_t)nextWidth * height * 4, 0);
+		for (uint y = 0; y < height; y++)
+			for (uint x = 0; x < nextWidth; x++)
+			{
+				float* out = &rows[((size_t)y * nextWidth + x) * 4];
+				for (const Tap& tap : xTaps[x])
+				{
+					const float* in = &current[((size_t)y * width + tap.index) * 4];
+					for (uint c = 0; c < 4; c++)
+						out[c] += in[c] * tap.weight;
+				}
+			}
+
+		next.assign((size_t)nextWidth * nextHeight * 4, 0);
+		for (uint y = 0; y < nextHeight; y++)
+			for (const Tap& tap : yTaps[y])
+			{
+				const float* in = &rows[(size_t)tap.index * nextWidth * 4];
+				float* out = &next[(size_t)y * nextWidth * 4];
+				for (uint i = 0; i < nextWidth * 4; i++)
+					out[i] += in[i] * tap.weight;
+			}
+
+		MipLevel level{ nextWidth, nextHeight, std::vector<uint8>((size_t)nextWidth * nextHeight * 4) };
+		for (size_t i = 0; i < (size_t)nextWidth * nextHeight; i++)
+		{
+			float alpha = next[i * 4 + 3];
+			for (uint c = 0; c < 3; c++)
+				level.pixels[i * 4 + c] = alpha > 0 ? toSRGB(next[i * 4 + c] / alpha) : 0;
+			level.pixels[i * 4 + 3] = (uint8)(std::clamp(alpha, 0.0f, 1.0f) * 255 + 0.5f);
+		}
+		levels.push_back(std::move(level));
+
+		current.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+	return levels;
+}
+
+#pragma endregion
+
+#pragma region Block compression
+
+static uint16 pack565(const float color[3])
+{
+	uint r = (uint)std::clamp((int)std::lround(color[0] * 31 / 255), 0, 31);
+	uint g = (uint)std::clamp((int)std::lround(color[1] * 63 / 255), 0, 63);
+	uint b = (uint)std::clamp((int)std::lround(color[2] * 31 / 255), 0, 31);
+	return (uint16)((r << 11) | (g << 5) | b);
+}
+
+static void unpack565(uint16 packed, float color[3])
+{
+	uint r = packed >> 11 & 31;
+	uint g = packed >> 5 & 63;
+	uint b = packed & 31;
+	color[0] = (float)((r << 3) | (r >> 2));
+	color[1] = (float)((g << 2) | (g >> 4));
+	color[2] = (float)((b << 3) | (b >> 2));
+}
+
+/// <summary>
+/// The endpoints of a BC1 color block and the index of each pixel in their palette.
+/// </summary>
+struct ColorFit
+{
+	uint16 color0, color1;
+	uint8 indices[16];
+	float error;
+};
+
+/// <summary>
+/// Chooses the nearest color of the palette of the endpoints for every used pixel.
+/// </summary>
+static ColorFit fitIndices(const float colors[16][3], const bool used[16], uint16 color0, uint16 color1)
+{
+	//The 4 colors palette requires color0 > color1, in BC1 the other order means 3 colors and black
+	ColorFit fit{ std::max(color0, color1), std::min(color0, color1), {}, 0 };
+	float palette[4][3];
+	unpack565(fit.color0, palette[0]);
+	unpack565(fit.color1, palette[1]);
+	for (uint c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+	uint paletteSize = fit.color0 == fit.color1 ? 1 : 4; //Equal endpoints, only index 0 is the same color in both modes
+
+	for (uint i = 0; i < 16; i++)
+	{
+		if (!used[i])
+			continue;
+		float best = 1e30f;
+		for (uint p = 0; p < paletteSize; p++)
+		{
+			float d0 = colors[i][0] - palette[p][0], d1 = colors[i][1] - palette[p][1], d2 = colors[i][2] - palette[p][2];
+			float distance = d0 * d0 + d1 * d1 + d2 * d2;
+			if (distance < best)
+			{
+				best = distance;
+				fit.indices[i] = (uint8)p;
+			}
+		}
+		fit.error += best;
+	}
+	return fit;
+}
+
+/// <summary>
+/// Compresses the colors of a block of 4x4 RGBA pixels in 8 bytes of BC1.
+/// </summary>
+/// <param name="used">Whether the color of each pixel matters, at least one must.</param>
+static void compressColors(const uint8 block[64], const bool used[16], uint8* out)
+{
+	float colors[16][3];
+	float mean[3] = {};
+	uint count = 0;
+	for (uint i = 0; i < 16; i++)
+	{
+		for (uint c = 0; c < 3; c++)
+			colors[i][c] = block[i * 4 + c];
+		if (used[i])
+		{
+			for (uint c = 0; c < 3; c++)
+				mean[c] += colors[i][c];
+			count++;
+		}
+	}
+	for (uint c = 0; c < 3; c++)
+		mean[c] /= count;
+
+	//The principal axis of the colors, by power iteration on their covariance
+	float covariance[3][3] = {};
+	for (uint i = 0; i < 16; i++)
+		if (used[i])
+			for (uint a = 0; a < 3; a++)
+				for (uint b = 0; b < 3; b++)
+					covariance[a][b] += (colors[i][a] - mean[a]) * (colors[i][b] - mean[b]);
+	float axis[3] = { 1, 1, 1 };
+	for (uint iteration = 0; iteration < 8; iteration++)
+	{
+		float next[3];
+		for (uint a = 0; a < 3; a++)
+			next[a] = covariance[a][0] * axis[0] + covariance[a][1] * axis[1] + covariance[a][2] * axis[2];
+		float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+		if (length == 0)
+			break; //A single color, the endpoints are the mean
+		for (uint a = 0; a < 3; a++)
+			axis[a] = next[a] / length;
+	}
+
+	//The extreme projections, inset by 1/16 of their distance since the ends are rarely the best choice
+	float low = 1e30f, high = -1e30f;
+	for (uint i = 0; i < 16; i++)
+		if (used[i])
+		{
+			float projection = (colors[i][0] - mean[0]) * axis[0] + (colors[i][1] - mean[1]) * axis[1] + (colors[i][2] - mean[2]) * axis[2];
+			low = std::min(low, projection);
+			high = std::max(high, projection);
+		}
+	float inset = (high - low) / 16;
+	float end0[3], end1[3];
+	for (uint c = 0; c < 3; c++)
+	{
+		end0[c] = mean[c] + axis[c] * (high - inset);
+		end1[c] = mean[c] + axis[c] * (low + inset);
+	}
+	ColorFit best = fitIndices(colors, used, pack565(end0), pack565(end1));
+
+	//Least squares endpoints for the chosen indices
+	static const float WEIGHTS[4] = { 1, 0, 2 / 3.0f, 1 / 3.0f }; //Of color0 in each palette entry
+	for (uint iteration = 0; iteration < 2 && best.error > 0 && best.color0 != best.color1; iteration++)
+	{
+		float aa = 0, ab = 0, bb = 0;
+		float ax[3] = {}, bx[3] = {};
+		for (uint i = 0; i < 16; i++)
+		{
+			if (!used[i])
+				continue;
+			float a = WEIGHTS[best.indices[i]], b = 1 - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (uint c = 0; c < 3; c++)
+			{
+				ax[c] += a * colors[i][c];
+				bx[c] += b * colors[i][c];
+			}
+		}
+		float determinant = aa * bb - ab * ab;
+		if (std::abs(determinant) < 1e-6f)
+			break;
+		for (uint c = 0; c < 3; c++)
+		{
+			end0[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+			end1[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+		}
+		ColorFit fit = fitIndices(colors, used, pack565(end0), pack565(end1));
+		if (fit.error >= best.error)
+			break;
+		best = fit;
+	}
+
+	uint indices = 0;
+	for (uint i = 0; i < 16; i++)
+		indices |= (uint)best.indices[i] << (2 * i);
+	out[0] = (uint8)(best.color0 & 0xFF);
+	out[1] = (uint8)(best.color0 >> 8);
+	out[2] = (uint8)(best.color1 & 0xFF);
+	out[3] = (uint8)(best.color1 >> 8);
+	for (uint b = 0; b < 4; b++)
+		out[4 + b] = (uint8)(indices >> (8 * b));
+}
+
+/// <summary>
+/// Compresses the alpha of a block of 4x4 RGBA pixels in the 8 first bytes of BC3.
+/// </summary>
+static void compressAlpha(const uint8 block[64], uint8* out)
+{
+	uint8 alpha0 = 0, alpha1 = 255;
+	for (uint i = 0; i < 16; i++)
+	{
+		alpha0 = std::max(alpha0, block[i * 4 + 3]);
+		alpha1 = std::min(alpha1, block[i * 4 + 3]);
+	}
+
+	//alpha0 > alpha1 selects the 8 values palette: the endpoints, then 6 values from alpha0 to alpha1
+	float palette[8] = { (float)alpha0, (float)alpha1 };
+	for (uint p = 1; p < 7; p++)
+		palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7.0f;
+
+	uint64 indices = 0;
+	if (alpha0 != alpha1)
+		for (uint i = 0; i < 16; i++)
+		{
+			uint best = 0;
+			for (uint p = 1; p < 8; p++)
+				if (std::abs(palette[p] - block[i * 4 + 3]) < std::abs(palette[best] - block[i * 4 + 3]))
+					best = p;
+			indices |= (uint64)best << (3 * i);
+		}
+
+	out[0] = alpha0;
+	out[1] = alpha1;
+	for (uint b = 0; b < 6; b++)
+		out[2 + b] = (uint8)(indices >> (8 * b));
+}
+
+CompressedFormat chooseCompressedFormat(const uint8* pixels, uint width, uint height)
+{
+	for (size_t i = 0; i < (size_t)width * height; i++)
+		if (pixels[i * 4 + 3] != 255)
+			return CompressedFormat::BC3;
+	return CompressedFormat::BC1;
+}
+
+void compressImage(const uint8* pixels, uint width, uint height, CompressedFormat format, uint8* out)
+{
+	uint8 block[64];
+	bool used[16];
+	for (uint blockY = 0; blockY < height; blockY += 4)
+		for (uint blockX = 0; blockX < width; blockX += 4)
+		{
+			for (uint y = 0; y < 4; y++)
+				for (uint x = 0; x < 4; x++)
+				{
+					size_t pixel = (size_t)std::min(blockY + y, height - 1) * width + std::min(blockX + x, width - 1);
+					memcpy(block + (y * 4 + x) * 4, pixels + pixel * 4, 4);
+				}
+
+			if (format == CompressedFormat::BC1)
+			{
+				std::fill(used, used + 16, true);
+				compressColors(block, used, out);
+				out += 8;
+				continue;
+			}
+
+			compressAlpha(block, out);
+			bool visible = false;
+			for (uint i = 0; i < 16; i++)
+				visible |= used[i] = block[i * 4 + 3] > 0;
+			if (!visible)
+				std::fill(used, used + 16, true);
+			compressColors(block, used, out + 8);
+			out += 16;
+		}
+}
+
+#pragma endregion
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "rendering/RenderDevice.hpp"
+
+#include <vector>
+
+/* CPU side preparation of the textures uploaded compressed, see TextureCache.hpp.
+ *
+ * The mip chain is filtered in linear light with colors weighted by their alpha, so the smaller levels
+ * don't get darker, nor pick the color of the transparent pixels around the sprites. Each level is
+ * computed from the unquantized previous one with a tent filter two pixels of the previous level wide,
+ * the [1 3 3 1] filter for even sizes.
+ *
+ * The blocks are compressed with a principal axis fit of the endpoints, refined by least squares on
+ * the chosen indices. The colors of the fully transparent pixels of BC3 blocks are ignored.
+ */
+
+/// <summary>
+/// A level of a mip chain, RGBA pixels.
+/// </summary>
+struct MipLevel
+{
+	uint width, height;
+	std::vector<uint8> pixels;
+};
+
+/// <summary>
+/// Computes the levels of the mip chain of an RGBA image, from half its' size down to 1x1. The image
+/// itself isn't copied in the result.
+/// </summary>
+std::vector<MipLevel> buildMipChain(const uint8* pixels, uint width, uint height);
+
+/// <summary>
+/// Returns BC1 if every pixel of the RGBA image is opaque, BC3 otherwise.
+/// </summary>
+CompressedFormat chooseCompressedFormat(const uint8* pixels, uint width, uint height);
+
+/// <summary>
+/// Compresses an RGBA image. The blocks on the right and bottom edges repeat the last pixels.
+/// </summary>
+/// <param name="out">Receives compressedSize(format, width, height) bytes.</param>
+void compressImage(const uint8* pixels, uint width, uint height, CompressedFormat format, uint8* out);
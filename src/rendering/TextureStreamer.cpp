@@ -0,0 +1,301 @@
+#include "TextureStreamer.hpp"
+#include "Loader.hpp"
+#include "io/FileIO.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static const uint8 PLACEHOLDER[4] = { 255, 255, 255, 255 };
+
+static double msSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+TextureStreamer::TextureStreamer(IRenderDevice* device, const TextureStreamSettings& settings) :
+	settings(settings), device(device)
+{
+	for (uint i = 0; i < settings.ringBuffers; i++)
+	{
+		RingBuffer buffer;
+		buffer.buffer = device->createBuffer();
+		device->bindBuffer(BufferTarget::PIXEL_UNPACK_BUFFER, buffer.buffer);
+		device->bufferData(BufferTarget::PIXEL_UNPACK_BUFFER, nullptr, settings.bufferSize, BufferUsage::STREAM_DRAW);
+		ring.push_back(buffer);
+	}
+	device->bindBuffer(BufferTarget::PIXEL_UNPACK_BUFFER, 0);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	JobSystem::wait(jobs);
+	collect();
+	for (DecodedImage& image : ready)
+		free(image);
+
+	std::vector<uint> buffers;
+	for (RingBuffer& buffer : ring)
+	{
+		if (buffer.fence != 0)
+			device->deleteFence(buffer.fence);
+		buffers.push_back(buffer.buffer);
+	}
+	device->deleteBuffers(buffers);
+}
+
+Texture* TextureStreamer::request(uint id, constring name, constring fileName)
+{
+	Texture* texture = Loader::loadTexture(id, name, (uint8*)PLACEHOLDER, 1, 1, 4);
+	waiting.push_back({ texture->textureID, fileName });
+	stats.requested++;
+	startDecodes();
+	return texture;
+}
+
+void TextureStreamer::reload(uint texture, constring fileName)
+{
+	waiting.push_back({ texture, fileName });
+	stats.requested++;
+	startDecodes();
+}
+
+void TextureStreamer::requestRegion(uint texture, constring fileName, uint x, uint y, uint padding)
+{
+	Request request{ texture, fileName, true, x - padding, y - padding, padding };
+	waiting.push_back(request);
+	stats.requested++;
+	startDecodes();
+}
+
+/// <summary>
+/// Copies an RGBA image in the middle of a larger one, repeating its' border pixels on padding pixels
+/// around it, so the filtering of the border pixels of a region doesn't read its' neighbours.
+/// </summary>
+/// <returns>The padded image, allocated with new[].</returns>
+static uint8* extrude(const uint8* pixels, int width, int height, uint padding)
+{
+	int paddedWidth = width + 2 * padding;
+	int paddedHeight = height + 2 * padding;
+	uint* padded = (uint*)new uint8[(size_t)paddedWidth * paddedHeight * 4];
+	const uint* source = (const uint*)pixels;
+
+	for (int y = 0; y < paddedHeight; y++)
+	{
+		const uint* row = source + (size_t)std::clamp(y - (int)padding, 0, height - 1) * width;
+		uint* out = padded + (size_t)y * paddedWidth;
+		for (uint x = 0; x < padding; x++)
+		{
+			out[x] = row[0];
+			out[paddedWidth - 1 - x] = row[width - 1];
+		}
+		memcpy(out + padding, row, (size_t)width * 4);
+	}
+	return (uint8*)padded;
+}
+
+TextureStreamer::DecodedImage TextureStreamer::decode(const Request& request, bool compress)
+{
+	Clock::time_point start = Clock::now();
+	DecodedImage image{ request, nullptr, 0, 0, 0, 0, {}, false };
+	if (compress && !request.region)
+	{
+		if (!TextureCache::load(request.fileName, image.compressed, image.cached))
+			image.compressed = CompressedTexture();
+		image.decodeMs = msSince(start);
+		return image;
+	}
+
+	image.data = decodeTexture(request.fileName, image.width, image.height, image.channels, request.region ? 4 : 0);
+	if (request.region && image.data != nullptr)
+	{
+		uint8* padded = extrude(image.data, image.width, image.height, request.padding);
+		freeTexture(image.data);
+		image.data = padded;
+		image.width += 2 * request.padding;
+		image.height += 2 * request.padding;
+	}
+	image.decodeMs = msSince(start);
+	return image;
+}
+
+void TextureStreamer::free(DecodedImage& image)
+{
+	image.compressed = CompressedTexture();
+	if (image.request.region)
+		delete[] image.data;
+	else
+		freeTexture(image.data);
+	image.data = nullptr;
+}
+
+void TextureStreamer::startDecodes()
+{
+	while (!waiting.empty() && decoding + ready.size() < settings.maxDecoded)
+	{
+		Request request = std::move(waiting.front());
+		waiting.pop_front();
+		decoding++;
+
+		JobSystem::run([this, request, compress = settings.compress]()
+		{
+			DecodedImage image = decode(request, compress);
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			decoded.push_back(std::move(image));
+		}, &jobs);
+	}
+}
+
+void TextureStreamer::collect()
+{
+	std::vector<uint> failed;
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		for (DecodedImage& image : decoded)
+		{
+			decoding--;
+			stats.decodeMs += image.decodeMs;
+			if (image.decoded())
+			{
+				if (!image.compressed.empty())
+					(image.cached ? stats.cacheHits : stats.cacheMisses)++;
+				ready.push_back(std::move(image));
+			}
+			else
+			{
+				stats.failed++; //The error was printed by decodeTexture() or the TextureCache
+				failed.push_back(image.request.texture);
+			}
+		}
+		decoded.clear();
+	}
+
+	//Outside of the lock, the callback may take its' time
+	if (done)
+		for (uint texture : failed)
+			done(texture);
+}
+
+/// <summary>
+/// Uploads every level of a compressed mip chain. With a PIXEL_UNPACK_BUFFER bound, data is an offset in it.
+/// </summary>
+static void uploadLevels(IRenderDevice* device, const CompressedTexture& texture, const uint8* data)
+{
+	uint count = (uint)texture.levels.size();
+	for (uint i = 0; i < count; i++)
+	{
+		const CompressedTexture::Level& level = texture.levels[i];
+		device->compressedTextureImage2D(i, count, level.width, level.height, texture.format, data + level.offset, level.size);
+	}
+}
+
+bool TextureStreamer::upload(DecodedImage& image)
+{
+	const CompressedTexture& compressed = image.compressed;
+	const uint8* pixels = compressed.empty() ? image.data : compressed.data.data();
+	size_t size = compressed.empty() ? (size_t)image.width * image.height * image.channels : compressed.data.size();
+	RingBuffer* buffer = size <= settings.bufferSize && !ring.empty() ? &ring[nextBuffer] : nullptr;
+	if (buffer != nullptr && buffer->fence != 0)
+	{
+		if (!device->fenceSignaled(buffer->fence))
+			return false; //The GPU is still reading the oldest buffer, every other one is busy too
+		device->deleteFence(buffer->fence);
+		buffer->fence = 0;
+	}
+
+	const Request& request = image.request;
+	PixelFormat format = pixelFormatOf(image.channels);
+	device->bindTexture(0, request.texture);
+	uint8* memory = nullptr;
+	if (buffer != nullptr)
+	{
+		device->bindBuffer(BufferTarget::PIXEL_UNPACK_BUFFER, buffer->buffer);
+		memory = (uint8*)device->mapBuffer(BufferTarget::PIXEL_UNPACK_BUFFER, size);
+		if (memory != nullptr)
+		{
+			memcpy(memory, pixels, size);
+			if (!device->unmapBuffer(BufferTarget::PIXEL_UNPACK_BUFFER))
+				memory = nullptr; //Lost, uploaded from memory below
+			else if (!compressed.empty())
+				uploadLevels(device, compressed, nullptr);
+			else if (request.region)
+				device->textureSubImage2D(request.x, request.y, image.width, image.height, format, nullptr);
+			else
+				device->textureImage2D(image.width, image.height, format, nullptr, settings.mipmaps);
+		}
+		device->bindBuffer(BufferTarget::PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	if (memory != nullptr)
+	{
+		buffer->fence = device->createFence();
+		nextBuffer = (nextBuffer + 1) % (uint)ring.size();
+	}
+	else
+	{
+		if (!compressed.empty())
+			uploadLevels(device, compressed, compressed.data.data());
+		else if (request.region)
+			device->textureSubImage2D(request.x, request.y, image.width, image.height, format, image.data);
+		else
+			device->textureImage2D(image.width, image.height, format, image.data, settings.mipmaps);
+		stats.directUploads++;
+	}
+
+	free(image);
+	stats.uploaded++;
+	stats.bytes += size;
+	if (done)
+		done(request.texture);
+	return true;
+}
+
+void TextureStreamer::update()
+{
+	collect();
+
+	//At least one upload per frame, so a budget too small for an image can't stall the streaming
+	Clock::time_point start = Clock::now();
+	double frameMs = 0;
+	while (!ready.empty() && (frameMs == 0 || frameMs < settings.uploadMsPerFrame))
+	{
+		if (!upload(ready.front()))
+		{
+			stats.ringStalls++;
+			break;
+		}
+		ready.pop_front();
+		frameMs = std::max(msSince(start), 1e-6);
+	}
+	stats.uploadMs += frameMs;
+	stats.maxFrameMs = std::max(stats.maxFrameMs, frameMs);
+
+	startDecodes();
+
+	//Without other workers, the jobs only progress when the render thread executes them
+	if (JobSystem::workerCount() == 1)
+	{
+		Clock::time_point jobsStart = Clock::now();
+		while (msSince(jobsStart) < settings.mainThreadMs && JobSystem::tryExecute());
+	}
+}
+
+void TextureStreamer::flush()
+{
+	while (pendingCount() > 0)
+	{
+		update();
+		if (ready.empty() && !JobSystem::tryExecute())
+			std::this_thread::yield();
+	}
+}
+
+void TextureStreamer::printStats() const
+{
+	printf("Streamed %u/%u textures (%u failed, %u too large for the ring), %.2f MB\n", stats.uploaded, stats.requested,
+		stats.failed, stats.directUploads, stats.bytes / (1024.0 * 1024.0));
+	printf("  decode %.2f ms on the workers, upload %.2f ms on the render thread, max %.2f ms per frame, %u waits for the ring\n",
+		stats.decodeMs, stats.uploadMs, stats.maxFrameMs, stats.ringStalls);
+	if (stats.cacheHits + stats.cacheMisses > 0)
+		printf("  %u compressed textures read from the cache, %u compressed and cached\n", stats.cacheHits, stats.cacheMisses);
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "rendering/Model.hpp"
+#include "rendering/RenderDevice.hpp"
+#include "jobs/JobSystem.hpp"
+#include "io/TextureCache.hpp"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* The TextureStreamer loads textures without blocking the render thread.
+ *
+ * request() creates the Texture at once, with a 1x1 white placeholder, so it can be used right away.
+ * Its' file is decoded by a job. At most maxDecoded images are decoding or waiting for their upload,
+ * which bounds the memory used by the decoded pixels; the other requests wait for their turn.
+ *
+ * update() is called once per frame by the render thread and uploads the decoded images for at most
+ * uploadMsPerFrame. Without other workers, it also executes the decode jobs for at most mainThreadMs. Each image is copied in the next buffer of a ring of pixel unpack buffers and the
+ * texture is specified from that buffer, so the driver copies it to the GPU asynchronously. A fence is
+ * inserted after the upload, the buffer is reused once the GPU has passed it. Images larger than a
+ * buffer are uploaded from memory.
+ *
+ * With compress, the jobs get the compressed mip chains of the textures from the TextureCache instead
+ * of decoding them, and every level is uploaded through the same ring.
+ *
+ * requestRegion() loads a file into a region of an existing texture instead, an atlas page (see
+ * TextureAtlas.hpp): the image is converted to RGBA and its' border pixels are extruded by the job.
+ *
+ * Only the render thread calls the streamer.
+ */
+
+/// <summary>
+/// The tuning of a TextureStreamer.
+/// </summary>
+struct TextureStreamSettings
+{
+	uint maxDecoded = 16;              //Images decoding or waiting for their upload
+	uint ringBuffers = 4;              //Pixel unpack buffers of the ring
+	size_t bufferSize = 4 << 20;       //Bytes of each buffer, a 1024x1024 RGBA image
+	float uploadMsPerFrame = 2;        //Time the render thread spends uploading per frame
+	float mainThreadMs = 4;            //Time the render thread spends executing jobs per frame when it's the only worker
+	bool mipmaps = true;
+	bool compress = true;              //Uploads compressed mip chains from the TextureCache, atlas regions excepted
+};
+
+/// <summary>
+/// What a TextureStreamer did since its' creation.
+/// </summary>
+struct TextureStreamStats
+{
+	uint requested = 0;
+	uint uploaded = 0;
+	uint failed = 0;            //Couldn't be decoded, they keep the placeholder
+	uint directUploads = 0;     //Too large for the ring
+	uint64 bytes = 0;           //Bytes uploaded, decoded or compressed
+	double decodeMs = 0;        //Total time spent decoding, by all the workers
+	double uploadMs = 0;        //Total time spent uploading, by the render thread
+	double maxFrameMs = 0;      //Longest time spent uploading in a frame
+	uint ringStalls = 0;        //Updates that stopped to wait for a buffer of the ring
+	uint cacheHits = 0;         //Compressed mip chains read from the TextureCache
+	uint cacheMisses = 0;       //Compressed by the jobs and written in the TextureCache
+};
+
+/// <summary>
+/// Streams the textures from their files to the GPU. See the top of TextureStreamer.hpp.
+/// </summary>
+class TextureStreamer
+{
+public:
+
+	TextureStreamSettings settings;
+
+	/// <summary>
+	/// Called on the render thread with the texture of every request done, uploaded or not.
+	/// </summary>
+	std::function<void(uint texture)> done;
+
+	/// <summary>
+	/// Creates the buffers of the ring on the device. The settings can't change afterwards.
+	/// </summary>
+	TextureStreamer(IRenderDevice* device, const TextureStreamSettings& settings = TextureStreamSettings());
+
+	/// <summary>
+	/// Waits for the decoding jobs, then deletes the buffers of the ring. The textures not uploaded yet
+	/// keep their placeholder.
+	/// </summary>
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	/// <summary>
+	/// Creates a texture with a placeholder and starts loading its' file.
+	/// </summary>
+	/// <param name="fileName">Relative file name from res/textures.</param>
+	Texture* request(uint id, constring name, constring fileName);
+
+	/// <summary>
+	/// Loads a file again in a texture created by request(), keeping its' handle. The texture keeps its'
+	/// previous image until the new one is uploaded.
+	/// </summary>
+	/// <param name="fileName">Relative file name from res/textures.</param>
+	void reload(uint texture, constring fileName);
+
+	/// <summary>
+	/// Loads a file into a region of an RGBA texture, repeating its' border pixels around it.
+	/// </summary>
+	/// <param name="x">The left of the image in the texture, padding excluded.</param>
+	/// <param name="y">The bottom of the image in the texture, padding excluded.</param>
+	/// <param name="padding">The number of pixels the border pixels are repeated on, on each side.</param>
+	void requestRegion(uint texture, constring fileName, uint x, uint y, uint padding);
+
+	/// <summary>
+	/// Starts the decoding of the waiting requests and uploads the decoded images within the budget of
+	/// the frame. Call it once per frame.
+	/// </summary>
+	void update();
+
+	/// <summary>
+	/// Loads every requested texture, blocking until the last one is uploaded.
+	/// </summary>
+	void flush();
+
+	/// <summary>
+	/// Returns the number of requested textures not uploaded yet.
+	/// </summary>
+	uint pendingCount() const { return stats.requested - stats.uploaded - stats.failed; }
+
+	/// <summary>
+	/// Returns what the streamer did since its' creation.
+	/// </summary>
+	const TextureStreamStats& getStats() const { return stats; }
+
+	/// <summary>
+	/// Prints the stats.
+	/// </summary>
+	void printStats() const;
+
+private:
+
+	typedef std::chrono::steady_clock Clock;
+
+	/// <summary>
+	/// A texture whose file isn't decoding yet.
+	/// </summary>
+	struct Request
+	{
+		uint texture;
+		std::string fileName;
+		bool region = false;  //Whether the image goes in a region of the texture
+		uint x = 0, y = 0;    //Of the region, padding included
+		uint padding = 0;
+	};
+
+	/// <summary>
+	/// The pixels of a texture, between its' decoding and its' upload.
+	/// </summary>
+	struct DecodedImage
+	{
+		Request request;
+		uint8* data;                 //Allocated with new[] for regions, by decodeTexture() otherwise
+		int width, height, channels; //Padding included
+		double decodeMs;
+		CompressedTexture compressed; //Used instead of data when it's not empty
+		bool cached;                  //Whether compressed comes from the TextureCache
+
+		bool decoded() const { return data != nullptr || !compressed.empty(); }
+	};
+
+	/// <summary>
+	/// A buffer of the ring and the fence of its' last upload, 0 if there's none.
+	/// </summary>
+	struct RingBuffer
+	{
+		uint buffer;
+		uint fence = 0;
+	};
+
+	IRenderDevice* device;
+	std::deque<Request> waiting;
+	uint decoding = 0;                    //Jobs in flight
+	std::deque<DecodedImage> ready;       //Decoded, in order of completion
+
+	std::mutex decodedMutex;
+	std::vector<DecodedImage> decoded;    //Jobs returned since the last update
+	Counter jobs;
+
+	std::vector<RingBuffer> ring;
+	uint nextBuffer = 0;
+
+	TextureStreamStats stats;
+
+	/// <summary>
+	/// Starts decoding the waiting requests while there is room for their images.
+	/// </summary>
+	void startDecodes();
+
+	/// <summary>
+	/// Moves the images decoded by the jobs to the ready queue.
+	/// </summary>
+	void collect();
+
+	/// <summary>
+	/// Decodes the image of a request, on a worker.
+	/// </summary>
+	/// <param name="compress">Whether to get its' compressed mip chain instead, if it's not a region.</param>
+	static DecodedImage decode(const Request& request, bool compress);
+
+	/// <summary>
+	/// Frees the pixels of an image.
+	/// </summary>
+	static void free(DecodedImage& image);
+
+	/// <summary>
+	/// Uploads an image and frees it.
+	/// </summary>
+	/// <returns>false if it has to wait for a buffer of the ring, nothing was done then.</returns>
+	bool upload(DecodedImage& image);
+};
@@ -0,0 +1,153 @@
+#include "UniformBuffers.hpp"
+#include "Loader.hpp"
+#include "Model.hpp"
+
+#include <cstdio>
+#include <iterator>
+#include <string_view>
+
+/// <summary>
+/// A block the shaders can declare, and the struct holding it.
+/// </summary>
+struct BlockLayout
+{
+	const char* name;           //In GLSL
+	BlockBinding binding;
+	const BlockMember* members;
+	uint memberCount;
+	size_t size;                //sizeof the struct
+};
+
+static const BlockLayout BLOCKS[] =
+{
+	{ "Frame", BlockBinding::FRAME, FRAME_MEMBERS, (uint)std::size(FRAME_MEMBERS), sizeof(FrameUniforms) },
+	{ "Material", BlockBinding::MATERIAL, MATERIAL_MEMBERS, (uint)std::size(MATERIAL_MEMBERS), sizeof(MaterialUniforms) }
+};
+
+FrameUniforms UniformBuffers::frame;
+uint UniformBuffers::frameBuffer = 0;
+
+void UniformBuffers::init()
+{
+	IRenderDevice* device = Loader::device;
+	frameBuffer = device->createBuffer();
+	device->bindBuffer(BufferTarget::UNIFORM_BUFFER, frameBuffer);
+	device->bufferData(BufferTarget::UNIFORM_BUFFER, &frame, sizeof(frame), BufferUsage::STREAM_DRAW);
+	device->bindBufferBase(BufferTarget::UNIFORM_BUFFER, (uint)BlockBinding::FRAME, frameBuffer); //For good
+}
+
+void UniformBuffers::updateFrame()
+{
+	IRenderDevice* device = Loader::device;
+	device->bindBuffer(BufferTarget::UNIFORM_BUFFER, frameBuffer);
+	device->bufferData(BufferTarget::UNIFORM_BUFFER, &frame, sizeof(frame), BufferUsage::STREAM_DRAW);
+}
+
+uint UniformBuffers::createMaterialBuffer(const MaterialUniforms& uniforms)
+{
+	IRenderDevice* device = Loader::device;
+	uint buffer = device->createBuffer();
+	device->bindBuffer(BufferTarget::UNIFORM_BUFFER, buffer);
+	device->bufferData(BufferTarget::UNIFORM_BUFFER, &uniforms, sizeof(uniforms), BufferUsage::STATIC_DRAW);
+	return buffer;
+}
+
+void UniformBuffers::bindMaterial(const Material& material)
+{
+	Loader::device->bindBufferBase(BufferTarget::UNIFORM_BUFFER, (uint)BlockBinding::MATERIAL, material.uniformBuffer);
+}
+
+void UniformBuffers::bindBlock(uint program, constring shader, uint index, constring block, uint size)
+{
+	for (const BlockLayout& layout : BLOCKS)
+	{
+		if (block != layout.name)
+			continue;
+		if (size > layout.size)
+			printf("The block %s of the shader %s is %u bytes, its' struct only %u\n",
+				layout.name, shader.c_str(), size, (uint)layout.size);
+		Loader::device->uniformBlockBinding(program, index, (uint)layout.binding);
+		return;
+	}
+}
+
+/// <summary>
+/// Returns the GLSL name of a type of BlockMember.
+/// </summary>
+static const char* glslName(VarType type)
+{
+	switch (type)
+	{
+	case VarType::INT:   return "int";
+	case VarType::UINT:  return "uint";
+	case VarType::FLOAT: return "float";
+	case VarType::VEC2:  return "vec2";
+	case VarType::VEC3:  return "vec3";
+	case VarType::VEC4:  return "vec4";
+	case VarType::MAT4:  return "mat4";
+	default:             return "?";
+	}
+}
+
+/// <summary>
+/// Appends the GLSL declaration of a block.
+/// </summary>
+static void declare(std::string& source, const BlockLayout& layout)
+{
+	source += "layout(std140) uniform ";
+	source += layout.name;
+	source += "\n{\n";
+	for (uint i = 0; i < layout.memberCount; i++)
+	{
+		const BlockMember& member = layout.members[i];
+		source += "\t";
+		source += glslName(member.type);
+		source += " ";
+		source += member.name;
+		if (member.count > 1)
+			source += "[" + std::to_string(member.count) + "]";
+		source += ";\n";
+	}
+	source += "};\n";
+}
+
+std::string UniformBuffers::expand(const std::string& source)
+{
+	const std::string DIRECTIVE = "#block ";
+
+	std::string expanded;
+	expanded.reserve(source.size());
+	uint line = 1;
+	for (size_t start = 0; start < source.size(); line++)
+	{
+		size_t end = source.find('\n', start);
+		end = end == std::string::npos ? source.size() : end + 1;
+		std::string_view text(source.data() + start, end - start);
+		start = end;
+
+		const BlockLayout* found = nullptr;
+		if (text.compare(0, DIRECTIVE.size(), DIRECTIVE) == 0)
+		{
+			std::string_view name = text.substr(DIRECTIVE.size());
+			while (!name.empty() && (name.back() == '\n' || name.back() == '\r' || name.back() == ' ' || name.back() == '\t'))
+				name.remove_suffix(1);
+			for (const BlockLayout& layout : BLOCKS)
+				if (name == layout.name)
+					found = &layout;
+		}
+		if (found == nullptr)
+		{
+			expanded += text;
+			continue;
+		}
+		declare(expanded, *found);
+		expanded += "#line " + std::to_string(line + 1) + "\n"; //The errors keep the lines of the file
+	}
+	return expanded;
+}
+
+void UniformBuffers::destroy()
+{
+	Loader::device->deleteBuffers({ frameBuffer });
+	frameBuffer = 0;
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "util/Utility.hpp"
+#include "RenderDevice.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* The uniforms shared by every program (camera, lights, fog) live in uniform buffers instead of being set
+ * on each program: the Frame block is updated once per frame and bound once for all the programs, the
+ * Material block of each Material is uploaded once and bound when the Material changes.
+ *
+ * Each block is a C++ struct following the std140 layout, described by a table of its' members. The
+ * table is checked against the std140 rules at compile time, and the GLSL declaration of the block is
+ * generated from it: a shader declares a block with the line
+ *   #block Frame
+ * replaced by the declaration before the stage is compiled (see expand()). A member is added to the
+ * struct and to its' table, the shaders never repeat the declaration.
+ *
+ * GLSL 4.00 has no layout(binding), so every program gets its' blocks bound to the BlockBinding of their
+ * name once reflected.
+ */
+
+/// <summary>
+/// The binding point of each block, the same in every program.
+/// </summary>
+enum class BlockBinding
+{
+	FRAME,
+	MATERIAL
+};
+
+/// <summary>
+/// A member of a block: its' type for the std140 rules and the GLSL declaration, and its' offset in the
+/// C++ struct.
+/// </summary>
+struct BlockMember
+{
+	VarType type;       //INT, UINT, FLOAT, VEC2 to VEC4 or MAT4
+	const char* name;
+	uint count;         //The length of an array, 1 otherwise
+	size_t offset;      //offsetof the member
+};
+
+#pragma region Std140
+
+/// <summary>
+/// Returns the std140 size of a type, 0 for the types blocks can't hold.
+/// </summary>
+constexpr size_t std140Size(VarType type)
+{
+	switch (type)
+	{
+	case VarType::INT: case VarType::UINT: case VarType::FLOAT: return 4;
+	case VarType::VEC2: return 8;
+	case VarType::VEC3: return 12;
+	case VarType::VEC4: return 16;
+	case VarType::MAT4: return 64;
+	default: return 0;
+	}
+}
+
+/// <summary>
+/// Returns the std140 base alignment of a type. The elements of an array are aligned like a vec4.
+/// </summary>
+constexpr size_t std140Alignment(VarType type, bool array)
+{
+	size_t alignment = type == VarType::VEC3 || type == VarType::MAT4 ? 16 : std140Size(type);
+	return array && alignment < 16 ? 16 : alignment;
+}
+
+/// <summary>
+/// Returns whether the members, in order, are where std140 puts them and size is the one of the block
+/// rounded to a vec4, as the C++ struct must be.
+/// </summary>
+template<size_t N>
+constexpr bool followsStd140(const BlockMember(&members)[N], size_t size)
+{
+	size_t offset = 0;
+	for (const BlockMember& member : members)
+	{
+		size_t alignment = std140Alignment(member.type, member.count > 1);
+		if (alignment == 0)
+			return false;
+		offset = (offset + alignment - 1) / alignment * alignment;
+		if (member.offset != offset)
+			return false;
+		if (member.count > 1) //The stride of an array is rounded to a vec4
+			offset += member.count * ((std140Size(member.type) + 15) / 16 * 16);
+		else
+			offset += std140Size(member.type);
+	}
+	return size == (offset + 15) / 16 * 16;
+}
+
+#pragma endregion
+
+#pragma region Blocks
+
+/// <summary>
+/// The Frame block: the camera, the lights and the fog, shared by every program.
+/// </summary>
+struct alignas(16) FrameUniforms
+{
+	static constexpr uint MAX_LIGHTS = 16;   //MAX_LIGHTS of the shaders
+
+	glm::mat4 projectionMatrix = glm::mat4(1);
+	glm::mat4 viewMatrix = glm::mat4(1);
+	glm::mat4 projectionViewMatrix = glm::mat4(1);
+	glm::vec4 lightPosition[MAX_LIGHTS] = {};  //xyz, vec3 arrays are padded to vec4 anyway
+	glm::vec4 lightColour[MAX_LIGHTS] = {};
+	glm::vec4 attenuation[MAX_LIGHTS] = {};    //Constant, linear and quadratic factors in xyz
+	glm::vec3 directionalLight = glm::vec3(0, 1, 0);
+	float ambientLight = 0.2f;                 //Packed after the vec3, as std140 does
+	glm::vec3 directionalLightColour = glm::vec3(1);
+	float fogDensity = 0;
+	glm::vec3 skyColor = glm::vec3(0);
+	float fogDistance = 0;
+	int lightCount = 0;
+};
+
+inline constexpr BlockMember FRAME_MEMBERS[] =
+{
+	{ VarType::MAT4, "projectionMatrix", 1, offsetof(FrameUniforms, projectionMatrix) },
+	{ VarType::MAT4, "viewMatrix", 1, offsetof(FrameUniforms, viewMatrix) },
+	{ VarType::MAT4, "projectionViewMatrix", 1, offsetof(FrameUniforms, projectionViewMatrix) },
+	{ VarType::VEC4, "lightPosition", FrameUniforms::MAX_LIGHTS, offsetof(FrameUniforms, lightPosition) },
+	{ VarType::VEC4, "lightColour", FrameUniforms::MAX_LIGHTS, offsetof(FrameUniforms, lightColour) },
+	{ VarType::VEC4, "attenuation", FrameUniforms::MAX_LIGHTS, offsetof(FrameUniforms, attenuation) },
+	{ VarType::VEC3, "directionalLight", 1, offsetof(FrameUniforms, directionalLight) },
+	{ VarType::FLOAT, "ambientLight", 1, offsetof(FrameUniforms, ambientLight) },
+	{ VarType::VEC3, "directionalLightColour", 1, offsetof(FrameUniforms, directionalLightColour) },
+	{ VarType::FLOAT, "fogDensity", 1, offsetof(FrameUniforms, fogDensity) },
+	{ VarType::VEC3, "skyColor", 1, offsetof(FrameUniforms, skyColor) },
+	{ VarType::FLOAT, "fogDistance", 1, offsetof(FrameUniforms, fogDistance) },
+	{ VarType::INT, "lightCount", 1, offsetof(FrameUniforms, lightCount) }
+};
+static_assert(followsStd140(FRAME_MEMBERS, sizeof(FrameUniforms)), "FrameUniforms doesn't follow std140");
+
+/// <summary>
+/// The Material block: the parameters of a Material.
+/// </summary>
+struct alignas(16) MaterialUniforms
+{
+	float shineDamper = 10;
+	float reflectivity = 0;
+};
+
+inline constexpr BlockMember MATERIAL_MEMBERS[] =
+{
+	{ VarType::FLOAT, "shineDamper", 1, offsetof(MaterialUniforms, shineDamper) },
+	{ VarType::FLOAT, "reflectivity", 1, offsetof(MaterialUniforms, reflectivity) }
+};
+static_assert(followsStd140(MATERIAL_MEMBERS, sizeof(MaterialUniforms)), "MaterialUniforms doesn't follow std140");
+
+#pragma endregion
+
+struct Material;
+
+/// <summary>
+/// A static class that owns the Frame buffer, creates the Material buffers and declares the blocks in
+/// the shaders. See the top of UniformBuffers.hpp.
+/// </summary>
+class UniformBuffers
+{
+public:
+
+	static FrameUniforms frame;  //Written by the game, uploaded by updateFrame()
+
+	/// <summary>
+	/// Creates the Frame buffer and binds it for every program. On the thread of the render device.
+	/// </summary>
+	static void init();
+
+	/// <summary>
+	/// Uploads frame, once per frame before drawing. The buffer is orphaned so we never wait for the
+	/// previous frame.
+	/// </summary>
+	static void updateFrame();
+
+	/// <summary>
+	/// Creates the buffer of a Material, never updated.
+	/// </summary>
+	static uint createMaterialBuffer(const MaterialUniforms& uniforms);
+
+	/// <summary>
+	/// Binds the buffer of a Material for the next draws.
+	/// </summary>
+	static void bindMaterial(const Material& material);
+
+	/// <summary>
+	/// Binds a block of a linked program to the BlockBinding of its' name, if it's one of the blocks. A
+	/// block bigger than its' struct is reported, it would read past the buffer.
+	/// </summary>
+	/// <param name="shader">The name of the Shader, for the report.</param>
+	/// <param name="size">The size of the block the driver reports, in bytes.</param>
+	static void bindBlock(uint program, constring shader, uint index, constring block, uint size);
+
+	/// <summary>
+	/// Replaces the "#block Name" lines of a source by the declaration of the block. Unknown names are
+	/// left for the driver to report. From any thread.
+	/// </summary>
+	static std::string expand(const std::string& source);
+
+	/// <summary>
+	/// Frees the Frame buffer. The Material buffers are freed with the other buffers of the Loader.
+	/// </summary>
+	static void destroy();
+
+private:
+
+	static uint frameBuffer;
+};
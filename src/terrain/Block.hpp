@@ -0,0 +1,11 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+/* Blocks are identified by a 16 bits id, which indexes the `blocks` uniform array of terrainVertex.vert.
+ * The id 0 is always air, which is never meshed.
+ */
+
+typedef int16 BlockID;
+
+inline constexpr BlockID AIR = 0;
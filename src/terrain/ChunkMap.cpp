@@ -0,0 +1,103 @@
+#include "ChunkMap.hpp"
+
+ChunkMap::~ChunkMap()
+{
+	clear();
+}
+
+uint64 ChunkMap::keyOf(glm::ivec3 position)
+{
+	const uint64 mask = (1 << 21) - 1;
+	return ((uint64)position.x & mask) | (((uint64)position.y & mask) << 21) | (((uint64)position.z & mask) << 42);
+}
+
+glm::ivec3 ChunkMap::chunkOf(glm::ivec3 voxel)
+{
+	//Arithmetic shifts round towards -infinity, unlike divisions
+	static_assert(VoxelChunk::SIZE == 32, "chunkOf assumes 32 voxels per chunk");
+	return glm::ivec3(voxel.x >> 5, voxel.y >> 5, voxel.z >> 5);
+}
+
+VoxelChunk* ChunkMap::get(glm::ivec3 position) const
+{
+	auto it = chunks.find(keyOf(position));
+	return it != chunks.end() ? it->second : nullptr;
+}
+
+VoxelChunk& ChunkMap::getOrCreate(glm::ivec3 position, BlockID block)
+{
+	VoxelChunk*& chunk = chunks[keyOf(position)];
+	if (chunk == nullptr)
+		chunk = new VoxelChunk(position, block);
+	return *chunk;
+}
+
+void ChunkMap::insert(VoxelChunk* chunk)
+{
+	VoxelChunk*& slot = chunks[keyOf(chunk->position)];
+	if (slot != chunk)
+		delete slot;
+	slot = chunk;
+}
+
+void ChunkMap::remove(glm::ivec3 position)
+{
+	auto it = chunks.find(keyOf(position));
+	if (it == chunks.end())
+		return;
+	delete it->second;
+	chunks.erase(it);
+}
+
+BlockID ChunkMap::getBlock(glm::ivec3 voxel) const
+{
+	VoxelChunk* chunk = get(chunkOf(voxel));
+	if (chunk == nullptr)
+		return AIR;
+	glm::ivec3 local = voxel - chunk->position * VoxelChunk::SIZE;
+	return chunk->get(local.x, local.y, local.z);
+}
+
+void ChunkMap::setBlock(glm::ivec3 voxel, BlockID block)
+{
+	VoxelChunk& chunk = getOrCreate(chunkOf(voxel));
+	glm::ivec3 local = voxel - chunk.position * VoxelChunk::SIZE;
+	chunk.set(local.x, local.y, local.z, block);
+
+	//The faces of the neighbours touching the voxel may appear or disappear
+	for (int axis = 0; axis < 3; axis++)
+	{
+		glm::ivec3 offset(0);
+		if (local[axis] == 0)
+			offset[axis] = -1;
+		else if (local[axis] == VoxelChunk::SIZE - 1)
+			offset[axis] = 1;
+		else
+			continue;
+
+		VoxelChunk* neighbour = get(chunk.position + offset);
+		if (neighbour != nullptr)
+			neighbour->dirty = true;
+	}
+}
+
+void ChunkMap::forEach(const std::function<void(VoxelChunk&)>& function) const
+{
+	for (const auto& pair : chunks)
+		function(*pair.second);
+}
+
+size_t ChunkMap::memoryUsage() const
+{
+	size_t total = 0;
+	for (const auto& pair : chunks)
+		total += pair.second->memoryUsage();
+	return total;
+}
+
+void ChunkMap::clear()
+{
+	for (auto& pair : chunks)
+		delete pair.second;
+	chunks.clear();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "VoxelChunk.hpp"
+
+#include <unordered_map>
+#include <functional>
+#include "glm/vec3.hpp"
+
+/// <summary>
+/// The loaded VoxelChunks of a voxel world, keyed by their integer chunk coordinates.
+/// </summary>
+class ChunkMap
+{
+public:
+
+	ChunkMap() = default;
+	~ChunkMap();
+
+	ChunkMap(const ChunkMap&) = delete;
+	ChunkMap& operator=(const ChunkMap&) = delete;
+
+	/// <summary>
+	/// Returns the chunk containing a world voxel.
+	/// </summary>
+	static glm::ivec3 chunkOf(glm::ivec3 voxel);
+
+	/// <summary>
+	/// Packs chunk coordinates in 21 bits each, enough for ±1M chunks (±33M voxels) per axis.
+	/// </summary>
+	static uint64 keyOf(glm::ivec3 position);
+
+	/// <summary>
+	/// Returns the chunk at the given chunk coordinates, nullptr if it isn't loaded.
+	/// </summary>
+	VoxelChunk* get(glm::ivec3 position) const;
+
+	/// <summary>
+	/// Returns the chunk at the given chunk coordinates, creating it filled with the block if needed.
+	/// </summary>
+	VoxelChunk& getOrCreate(glm::ivec3 position, BlockID block = AIR);
+
+	/// <summary>
+	/// Adds a chunk created elsewhere, the map takes its' ownership. Unloads the chunk it replaces.
+	/// </summary>
+	void insert(VoxelChunk* chunk);
+
+	/// <summary>
+	/// Unloads a chunk, nothing happens if it isn't loaded.
+	/// </summary>
+	void remove(glm::ivec3 position);
+
+	/// <summary>
+	/// Returns the block of a world voxel, AIR if its' chunk isn't loaded.
+	/// </summary>
+	BlockID getBlock(glm::ivec3 voxel) const;
+
+	/// <summary>
+	/// Sets the block of a world voxel, creating its' chunk if needed. Marks the chunk and the
+	/// neighbours sharing a face with the voxel as dirty.
+	/// </summary>
+	void setBlock(glm::ivec3 voxel, BlockID block);
+
+	/// <summary>
+	/// Calls function(chunk) on every loaded chunk, in no particular order.
+	/// </summary>
+	void forEach(const std::function<void(VoxelChunk&)>& function) const;
+
+	/// <summary>
+	/// Returns the number of loaded chunks.
+	/// </summary>
+	uint count() const { return (uint)chunks.size(); }
+
+	/// <summary>
+	/// Returns the memory used by all the loaded chunks in bytes.
+	/// </summary>
+	size_t memoryUsage() const;
+
+	/// <summary>
+	/// Unloads all the chunks.
+	/// </summary>
+	void clear();
+
+private:
+
+	std::unordered_map<uint64, VoxelChunk*> chunks;
+};
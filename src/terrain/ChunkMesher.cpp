@@ -0,0 +1,198 @@
+#include "ChunkMesher.hpp"
+#include "jobs/JobSystem.hpp"
+
+#include <cstring>
+
+static_assert(sizeof(TerrainVertex) == 8, "TerrainVertex must stay packed");
+
+void ChunkMesher::gather(const ChunkMap& map, const VoxelChunk& chunk, BlockID* padded)
+{
+	const int S = VoxelChunk::SIZE;
+	static thread_local std::vector<BlockID> blocks(VoxelChunk::VOLUME);
+
+	std::fill(padded, padded + PADDED * PADDED * PADDED, AIR);
+	chunk.unpack(blocks.data());
+	for (int y = 0; y < S; y++)
+		for (int z = 0; z < S; z++)
+			memcpy(padded + paddedIndex(0, y, z), blocks.data() + VoxelChunk::indexOf(0, y, z), S * sizeof(BlockID));
+
+	//The layer of each neighbour touching the chunk, missing neighbours are air
+	for (int axis = 0; axis < 3; axis++)
+		for (int side = -1; side <= 1; side += 2)
+		{
+			glm::ivec3 offset(0);
+			offset[axis] = side;
+			const VoxelChunk* neighbour = map.get(chunk.position + offset);
+			if (neighbour == nullptr)
+				continue;
+
+			int layer = side < 0 ? S - 1 : 0;     //In the neighbour
+			int target = side < 0 ? -1 : S;       //In the padded chunk
+			const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+			for (int a = 0; a < S; a++)
+				for (int b = 0; b < S; b++)
+				{
+					glm::ivec3 from, to;
+					from[axis] = layer;
+					to[axis] = target;
+					from[u] = to[u] = a;
+					from[v] = to[v] = b;
+					padded[paddedIndex(to.x, to.y, to.z)] = neighbour->get(from.x, from.y, from.z);
+				}
+		}
+}
+
+void ChunkMesher::emitQuad(ChunkMesh& mesh, int axis, bool positive, glm::ivec3 corner, int width, int height, BlockID block)
+{
+	const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+	glm::ivec3 du(0), dv(0);
+	du[u] = width;
+	dv[v] = height;
+
+	//(axis, u, v) is right handed, so corner, +du, +du+dv, +dv is counter clockwise seen from +axis
+	glm::ivec3 corners[4] = { corner, corner + du, corner + du + dv, corner + dv };
+	if (!positive)
+		std::swap(corners[1], corners[3]);
+
+	uint packed = TerrainVertex::pack(block, axis + (positive ? 0 : 3));
+	for (const glm::ivec3& c : corners)
+		mesh.vertices.push_back({ (uint8)c.x, (uint8)c.y, (uint8)c.z, 0, packed });
+}
+
+void ChunkMesher::greedy(const ChunkMap& map, const VoxelChunk& chunk, ChunkMesh& mesh)
+{
+	const int S = VoxelChunk::SIZE;
+	static thread_local std::vector<BlockID> padded(PADDED * PADDED * PADDED);
+	gather(map, chunk, padded.data());
+
+	mesh.position = chunk.position;
+	mesh.vertices.clear();
+
+	BlockID mask[S * S]; //Visible faces of a slice, indexed by u + v * S
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+		for (int side = -1; side <= 1; side += 2)
+			for (int slice = 0; slice < S; slice++)
+			{
+				//1. Finding the visible faces of the slice, walking the padded chunk with strides
+				const int stride[3] = { 1, PADDED * PADDED, PADDED };
+				const int facing = side * stride[axis];
+				for (int b = 0; b < S; b++)
+				{
+					const BlockID* row = padded.data() + paddedIndex(0, 0, 0) + slice * stride[axis] + b * stride[v];
+					for (int a = 0; a < S; a++)
+					{
+						const BlockID* voxel = row + a * stride[u];
+						mask[a + b * S] = *voxel != AIR && voxel[facing] == AIR ? *voxel : AIR;
+					}
+				}
+
+				//2. Merging them in rectangles, as wide as possible then as high as possible
+				for (int b = 0; b < S; b++)
+					for (int a = 0; a < S; )
+					{
+						BlockID block = mask[a + b * S];
+						if (block == AIR)
+						{
+							a++;
+							continue;
+						}
+
+						int width = 1;
+						while (a + width < S && mask[a + width + b * S] == block)
+							width++;
+
+						int height = 1;
+						for (; b + height < S; height++)
+						{
+							int w = 0;
+							while (w < width && mask[a + w + (b + height) * S] == block)
+								w++;
+							if (w < width)
+								break;
+						}
+
+						for (int h = 0; h < height; h++)
+							for (int w = 0; w < width; w++)
+								mask[a + w + (b + h) * S] = AIR;
+
+						glm::ivec3 corner;
+						corner[axis] = side > 0 ? slice + 1 : slice;
+						corner[u] = a;
+						corner[v] = b;
+						emitQuad(mesh, axis, side > 0, corner, width, height, block);
+						a += width;
+					}
+			}
+	}
+}
+
+void ChunkMesher::naive(const ChunkMap& map, const VoxelChunk& chunk, ChunkMesh& mesh)
+{
+	const int S = VoxelChunk::SIZE;
+	static thread_local std::vector<BlockID> padded(PADDED * PADDED * PADDED);
+	gather(map, chunk, padded.data());
+
+	mesh.position = chunk.position;
+	mesh.vertices.clear();
+
+	for (int y = 0; y < S; y++)
+		for (int z = 0; z < S; z++)
+			for (int x = 0; x < S; x++)
+			{
+				BlockID block = padded[paddedIndex(x, y, z)];
+				if (block == AIR)
+					continue;
+
+				for (int axis = 0; axis < 3; axis++)
+					for (int side = -1; side <= 1; side += 2)
+					{
+						glm::ivec3 p(x, y, z);
+						p[axis] += side;
+						if (padded[paddedIndex(p.x, p.y, p.z)] != AIR)
+							continue;
+
+						glm::ivec3 corner(x, y, z);
+						if (side > 0)
+							corner[axis]++;
+						emitQuad(mesh, axis, side > 0, corner, 1, 1, block);
+					}
+			}
+}
+
+void ChunkMesher::meshDirty(ChunkMap& map, std::vector<ChunkMesh>& meshes)
+{
+	std::vector<VoxelChunk*> dirty;
+	map.forEach([&](VoxelChunk& chunk)
+	{
+		if (chunk.dirty)
+			dirty.push_back(&chunk);
+	});
+
+	meshes.resize(dirty.size());
+	JobSystem::parallelFor(0, (uint)dirty.size(), 1, [&](uint first, uint last)
+	{
+		for (uint i = first; i < last; i++)
+			greedy(map, *dirty[i], meshes[i]);
+	});
+
+	for (VoxelChunk* chunk : dirty)
+		chunk->dirty = false;
+}
+
+void ChunkMesher::quadIndices(uint quadCount, std::vector<uint>& indices)
+{
+	indices.resize((size_t)quadCount * 6);
+	for (uint quad = 0; quad < quadCount; quad++)
+	{
+		uint first = quad * 4;
+		uint* out = indices.data() + (size_t)quad * 6;
+		out[0] = first;
+		out[1] = first + 1;
+		out[2] = first + 2;
+		out[3] = first;
+		out[4] = first + 2;
+		out[5] = first + 3;
+	}
+}
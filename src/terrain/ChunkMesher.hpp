@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ChunkMap.hpp"
+
+#include <vector>
+
+/* The ChunkMesher turns VoxelChunks into the geometry read by terrainVertex.vert.
+ *
+ * Only the faces between a block and air are visible. The greedy mesher merges the visible faces of
+ * each slice of the chunk into rectangles of the same block, which emits several times fewer vertices
+ * than one quad per face on terrain. Every quad is 4 vertices, the indices being the same for all
+ * the chunks (see quadIndices()), so a single index buffer serves every chunk mesh.
+ *
+ * Normal indices follow the `normals` array of terrainVertex.vert: +x, +y, +z, -x, -y, -z.
+ */
+
+/// <summary>
+/// A vertex of a terrain mesh, 8 bytes.
+/// </summary>
+struct TerrainVertex
+{
+	uint8 x, y, z;       //Position in the chunk, in [0, VoxelChunk::SIZE]
+	uint8 padding;
+	uint blockAndNormal; //Block id in the lowest 16 bits, normal index in the highest 16 bits
+
+	static uint pack(BlockID block, uint normal) { return (uint)(uint16)block | (normal << 16); }
+};
+
+/// <summary>
+/// The geometry of a VoxelChunk.
+/// </summary>
+struct ChunkMesh
+{
+	glm::ivec3 position;                //Of the chunk, the chunkPosition uniform is position * SIZE
+	std::vector<TerrainVertex> vertices; //4 per quad
+
+	uint quadCount() const { return (uint)vertices.size() / 4; }
+};
+
+/// <summary>
+/// A static class generating the meshes of VoxelChunks.
+/// </summary>
+class ChunkMesher
+{
+public:
+
+	/// <summary>
+	/// Meshes a chunk, merging the coplanar faces of the same block into rectangles.
+	/// </summary>
+	/// <param name="map">The map of the chunk, its' neighbours hide the faces on the borders.</param>
+	static void greedy(const ChunkMap& map, const VoxelChunk& chunk, ChunkMesh& mesh);
+
+	/// <summary>
+	/// Meshes a chunk with one quad per visible face, used as a reference.
+	/// </summary>
+	static void naive(const ChunkMap& map, const VoxelChunk& chunk, ChunkMesh& mesh);
+
+	/// <summary>
+	/// Greedy meshes every dirty chunk of the map in parallel on the JobSystem and clears their dirty flag.
+	/// The map must not be modified meanwhile.
+	/// </summary>
+	/// <param name="meshes">Receives one mesh per dirty chunk.</param>
+	static void meshDirty(ChunkMap& map, std::vector<ChunkMesh>& meshes);
+
+	/// <summary>
+	/// Writes the indices of quadCount quads made of 4 vertices each, 2 counter clockwise triangles per quad.
+	/// </summary>
+	static void quadIndices(uint quadCount, std::vector<uint>& indices);
+
+private:
+
+	static constexpr int PADDED = VoxelChunk::SIZE + 2; //The chunk with a layer of each neighbour around it
+
+	static int paddedIndex(int x, int y, int z) { return (x + 1) + (z + 1) * PADDED + (y + 1) * PADDED * PADDED; }
+
+	/// <summary>
+	/// Copies the blocks of the chunk and the faces of its' neighbours touching it.
+	/// </summary>
+	static void gather(const ChunkMap& map, const VoxelChunk& chunk, BlockID* padded);
+
+	/// <summary>
+	/// Appends a quad of the plane orthogonal to axis.
+	/// </summary>
+	/// <param name="corner">The corner with the smallest coordinates.</param>
+	/// <param name="width">Its' size along the axis after axis.</param>
+	/// <param name="height">Its' size along the axis after that one.</param>
+	/// <param name="positive">Whether the face looks towards +axis.</param>
+	static void emitQuad(ChunkMesh& mesh, int axis, bool positive, glm::ivec3 corner, int width, int height, BlockID block);
+};
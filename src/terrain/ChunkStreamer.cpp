@@ -0,0 +1,426 @@
+#include "ChunkStreamer.hpp"
+#include "TerrainGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "glm/geometric.hpp"
+#include "glm/common.hpp"
+
+static const glm::ivec3 NEIGHBOURS[6] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { -1, 0, 0 }, { 0, -1, 0 }, { 0, 0, -1 } };
+static const float CHUNK_RADIUS = VoxelChunk::SIZE * 0.8660254f; //Half of the diagonal of a chunk
+
+template<typename Duration>
+static double toMs(Duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); }
+
+/// <summary>
+/// Orders the queues as heaps whose top is the lowest priority value, the most urgent chunk.
+/// </summary>
+template<typename T>
+static bool lessUrgent(const T* a, const T* b) { return a->priority > b->priority; }
+
+ChunkStreamer::ChunkStreamer(ChunkMap& map, const StreamSettings& settings) :
+	settings(settings), map(map), center(0) {}
+
+ChunkStreamer::~ChunkStreamer()
+{
+	for (auto& pair : tracked)
+		pair.second->cancelled = true;
+	JobSystem::wait(jobs);
+
+	//Every job returned, nothing else refers to the chunks
+	for (auto& pair : tracked)
+	{
+		delete pair.second->generated;
+		delete pair.second;
+	}
+	for (StreamedChunk* orphan : orphans)
+	{
+		delete orphan->generated;
+		delete orphan;
+	}
+	for (MapWrite& write : mapWrites)
+		delete write.chunk;
+}
+
+#pragma region Update
+
+void ChunkStreamer::update(const StreamView& view)
+{
+	collect();
+
+	glm::ivec3 viewerChunk = ChunkMap::chunkOf(glm::ivec3(glm::floor(view.position)));
+	if (!centered || viewerChunk != center)
+		follow(viewerChunk);
+
+	const bool mapReady = applyMapWrites();
+	prioritize(view);
+	const uint slots = settings.jobsPerWorker * JobSystem::workerCount();
+
+	//Later stages first: finishing chunks frees memory and unblocks the stages before them
+	std::vector<StreamedChunk*>& uploads = queues[(int)ChunkStage::UPLOAD];
+	uint uploadsLeft = settings.uploadsPerFrame;
+	while (uploadsLeft > 0 && !uploads.empty())
+	{
+		std::pop_heap(uploads.begin(), uploads.end(), lessUrgent<StreamedChunk>);
+		StreamedChunk* chunk = uploads.back();
+		uploads.pop_back();
+
+		//Empty meshes are free, unless they replace an uploaded one
+		chunk->startedAt = Clock::now();
+		if (upload && (!chunk->mesh.vertices.empty() || chunk->uploaded))
+		{
+			upload(chunk->mesh);
+			chunk->uploaded = true;
+			uploadsLeft--;
+		}
+		std::vector<TerrainVertex>().swap(chunk->mesh.vertices);
+		chunk->workMs = toMs(Clock::now() - chunk->startedAt);
+		record(chunk);
+		advance(chunk, ChunkStage::COUNT);
+	}
+
+	//Meshing pauses while its' results can't be uploaded fast enough, or while the map waits for its' writes
+	std::vector<StreamedChunk*>& meshes = queues[(int)ChunkStage::MESH];
+	uint pendingUploads = (uint)uploads.size();
+	while (mapReady && !meshes.empty() && stageStats[(int)ChunkStage::MESH].running < slots
+		&& pendingUploads < settings.maxPendingUploads)
+	{
+		std::pop_heap(meshes.begin(), meshes.end(), lessUrgent<StreamedChunk>);
+		StreamedChunk* chunk = meshes.back();
+		meshes.pop_back();
+		pendingUploads++;
+
+		//Chunks of air have no faces, no need for a job
+		const VoxelChunk* voxels = map.get(chunk->position);
+		if (voxels->isUniform() && voxels->get(0, 0, 0) == AIR)
+		{
+			chunk->startedAt = Clock::now();
+			chunk->mesh.vertices.clear();
+			chunk->workMs = 0;
+			record(chunk);
+			advance(chunk, ChunkStage::UPLOAD);
+			continue;
+		}
+		start(chunk);
+	}
+
+	//Nothing to compute yet, the stage only waits for the neighbours
+	for (StreamedChunk* chunk : queues[(int)ChunkStage::LIGHT])
+	{
+		chunk->startedAt = Clock::now();
+		chunk->workMs = 0;
+		record(chunk);
+		advance(chunk, ChunkStage::MESH);
+	}
+
+	std::vector<StreamedChunk*>& generations = queues[(int)ChunkStage::GENERATE];
+	while (!generations.empty() && stageStats[(int)ChunkStage::GENERATE].running < slots)
+	{
+		std::pop_heap(generations.begin(), generations.end(), lessUrgent<StreamedChunk>);
+		start(generations.back());
+		generations.pop_back();
+	}
+
+	//Without other workers, the jobs only progress when the main thread executes them
+	if (JobSystem::workerCount() == 1)
+	{
+		Clock::time_point start = Clock::now();
+		while (toMs(Clock::now() - start) < settings.mainThreadMs && JobSystem::tryExecute());
+	}
+}
+
+void ChunkStreamer::collect()
+{
+	{
+		std::lock_guard<std::mutex> lock(finishedMutex);
+		finishedScratch.swap(finished);
+	}
+
+	for (StreamedChunk* chunk : finishedScratch)
+	{
+		chunk->running = false;
+		stageStats[(int)chunk->stage].running--;
+
+		if (chunk->cancelled)
+		{
+			//Counted as cancelled when it left the range
+			orphans.erase(std::find(orphans.begin(), orphans.end(), chunk));
+			if (chunk->inMap)
+				mapWrites.push_back({ chunk->position, nullptr, nullptr });
+			delete chunk->generated;
+			delete chunk;
+			continue;
+		}
+
+		record(chunk);
+		if (chunk->stage == ChunkStage::GENERATE)
+		{
+			mapWrites.push_back({ chunk->position, chunk->generated, chunk });
+			chunk->generated = nullptr;
+			advance(chunk, ChunkStage::LIGHT);
+		}
+		else if (chunk->remesh)
+		{
+			chunk->remesh = false;
+			advance(chunk, ChunkStage::MESH);
+		}
+		else
+			advance(chunk, ChunkStage::UPLOAD);
+	}
+	finishedScratch.clear();
+}
+
+void ChunkStreamer::follow(glm::ivec3 viewerChunk)
+{
+	center = viewerChunk;
+	centered = true;
+
+	//Chunks are kept one chunk farther than they are loaded, so moving back and forth doesn't reload them
+	std::vector<StreamedChunk*> leaving;
+	for (auto& pair : tracked)
+		if (!inRange(pair.second->position, viewerChunk, 1))
+			leaving.push_back(pair.second);
+	for (StreamedChunk* chunk : leaving)
+		cancel(chunk);
+
+	const int r = (int)settings.viewDistance;
+	const Clock::time_point now = Clock::now();
+	for (int y = settings.minLayer; y <= settings.maxLayer; y++)
+		for (int z = -r; z <= r; z++)
+			for (int x = -r; x <= r; x++)
+			{
+				glm::ivec3 position(viewerChunk.x + x, y, viewerChunk.z + z);
+				if (!inRange(position, viewerChunk, 0))
+					continue;
+
+				StreamedChunk*& chunk = tracked[ChunkMap::keyOf(position)];
+				if (chunk != nullptr)
+					continue;
+				chunk = new StreamedChunk();
+				chunk->position = position;
+				chunk->mesh.position = position;
+				chunk->queuedAt = now;
+			}
+}
+
+void ChunkStreamer::cancel(StreamedChunk* chunk)
+{
+	tracked.erase(ChunkMap::keyOf(chunk->position));
+	if (chunk->stage != ChunkStage::COUNT)
+		stageStats[(int)chunk->stage].cancelled++;
+	else
+		done--;
+	if (chunk->uploaded && unload)
+		unload(chunk->position);
+
+	if (chunk->running)
+	{
+		chunk->cancelled = true;
+		orphans.push_back(chunk);
+		return;
+	}
+
+	if (chunk->inMap)
+		mapWrites.push_back({ chunk->position, nullptr, nullptr });
+	else
+	{
+		//Generated but not inserted yet
+		auto write = std::find_if(mapWrites.begin(), mapWrites.end(), [chunk](const MapWrite& w) { return w.owner == chunk; });
+		if (write != mapWrites.end())
+		{
+			delete write->chunk;
+			mapWrites.erase(write);
+		}
+	}
+	delete chunk;
+}
+
+bool ChunkStreamer::applyMapWrites()
+{
+	if (mapWrites.empty())
+		return true;
+
+	std::unique_lock<std::shared_mutex> lock(mapLock, std::try_to_lock);
+	if (!lock.owns_lock())
+		return false;
+
+	for (MapWrite& write : mapWrites)
+	{
+		if (write.chunk == nullptr)
+		{
+			//The position may have come back in range, its' new chunk will replace this one
+			if (tracked.find(ChunkMap::keyOf(write.position)) == tracked.end())
+				map.remove(write.position);
+			continue;
+		}
+
+		map.insert(write.chunk);
+		write.owner->inMap = true;
+
+		//Neighbours meshed without this chunk show faces on their border, unless it's only air
+		if (write.chunk->isUniform() && write.chunk->get(0, 0, 0) == AIR)
+			continue;
+		for (const glm::ivec3& offset : NEIGHBOURS)
+		{
+			auto it = tracked.find(ChunkMap::keyOf(write.position + offset));
+			if (it == tracked.end())
+				continue;
+			StreamedChunk* neighbour = it->second;
+			if (neighbour->stage == ChunkStage::MESH && neighbour->running)
+				neighbour->remesh = true;
+			else if (neighbour->stage > ChunkStage::MESH)
+				advance(neighbour, ChunkStage::MESH);
+		}
+	}
+	mapWrites.clear();
+	return true;
+}
+
+#pragma endregion
+
+#pragma region Stages
+
+void ChunkStreamer::advance(StreamedChunk* chunk, ChunkStage next)
+{
+	if (chunk->stage == ChunkStage::COUNT)
+		done--;
+	if (next == ChunkStage::COUNT)
+		done++;
+	chunk->stage = next;
+	chunk->queuedAt = Clock::now();
+}
+
+bool ChunkStreamer::isReady(const StreamedChunk* chunk) const
+{
+	if (chunk->stage == ChunkStage::GENERATE)
+		return true;
+	if (!chunk->inMap)
+		return false;
+	if (chunk->stage == ChunkStage::UPLOAD)
+		return true;
+
+	//Neighbours out of range are never generated, their side is meshed as air
+	for (const glm::ivec3& offset : NEIGHBOURS)
+	{
+		auto it = tracked.find(ChunkMap::keyOf(chunk->position + offset));
+		if (it != tracked.end() && !it->second->inMap)
+			return false;
+	}
+	return true;
+}
+
+void ChunkStreamer::prioritize(const StreamView& view)
+{
+	for (int stage = 0; stage < (int)ChunkStage::COUNT; stage++)
+	{
+		queues[stage].clear();
+		stageStats[stage].waiting = 0;
+	}
+
+	const float cosHalfFov = std::cos(view.fov * 0.5f);
+	for (auto& pair : tracked)
+	{
+		StreamedChunk* chunk = pair.second;
+		if (chunk->stage == ChunkStage::COUNT || chunk->running)
+			continue;
+		stageStats[(int)chunk->stage].waiting++;
+		if (!isReady(chunk))
+			continue;
+
+		//The chunk's bounding sphere against the view cone, approximated by widening the cone by its' radius
+		glm::vec3 offset = (glm::vec3(chunk->position) + 0.5f) * (float)VoxelChunk::SIZE - view.position;
+		float distance = glm::length(offset);
+		bool visible = glm::dot(offset, view.forward) >= distance * cosHalfFov - CHUNK_RADIUS;
+		chunk->priority = visible ? distance : distance * OUT_OF_VIEW_PENALTY;
+
+		queues[(int)chunk->stage].push_back(chunk);
+	}
+
+	for (std::vector<StreamedChunk*>& queue : queues)
+		std::make_heap(queue.begin(), queue.end(), lessUrgent<StreamedChunk>);
+}
+
+void ChunkStreamer::start(StreamedChunk* chunk)
+{
+	chunk->running = true;
+	chunk->startedAt = Clock::now();
+	stageStats[(int)chunk->stage].running++;
+
+	if (chunk->stage == ChunkStage::GENERATE)
+	{
+		JobSystem::run([this, chunk]
+		{
+			Clock::time_point begin = Clock::now();
+			if (!chunk->cancelled)
+			{
+				chunk->generated = new VoxelChunk(chunk->position);
+				TerrainGenerator::generate(*chunk->generated);
+			}
+			chunk->workMs = toMs(Clock::now() - begin);
+			finish(chunk);
+		}, &jobs);
+		return;
+	}
+
+	JobSystem::run([this, chunk]
+	{
+		Clock::time_point begin = Clock::now();
+		if (!chunk->cancelled)
+		{
+			std::shared_lock<std::shared_mutex> lock(mapLock);
+			ChunkMesher::greedy(map, *map.get(chunk->position), chunk->mesh);
+		}
+		chunk->workMs = toMs(Clock::now() - begin);
+		finish(chunk);
+	}, &jobs);
+}
+
+void ChunkStreamer::finish(StreamedChunk* chunk)
+{
+	std::lock_guard<std::mutex> lock(finishedMutex);
+	finished.push_back(chunk);
+}
+
+void ChunkStreamer::record(const StreamedChunk* chunk)
+{
+	StageStats& stats = stageStats[(int)chunk->stage];
+	double waitMs = toMs(chunk->startedAt - chunk->queuedAt);
+	double latencyMs = toMs(Clock::now() - chunk->queuedAt);
+	stats.completed++;
+	stats.waitMs += waitMs;
+	stats.workMs += chunk->workMs;
+	stats.maxLatencyMs = std::max(stats.maxLatencyMs, latencyMs);
+}
+
+bool ChunkStreamer::inRange(glm::ivec3 position, glm::ivec3 viewerChunk, int margin) const
+{
+	const int dx = position.x - viewerChunk.x, dz = position.z - viewerChunk.z;
+	const int r = (int)settings.viewDistance + margin;
+	return dx * dx + dz * dz <= r * r && position.y >= settings.minLayer && position.y <= settings.maxLayer;
+}
+
+#pragma endregion
+
+#pragma region Stats
+
+const char* ChunkStreamer::nameOf(ChunkStage stage)
+{
+	static const char* names[(int)ChunkStage::COUNT + 1] = { "generate", "light", "mesh", "upload", "done" };
+	return names[(int)stage];
+}
+
+void ChunkStreamer::printStats() const
+{
+	printf("Streaming: %u/%u chunks done, %u orphans, %zu map writes pending\n", done, trackedCount(),
+		(uint)orphans.size(), mapWrites.size());
+	for (int stage = 0; stage < (int)ChunkStage::COUNT; stage++)
+	{
+		const StageStats& s = stageStats[stage];
+		printf("  %-8s waiting %5u running %3u completed %7llu cancelled %6llu | latency avg %8.2f ms max %8.2f ms | work %.3f ms/chunk\n",
+			nameOf((ChunkStage)stage), s.waiting, s.running, s.completed, s.cancelled, s.averageLatencyMs(), s.maxLatencyMs,
+			s.completed > 0 ? s.workMs / s.completed : 0.0);
+	}
+}
+
+#pragma endregion
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "ChunkMesher.hpp"
+#include "jobs/JobSystem.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+/* The ChunkStreamer keeps the chunks around the viewer loaded and meshed. Every chunk in range goes
+ * through the stages of ChunkStage in order:
+ *
+ *   GENERATE  job, fills a new VoxelChunk with the TerrainGenerator, then the main thread inserts it in the map
+ *   LIGHT     nothing to compute yet, it waits for the 6 neighbours to be generated
+ *   MESH      job, greedy meshes the chunk, its' neighbours hiding the faces on its' borders
+ *   UPLOAD    main thread, hands the mesh to the upload callback, a few per frame
+ *
+ * Each frame, the chunks waiting for each stage are ordered by priority: their distance to the
+ * viewer, multiplied by OUT_OF_VIEW_PENALTY when they are outside of the view cone. Only a few jobs
+ * per worker are in flight per stage, so a camera turning or moving reorders the work that hasn't
+ * started yet. Chunks leaving the view distance are cancelled: waiting ones are dropped, running
+ * ones are dropped when their job returns.
+ *
+ * Backpressure: meshing pauses while too many meshes wait for their upload, and while the map has
+ * chunks to insert or remove. Mesh jobs read the map under a shared lock, the main thread only
+ * modifies it when it gets the exclusive lock without waiting, so a frame never waits for a job.
+ *
+ * Only the main thread calls the streamer. The map must not be modified by anyone else while chunks
+ * are streamed.
+ */
+
+enum class ChunkStage
+{
+	GENERATE,
+	LIGHT,
+	MESH,
+	UPLOAD,
+	COUNT  //Done
+};
+
+/// <summary>
+/// The viewer the chunks are streamed around.
+/// </summary>
+struct StreamView
+{
+	glm::vec3 position;  //In voxels
+	glm::vec3 forward;   //Normalized
+	float fov = 1.6f;    //Full angle of the view cone, in radians
+};
+
+/// <summary>
+/// The tuning of a ChunkStreamer.
+/// </summary>
+struct StreamSettings
+{
+	uint viewDistance = 8;        //Horizontal radius of the streamed area, in chunks
+	int minLayer = 0;             //Lowest layer of chunks streamed
+	int maxLayer = 7;             //Highest layer of chunks streamed
+	uint jobsPerWorker = 2;       //Jobs in flight per stage and per worker
+	uint uploadsPerFrame = 8;     //Meshes handed to the upload callback per frame
+	uint maxPendingUploads = 32;  //Meshes waiting for their upload before meshing pauses
+	float mainThreadMs = 4;       //Time the main thread spends executing jobs per frame when it's the only worker
+};
+
+/// <summary>
+/// The queue depth and the latencies of a stage.
+/// </summary>
+struct StageStats
+{
+	uint waiting = 0;        //Chunks waiting for the stage, ready or not
+	uint running = 0;        //Jobs in flight
+	uint64 completed = 0;
+	uint64 cancelled = 0;    //Chunks dropped while waiting for or running the stage
+	double waitMs = 0;       //Total time the completed chunks waited for the stage
+	double workMs = 0;       //Total time spent in the stage by the completed chunks
+	double maxLatencyMs = 0; //Longest wait + work
+
+	double averageLatencyMs() const { return completed > 0 ? (waitMs + workMs) / completed : 0; }
+};
+
+/// <summary>
+/// Streams the chunks of a ChunkMap around a viewer. See the top of ChunkStreamer.hpp.
+/// </summary>
+class ChunkStreamer
+{
+public:
+
+	static constexpr float OUT_OF_VIEW_PENALTY = 3; //Chunks behind the viewer are as urgent as chunks 3 times farther in front
+
+	StreamSettings settings;
+
+	/// <summary>
+	/// Called with every mesh to upload, on the main thread. A chunk is meshed again when a neighbour
+	/// arrives after it, its' new mesh replaces the previous one.
+	/// </summary>
+	std::function<void(const ChunkMesh&)> upload;
+
+	/// <summary>
+	/// Called with the position of every chunk whose mesh was uploaded, when it leaves the view distance.
+	/// </summary>
+	std::function<void(glm::ivec3)> unload;
+
+	ChunkStreamer(ChunkMap& map, const StreamSettings& settings = StreamSettings());
+
+	/// <summary>
+	/// Cancels every chunk and waits for the jobs in flight. The chunks already inserted stay in the map.
+	/// </summary>
+	~ChunkStreamer();
+
+	ChunkStreamer(const ChunkStreamer&) = delete;
+	ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+	/// <summary>
+	/// Collects the finished jobs, follows the viewer and starts the most urgent work. Call it once per frame.
+	/// </summary>
+	void update(const StreamView& view);
+
+	/// <summary>
+	/// Returns the queue depth and the latencies of a stage.
+	/// </summary>
+	const StageStats& stats(ChunkStage stage) const { return stageStats[(int)stage]; }
+
+	/// <summary>
+	/// Returns the number of chunks in range that went through every stage.
+	/// </summary>
+	uint completedCount() const { return done; }
+
+	/// <summary>
+	/// Returns the number of chunks in range.
+	/// </summary>
+	uint trackedCount() const { return (uint)tracked.size(); }
+
+	/// <summary>
+	/// Prints the stats of every stage.
+	/// </summary>
+	void printStats() const;
+
+	/// <summary>
+	/// Returns the name of a stage.
+	/// </summary>
+	static const char* nameOf(ChunkStage stage);
+
+private:
+
+	typedef std::chrono::steady_clock Clock;
+
+	/// <summary>
+	/// A chunk in range and its' progress.
+	/// </summary>
+	struct StreamedChunk
+	{
+		glm::ivec3 position;
+		ChunkStage stage = ChunkStage::GENERATE;  //Next stage to go through
+		bool running = false;                     //Whether a job of the stage is in flight
+		bool inMap = false;
+		bool uploaded = false;                    //Whether a mesh of the chunk was uploaded
+		bool remesh = false;                      //Whether a neighbour arrived while the chunk was meshed
+		std::atomic<bool> cancelled{ false };
+		float priority = 0;                       //Lower is more urgent
+
+		VoxelChunk* generated = nullptr;          //Owned until inserted in the map
+		ChunkMesh mesh;
+
+		Clock::time_point queuedAt;               //When the chunk reached its' stage
+		Clock::time_point startedAt;              //When the job of its' stage started
+		double workMs = 0;                        //Duration of the last job
+	};
+
+	/// <summary>
+	/// A chunk to insert in the map, or to remove from it when chunk is null.
+	/// </summary>
+	struct MapWrite
+	{
+		glm::ivec3 position;
+		VoxelChunk* chunk;
+		StreamedChunk* owner; //Of the inserted chunk, null for removals
+	};
+
+	ChunkMap& map;
+	std::shared_mutex mapLock;  //Shared by the mesh jobs, exclusive when the map is modified
+
+	std::unordered_map<uint64, StreamedChunk*> tracked; //The chunks in range, by ChunkMap::keyOf
+	std::vector<StreamedChunk*> orphans;                //Cancelled while running, deleted when their job returns
+	std::vector<MapWrite> mapWrites;                    //Applied in order once the exclusive lock is free
+
+	std::mutex finishedMutex;
+	std::vector<StreamedChunk*> finished;               //Jobs returned since the last update
+	std::vector<StreamedChunk*> finishedScratch;
+
+	std::vector<StreamedChunk*> queues[(int)ChunkStage::COUNT]; //Rebuilt every frame
+	StageStats stageStats[(int)ChunkStage::COUNT];
+	uint done = 0;
+
+	Counter jobs;                  //Every job in flight, only waited on by the destructor
+	glm::ivec3 center;             //Chunk of the viewer when the range was last computed
+	bool centered = false;
+
+	/// <summary>
+	/// Applies the results of the jobs that returned.
+	/// </summary>
+	void collect();
+
+	/// <summary>
+	/// Starts tracking the chunks entering the range and cancels the ones leaving it.
+	/// </summary>
+	void follow(glm::ivec3 viewerChunk);
+
+	/// <summary>
+	/// Stops tracking a chunk, deleting it now or when its' job returns.
+	/// </summary>
+	void cancel(StreamedChunk* chunk);
+
+	/// <summary>
+	/// Inserts and removes the pending chunks if no mesh job is reading the map.
+	/// </summary>
+	/// <returns>Whether the map is up to date.</returns>
+	bool applyMapWrites();
+
+	/// <summary>
+	/// Moves a chunk to its' next stage.
+	/// </summary>
+	void advance(StreamedChunk* chunk, ChunkStage next);
+
+	/// <summary>
+	/// Returns whether the chunk can start its' stage.
+	/// </summary>
+	bool isReady(const StreamedChunk* chunk) const;
+
+	/// <summary>
+	/// Updates the priorities and fills the queue of each stage with the chunks ready for it, most urgent first.
+	/// </summary>
+	void prioritize(const StreamView& view);
+
+	/// <summary>
+	/// Starts the job of a stage on a chunk.
+	/// </summary>
+	void start(StreamedChunk* chunk);
+
+	/// <summary>
+	/// Called by the jobs when they return.
+	/// </summary>
+	void finish(StreamedChunk* chunk);
+
+	/// <summary>
+	/// Records a chunk completing its' stage.
+	/// </summary>
+	void record(const StreamedChunk* chunk);
+
+	/// <summary>
+	/// Returns whether a chunk position is in range of the viewer's chunk, with a margin in chunks.
+	/// </summary>
+	bool inRange(glm::ivec3 position, glm::ivec3 viewerChunk, int margin) const;
+};
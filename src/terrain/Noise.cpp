@@ -0,0 +1,324 @@
+#include "Noise.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define NOISE_X86
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define TARGET_SSE41
+		#define TARGET_AVX2
+		#define INLINE_SSE41 __forceinline
+		#define INLINE_AVX2 __forceinline
+	#else
+		#include <immintrin.h>
+		#define TARGET_SSE41 __attribute__((target("sse4.1")))
+		#define TARGET_AVX2 __attribute__((target("avx2")))
+		#define INLINE_SSE41 TARGET_SSE41 __attribute__((always_inline)) inline
+		#define INLINE_AVX2 TARGET_AVX2 __attribute__((always_inline)) inline
+	#endif
+#endif
+
+static const float F2 = 0.36602540378f; //(sqrt(3) - 1) / 2, skews to the simplex grid
+static const float G2 = 0.21132486540f; //(3 - sqrt(3)) / 6, unskews back
+static const uint HASH_I = 0x8da6b343u, HASH_J = 0xd8163841u, HASH_SEED = 0xcb1ab31fu, HASH_MIX = 0x5bd1e995u;
+
+#pragma region Scalar
+
+static inline uint hashCorner(int i, int j, uint seed)
+{
+	uint h = ((uint)i * HASH_I) ^ ((uint)j * HASH_J) ^ (seed * HASH_SEED);
+	h ^= h >> 13;
+	h *= HASH_MIX;
+	h ^= h >> 15;
+	return h;
+}
+
+/// <summary>
+/// Contribution of a corner: max(0.5 - x² - y², 0)^4 * dot(gradient, (x, y)).
+/// The 8 gradients are (±1, ±2) and (±2, ±1).
+/// </summary>
+static inline float corner(uint h, float x, float y)
+{
+	float t = std::max(0.5f - x * x - y * y, 0.0f);
+	float u = (h & 4) == 0 ? x : y;
+	float v = (h & 4) == 0 ? y : x;
+	if (h & 1)
+		u = -u;
+	v = v * 2.0f;
+	if (h & 2)
+		v = -v;
+	t = t * t;
+	return t * t * (u + v);
+}
+
+float Noise::simplex(float x, float y, uint seed)
+{
+	float s = (x + y) * F2;
+	float xs = std::floor(x + s);
+	float ys = std::floor(y + s);
+	int i = (int)xs, j = (int)ys;
+
+	float t = (xs + ys) * G2;
+	float x0 = x - (xs - t);
+	float y0 = y - (ys - t);
+
+	//Lower or upper triangle of the skewed cell
+	int i1 = x0 > y0 ? 1 : 0;
+	int j1 = 1 - i1;
+
+	float x1 = x0 - (float)i1 + G2;
+	float y1 = y0 - (float)j1 + G2;
+	float x2 = x0 - 1.0f + 2.0f * G2;
+	float y2 = y0 - 1.0f + 2.0f * G2;
+
+	float n = corner(hashCorner(i, j, seed), x0, y0) +
+		corner(hashCorner(i + i1, j + j1, seed), x1, y1) +
+		corner(hashCorner(i + 1, j + 1, seed), x2, y2);
+	return 40.0f * n;
+}
+
+#pragma endregion
+
+#pragma region SIMD
+
+#ifdef NOISE_X86
+
+//The SIMD versions mirror simplex() operation by operation, on 4 or 8 points at once
+
+INLINE_SSE41 static __m128i hashCorner4(__m128i i, __m128i j, __m128i seedHash)
+{
+	__m128i h = _mm_xor_si128(_mm_xor_si128(_mm_mullo_epi32(i, _mm_set1_epi32((int)HASH_I)),
+		_mm_mullo_epi32(j, _mm_set1_epi32((int)HASH_J))), seedHash);
+	h = _mm_xor_si128(h, _mm_srli_epi32(h, 13));
+	h = _mm_mullo_epi32(h, _mm_set1_epi32((int)HASH_MIX));
+	return _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+}
+
+INLINE_SSE41 static __m128 corner4(__m128i h, __m128 x, __m128 y)
+{
+	__m128 t = _mm_max_ps(_mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_setzero_ps());
+	__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(4)), _mm_set1_epi32(4)));
+	__m128 u = _mm_blendv_ps(x, y, swap);
+	__m128 v = _mm_blendv_ps(y, x, swap);
+	u = _mm_xor_ps(u, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31)));
+	v = _mm_mul_ps(v, _mm_set1_ps(2.0f));
+	v = _mm_xor_ps(v, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30)));
+	t = _mm_mul_ps(t, t);
+	return _mm_mul_ps(_mm_mul_ps(t, t), _mm_add_ps(u, v));
+}
+
+INLINE_SSE41 static __m128 simplex4(__m128 x, __m128 y, __m128i seedHash)
+{
+	__m128 s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(F2));
+	__m128 xs = _mm_floor_ps(_mm_add_ps(x, s));
+	__m128 ys = _mm_floor_ps(_mm_add_ps(y, s));
+	__m128i i = _mm_cvttps_epi32(xs), j = _mm_cvttps_epi32(ys);
+
+	__m128 t = _mm_mul_ps(_mm_add_ps(xs, ys), _mm_set1_ps(G2));
+	__m128 x0 = _mm_sub_ps(x, _mm_sub_ps(xs, t));
+	__m128 y0 = _mm_sub_ps(y, _mm_sub_ps(ys, t));
+
+	__m128 lower = _mm_cmpgt_ps(x0, y0);
+	__m128 i1 = _mm_and_ps(lower, _mm_set1_ps(1.0f));
+	__m128 j1 = _mm_sub_ps(_mm_set1_ps(1.0f), i1);
+
+	__m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), _mm_set1_ps(G2));
+	__m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), _mm_set1_ps(G2));
+	__m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_set1_ps(1.0f)), _mm_set1_ps(2.0f * G2));
+	__m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_set1_ps(1.0f)), _mm_set1_ps(2.0f * G2));
+
+	const __m128i one = _mm_set1_epi32(1);
+	__m128i i1i = _mm_and_si128(_mm_castps_si128(lower), one);
+	__m128 n = _mm_add_ps(_mm_add_ps(
+		corner4(hashCorner4(i, j, seedHash), x0, y0),
+		corner4(hashCorner4(_mm_add_epi32(i, i1i), _mm_add_epi32(j, _mm_sub_epi32(one, i1i)), seedHash), x1, y1)),
+		corner4(hashCorner4(_mm_add_epi32(i, one), _mm_add_epi32(j, one), seedHash), x2, y2));
+	return _mm_mul_ps(_mm_set1_ps(40.0f), n);
+}
+
+TARGET_SSE41 void Noise::gridSSE41(float x, float y, float step, uint width, uint height, uint seed, float* out)
+{
+	const __m128i seedHash = _mm_set1_epi32((int)(seed * HASH_SEED));
+	const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+	for (uint row = 0; row < height; row++)
+	{
+		const float py = y + (float)row * step;
+		float* line = out + (size_t)row * width;
+		uint col = 0;
+		for (; col < width; col += 4)
+		{
+			__m128 columns = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32((int)col), lanes));
+			__m128 px = _mm_add_ps(_mm_set1_ps(x), _mm_mul_ps(columns, _mm_set1_ps(step)));
+			__m128 noise = simplex4(px, _mm_set1_ps(py), seedHash);
+			if (col + 4 <= width)
+			{
+				_mm_storeu_ps(line + col, noise);
+				continue;
+			}
+
+			//The last columns are computed as a whole vector too, the unused lanes are dropped
+			alignas(16) float tail[4];
+			_mm_store_ps(tail, noise);
+			std::copy(tail, tail + (width - col), line + col);
+		}
+	}
+}
+
+INLINE_AVX2 static __m256i hashCorner8(__m256i i, __m256i j, __m256i seedHash)
+{
+	__m256i h = _mm256_xor_si256(_mm256_xor_si256(_mm256_mullo_epi32(i, _mm256_set1_epi32((int)HASH_I)),
+		_mm256_mullo_epi32(j, _mm256_set1_epi32((int)HASH_J))), seedHash);
+	h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+	h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)HASH_MIX));
+	return _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+}
+
+INLINE_AVX2 static __m256 corner8(__m256i h, __m256 x, __m256 y)
+{
+	__m256 t = _mm256_max_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y)), _mm256_setzero_ps());
+	__m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(h, _mm256_set1_epi32(4)), _mm256_set1_epi32(4)));
+	__m256 u = _mm256_blendv_ps(x, y, swap);
+	__m256 v = _mm256_blendv_ps(y, x, swap);
+	u = _mm256_xor_ps(u, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31)));
+	v = _mm256_mul_ps(v, _mm256_set1_ps(2.0f));
+	v = _mm256_xor_ps(v, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30)));
+	t = _mm256_mul_ps(t, t);
+	return _mm256_mul_ps(_mm256_mul_ps(t, t), _mm256_add_ps(u, v));
+}
+
+INLINE_AVX2 static __m256 simplex8(__m256 x, __m256 y, __m256i seedHash)
+{
+	__m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), _mm256_set1_ps(F2));
+	__m256 xs = _mm256_floor_ps(_mm256_add_ps(x, s));
+	__m256 ys = _mm256_floor_ps(_mm256_add_ps(y, s));
+	__m256i i = _mm256_cvttps_epi32(xs), j = _mm256_cvttps_epi32(ys);
+
+	__m256 t = _mm256_mul_ps(_mm256_add_ps(xs, ys), _mm256_set1_ps(G2));
+	__m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(xs, t));
+	__m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(ys, t));
+
+	__m256 lower = _mm256_cmp_ps(x0, y0, _CMP_GT_OQ);
+	__m256 i1 = _mm256_and_ps(lower, _mm256_set1_ps(1.0f));
+	__m256 j1 = _mm256_sub_ps(_mm256_set1_ps(1.0f), i1);
+
+	__m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, i1), _mm256_set1_ps(G2));
+	__m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, j1), _mm256_set1_ps(G2));
+	__m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2.0f * G2));
+	__m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2.0f * G2));
+
+	const __m256i one = _mm256_set1_epi32(1);
+	__m256i i1i = _mm256_and_si256(_mm256_castps_si256(lower), one);
+	__m256 n = _mm256_add_ps(_mm256_add_ps(
+		corner8(hashCorner8(i, j, seedHash), x0, y0),
+		corner8(hashCorner8(_mm256_add_epi32(i, i1i), _mm256_add_epi32(j, _mm256_sub_epi32(one, i1i)), seedHash), x1, y1)),
+		corner8(hashCorner8(_mm256_add_epi32(i, one), _mm256_add_epi32(j, one), seedHash), x2, y2));
+	return _mm256_mul_ps(_mm256_set1_ps(40.0f), n);
+}
+
+TARGET_AVX2 void Noise::gridAVX2(float x, float y, float step, uint width, uint height, uint seed, float* out)
+{
+	const __m256i seedHash = _mm256_set1_epi32((int)(seed * HASH_SEED));
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+	for (uint row = 0; row < height; row++)
+	{
+		const float py = y + (float)row * step;
+		float* line = out + (size_t)row * width;
+		uint col = 0;
+		for (; col < width; col += 8)
+		{
+			__m256 columns = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32((int)col), lanes));
+			__m256 px = _mm256_add_ps(_mm256_set1_ps(x), _mm256_mul_ps(columns, _mm256_set1_ps(step)));
+			__m256 noise = simplex8(px, _mm256_set1_ps(py), seedHash);
+			if (col + 8 <= width)
+			{
+				_mm256_storeu_ps(line + col, noise);
+				continue;
+			}
+
+			//Grids are 2^k + 1 wide: the scalar noise for the last column of every row cost more than a whole
+			//vector, leaving AVX2 code for it
+			alignas(32) float tail[8];
+			_mm256_store_ps(tail, noise);
+			std::copy(tail, tail + (width - col), line + col);
+		}
+	}
+}
+
+#else
+
+void Noise::gridSSE41(float x, float y, float step, uint width, uint height, uint seed, float* out) {}
+void Noise::gridAVX2(float x, float y, float step, uint width, uint height, uint seed, float* out) {}
+
+#endif
+
+#pragma endregion
+
+#pragma region Dispatch
+
+InstructionSet Noise::instructionSet = Noise::supported();
+
+InstructionSet Noise::supported()
+{
+#if !defined(NOISE_X86)
+	return InstructionSet::SCALAR;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int leaves = info[0];
+	__cpuid(info, 1);
+	bool sse41 = (info[2] & (1 << 19)) != 0;
+	bool osAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+	bool avx2 = false;
+	if (leaves >= 7 && osAVX)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+	return avx2 ? InstructionSet::AVX2 : sse41 ? InstructionSet::SSE41 : InstructionSet::SCALAR;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? InstructionSet::AVX2 :
+		__builtin_cpu_supports("sse4.1") ? InstructionSet::SSE41 : InstructionSet::SCALAR;
+#endif
+}
+
+void Noise::use(InstructionSet set)
+{
+	instructionSet = std::min(set, supported());
+}
+
+const char* Noise::nameOf(InstructionSet set)
+{
+	switch (set)
+	{
+	case InstructionSet::AVX2:
+		return "AVX2";
+	case InstructionSet::SSE41:
+		return "SSE4.1";
+	default:
+		return "scalar";
+	}
+}
+
+void Noise::simplexGrid(float x, float y, float step, uint width, uint height, uint seed, float* out)
+{
+	switch (instructionSet)
+	{
+	case InstructionSet::AVX2:
+		gridAVX2(x, y, step, width, height, seed, out);
+		return;
+	case InstructionSet::SSE41:
+		gridSSE41(x, y, step, width, height, seed, out);
+		return;
+	default:
+		for (uint row = 0; row < height; row++)
+			for (uint col = 0; col < width; col++)
+				out[row * width + col] = simplex(x + (float)col * step, y + (float)row * step, seed);
+	}
+}
+
+#pragma endregion
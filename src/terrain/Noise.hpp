@@ -0,0 +1,65 @@
+#pragma once
+
+#include "util/Utility.hpp"
+
+/* 2D simplex noise (Gustavson's formulation) with hashed gradients instead of a permutation table,
+ * so the SIMD versions need no gathers. Grids of samples are evaluated 8 at a time with AVX2, 4 at a
+ * time with SSE4.1, or one at a time, depending on what the CPU supports. All the versions compute
+ * the same operations in the same order.
+ */
+
+/// <summary>
+/// The instruction sets the noise can be evaluated with, from the slowest to the fastest.
+/// </summary>
+enum class InstructionSet
+{
+	SCALAR,
+	SSE41,
+	AVX2
+};
+
+/// <summary>
+/// A static class evaluating simplex noise.
+/// </summary>
+class Noise
+{
+public:
+
+	/// <summary>
+	/// Returns the noise at a point, roughly in [-1, 1].
+	/// </summary>
+	static float simplex(float x, float y, uint seed = 0);
+
+	/// <summary>
+	/// Evaluates the noise on a width * height grid, row by row:
+	/// out[i + j * width] = simplex(x + i * step, y + j * step, seed).
+	/// </summary>
+	static void simplexGrid(float x, float y, float step, uint width, uint height, uint seed, float* out);
+
+	/// <summary>
+	/// Returns the best instruction set supported by the CPU.
+	/// </summary>
+	static InstructionSet supported();
+
+	/// <summary>
+	/// Returns the instruction set used by simplexGrid().
+	/// </summary>
+	static InstructionSet current() { return instructionSet; }
+
+	/// <summary>
+	/// Forces the instruction set used by simplexGrid(), it is clamped to the supported one.
+	/// </summary>
+	static void use(InstructionSet set);
+
+	/// <summary>
+	/// Returns the name of an instruction set.
+	/// </summary>
+	static const char* nameOf(InstructionSet set);
+
+private:
+
+	static InstructionSet instructionSet;
+
+	static void gridSSE41(float x, float y, float step, uint width, uint height, uint seed, float* out);
+	static void gridAVX2(float x, float y, float step, uint width, uint height, uint seed, float* out);
+};
@@ -0,0 +1,198 @@
+#include "TerrainGenerator.hpp"
+#include "Noise.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+std::atomic<std::shared_ptr<const std::vector<Biome>>> Biome::biomes{ std::make_shared<const std::vector<Biome>>() };
+
+uint TerrainGenerator::seed = 0;
+
+const Biome TerrainGenerator::defaultBiome = { 0, "default", -10, 30, 10, 70, 64, 1, 0.01f, 8, 2, 0.5f, 3, 2, 3, 1 };
+
+static const float CLIMATE_FREQUENCY = 0.001f;                    //Climates change over about a thousand voxels
+static const uint PRECIPITATION_SEED = 1, TEMPERATURE_SEED = 2, ELEVATION_SEED = 3, HEIGHT_SEED = 16;
+
+#pragma region Biomes
+
+void Biome::replace(std::vector<Biome> newBiomes)
+{
+	biomes.store(std::make_shared<const std::vector<Biome>>(std::move(newBiomes)));
+}
+
+/// <summary>
+/// Returns the noise of a column remapped to [0, 1].
+/// </summary>
+static float climateNoise(int x, int z, uint seed)
+{
+	return Noise::simplex(x * CLIMATE_FREQUENCY, z * CLIMATE_FREQUENCY, seed) * 0.5f + 0.5f;
+}
+
+Climate TerrainGenerator::climate(int x, int z)
+{
+	float p = climateNoise(x, z, seed + PRECIPITATION_SEED);
+	float t = climateNoise(x, z, seed + TEMPERATURE_SEED);
+	float e = climateNoise(x, z, seed + ELEVATION_SEED);
+
+	p *= t; //Precipitation <= temperature
+	return { t * 40 - 10, p * 60 + 10, e * 100 };
+}
+
+/// <summary>
+/// Returns how far a value is from a range, 0 if it's inside.
+/// </summary>
+static float outside(float value, float min, float max)
+{
+	return std::max({ min - value, value - max, 0.0f });
+}
+
+Biome TerrainGenerator::biome(int x, int z)
+{
+	std::shared_ptr<const std::vector<Biome>> biomes = Biome::loaded(); //Held until the copy is made
+	if (biomes->empty())
+		return defaultBiome;
+
+	Climate c = climate(x, z);
+	const Biome* closest = &(*biomes)[0];
+	float closestDistance = INFINITY;
+	for (const Biome& biome : *biomes)
+	{
+		float dt = outside(c.temperature, biome.minTemperature, biome.maxTemperature);
+		float dp = outside(c.precipitation, biome.minPrecipitation, biome.maxPrecipitation);
+		float distance = dt * dt + dp * dp;
+		if (distance == 0)
+			return biome;
+		if (distance < closestDistance)
+		{
+			closestDistance = distance;
+			closest = &biome;
+		}
+	}
+	return *closest;
+}
+
+#pragma endregion
+
+#pragma region Heights
+
+void TerrainGenerator::addOctave(int chunkX, int chunkZ, float frequency, float amplitude, uint octaveSeed, float* heights)
+{
+	//Samples closer than 1/16 of a wavelength are interpolated, bilinear interpolation is then invisible
+	int spacing = 1;
+	while (spacing < SIZE && spacing * 2 * frequency <= 1.0f / 16)
+		spacing *= 2;
+
+	const int samples = SIZE / spacing + 1; //Including the first column of the next chunk
+	float noise[(SIZE + 1) * (SIZE + 1)];
+	Noise::simplexGrid((float)(chunkX * SIZE) * frequency, (float)(chunkZ * SIZE) * frequency, spacing * frequency,
+		samples, samples, octaveSeed, noise);
+
+	if (spacing == 1)
+	{
+		for (int z = 0; z < SIZE; z++)
+			for (int x = 0; x < SIZE; x++)
+				heights[x + z * SIZE] += amplitude * noise[x + z * samples];
+		return;
+	}
+
+	//Separable: widens every sampled row to SIZE columns, then blends two widened rows per voxel row
+	const float inverse = 1.0f / spacing;
+	float rows[(SIZE + 1) * SIZE];
+	for (int r = 0; r < samples; r++)
+	{
+		const float* sample = noise + r * samples;
+		float* row = rows + r * SIZE;
+		for (int sx = 0; sx < samples - 1; sx++)
+		{
+			const float delta = (sample[sx + 1] - sample[sx]) * inverse;
+			for (int i = 0; i < spacing; i++)
+				row[sx * spacing + i] = sample[sx] + delta * i;
+		}
+	}
+
+	for (int z = 0; z < SIZE; z++)
+	{
+		const float tz = (z % spacing) * inverse;
+		const float* row0 = rows + (z / spacing) * SIZE;
+		const float* row1 = row0 + SIZE;
+		float* line = heights + z * SIZE;
+		for (int x = 0; x < SIZE; x++)
+			line[x] += amplitude * (row0[x] + (row1[x] - row0[x]) * tz);
+	}
+}
+
+void TerrainGenerator::heightmap(int chunkX, int chunkZ, const Biome& biome, float* heights)
+{
+	std::fill(heights, heights + AREA, biome.height);
+
+	float frequency = biome.frequency;
+	float amplitude = biome.amplitude;
+	for (uint octave = 0; octave < biome.octaves; octave++)
+	{
+		addOctave(chunkX, chunkZ, frequency, amplitude, seed + HEIGHT_SEED + octave, heights);
+		frequency *= biome.lacunarity;
+		amplitude *= biome.persistence;
+	}
+}
+
+#pragma endregion
+
+#pragma region Blocks
+
+void TerrainGenerator::generate(VoxelChunk& chunk, const Biome& biome, const float* heights)
+{
+	const int bottom = chunk.position.y * SIZE;
+	const int top = bottom + SIZE - 1;
+
+	int minHeight = INT32_MAX, maxHeight = INT32_MIN;
+	for (int i = 0; i < AREA; i++)
+	{
+		int h = (int)std::floor(heights[i]);
+		minHeight = std::min(minHeight, h);
+		maxHeight = std::max(maxHeight, h);
+	}
+
+	//Most chunks are entirely above or below the surface
+	if (bottom > maxHeight)
+	{
+		chunk.fill(AIR);
+		return;
+	}
+	if (top <= minHeight - (int)biome.subsurfaceDepth - 1)
+	{
+		chunk.fill(biome.stone);
+		return;
+	}
+
+	static thread_local std::vector<BlockID> blocks(VoxelChunk::VOLUME);
+	for (int z = 0; z < SIZE; z++)
+		for (int x = 0; x < SIZE; x++)
+		{
+			const int height = (int)std::floor(heights[x + z * SIZE]);
+			for (int y = 0; y < SIZE; y++)
+			{
+				const int wy = bottom + y;
+				BlockID block = biome.stone;
+				if (wy > height)
+					block = AIR;
+				else if (wy == height)
+					block = biome.surface;
+				else if (wy > height - 1 - (int)biome.subsurfaceDepth)
+					block = biome.subsurface;
+				blocks[VoxelChunk::indexOf(x, y, z)] = block;
+			}
+		}
+	chunk.load(blocks.data());
+}
+
+void TerrainGenerator::generate(VoxelChunk& chunk)
+{
+	//Biomes are chosen per chunk column, they span hundreds of voxels
+	const Biome b = biome(chunk.position.x * SIZE + SIZE / 2, chunk.position.z * SIZE + SIZE / 2);
+
+	float heights[AREA];
+	heightmap(chunk.position.x, chunk.position.z, b, heights);
+	generate(chunk, b, heights);
+}
+
+#pragma endregion
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "VoxelChunk.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* The terrain is generated column by column. Three low frequency noises give the climate of each
+ * column (temperature, precipitation and elevation) and the biome is the one whose ranges contain the
+ * climate. The biome then gives the height of the terrain with a few octaves of simplex noise, and the
+ * blocks of its' surface and underground.
+ *
+ * Biomes are read from res/data/terrain_generation/biomes.json (see readBiomes()). They can be replaced
+ * while chunks are generated on the workers (see HotReloader.hpp): the set of biomes is never modified,
+ * a new one is swapped in, and the generator works on a copy of the biome of a chunk.
+ */
+
+/// <summary>
+/// The parameters of a type of terrain.
+/// </summary>
+struct Biome
+{
+	uint id;
+	std::string name;
+
+	float minTemperature, maxTemperature;     //In °C, the climate is in [-10, 30]
+	float minPrecipitation, maxPrecipitation; //In cm, the climate is in [10, 70]
+
+	float height;      //Average height of the surface
+	uint octaves;      //Number of noises summed for the height
+	float frequency;   //Of the first octave, in 1/voxels
+	float amplitude;   //Of the first octave, in voxels
+	float lacunarity;  //Frequency multiplier between two octaves
+	float persistence; //Amplitude multiplier between two octaves
+
+	BlockID surface;      //Top block
+	BlockID subsurface;   //Blocks right under the top one
+	uint subsurfaceDepth; //Number of subsurface blocks
+	BlockID stone;        //Everything below
+
+	/// <summary>
+	/// Returns all the biomes, loaded by readBiomes(). They stay valid while the pointer is held.
+	/// </summary>
+	static std::shared_ptr<const std::vector<Biome>> loaded() { return biomes.load(); }
+
+	/// <summary>
+	/// Replaces all the biomes. The previous ones are freed once nobody holds them anymore.
+	/// </summary>
+	static void replace(std::vector<Biome> newBiomes);
+
+private:
+
+	static std::atomic<std::shared_ptr<const std::vector<Biome>>> biomes;
+};
+
+/// <summary>
+/// The climate of a column of the world.
+/// </summary>
+struct Climate
+{
+	float temperature;   //In [-10, 30]
+	float precipitation; //In [10, 70], never more than the temperature allows
+	float elevation;     //In [0, 100]
+};
+
+/// <summary>
+/// A static class generating the terrain of VoxelChunks.
+/// </summary>
+class TerrainGenerator
+{
+public:
+
+	static constexpr int SIZE = VoxelChunk::SIZE;
+	static constexpr int AREA = SIZE * SIZE; //Voxels of a heightmap
+
+	static uint seed;
+
+	/// <summary>
+	/// Returns the climate of a world column.
+	/// </summary>
+	static Climate climate(int x, int z);
+
+	/// <summary>
+	/// Returns a copy of the biome of a world column: the first whose ranges contain its' climate, or the
+	/// closest one.
+	/// </summary>
+	static Biome biome(int x, int z);
+
+	/// <summary>
+	/// Computes the height of every column of a chunk column with the given biome.
+	/// </summary>
+	/// <param name="heights">AREA heights, indexed by x + z * SIZE.</param>
+	static void heightmap(int chunkX, int chunkZ, const Biome& biome, float* heights);
+
+	/// <summary>
+	/// Fills a chunk from the heightmap of its' column.
+	/// </summary>
+	static void generate(VoxelChunk& chunk, const Biome& biome, const float* heights);
+
+	/// <summary>
+	/// Computes the heightmap of the chunk's column and fills the chunk.
+	/// </summary>
+	static void generate(VoxelChunk& chunk);
+
+private:
+
+	static const Biome defaultBiome; //Used when no biome is loaded
+
+	/// <summary>
+	/// Adds amplitude * noise to the heights, sampling the noise on a coarser grid when its' wavelength
+	/// allows it and interpolating in between.
+	/// </summary>
+	static void addOctave(int chunkX, int chunkZ, float frequency, float amplitude, uint octaveSeed, float* heights);
+};
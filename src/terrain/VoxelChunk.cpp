@@ -0,0 +1,195 @@
+#include "VoxelChunk.hpp"
+
+#include <algorithm>
+
+VoxelChunk::VoxelChunk(glm::ivec3 position, BlockID block) :
+	position(position)
+{
+	fill(block);
+}
+
+uint VoxelChunk::bitsFor(uint distinctBlocks)
+{
+	if (distinctBlocks <= 1) return 0;
+	if (distinctBlocks <= 2) return 1;
+	if (distinctBlocks <= 4) return 2;
+	if (distinctBlocks <= 16) return 4;
+	if (distinctBlocks <= 256) return 8;
+	return 16;
+}
+
+void VoxelChunk::repack(uint newBits, const std::vector<uint>& remap)
+{
+	std::vector<uint64> old;
+	old.swap(data);
+	uint oldBits = bits;
+
+	bits = newBits;
+	data.assign((size_t)VOLUME * bits / 64, 0);
+	for (int voxel = 0; voxel < VOLUME; voxel++)
+	{
+		uint index = 0;
+		if (oldBits > 0)
+		{
+			uint bit = (uint)voxel * oldBits;
+			index = (uint)(old[bit >> 6] >> (bit & 63)) & ((1u << oldBits) - 1);
+		}
+		writeIndex(voxel, remap[index]);
+	}
+}
+
+void VoxelChunk::set(int x, int y, int z, BlockID block)
+{
+	int voxel = indexOf(x, y, z);
+	dirty = true;
+	if (bits == 16)
+	{
+		writeIndex(voxel, (uint16)block);
+		return;
+	}
+
+	uint old = readIndex(voxel);
+	if (palette[old] == block)
+		return;
+
+	//Looking for the block, or a free entry to reuse
+	uint index = (uint)palette.size();
+	uint free = (uint)palette.size();
+	for (uint i = 0; i < palette.size(); i++)
+	{
+		if (palette[i] == block && counts[i] > 0)
+		{
+			index = i;
+			break;
+		}
+		if (counts[i] == 0 && free == palette.size())
+			free = i;
+	}
+
+	if (index == palette.size())
+	{
+		if (free < palette.size())
+		{
+			index = free;
+			palette[index] = block;
+		}
+		else
+		{
+			palette.push_back(block);
+			counts.push_back(0);
+			if (palette.size() > (1u << bits))
+			{
+				uint newBits = bitsFor((uint)palette.size());
+				std::vector<uint> remap(palette.size());
+				for (uint i = 0; i < palette.size(); i++)
+					remap[i] = newBits == 16 ? (uint16)palette[i] : i;
+				repack(newBits, remap);
+
+				if (bits == 16)
+				{
+					palette.clear();
+					counts.clear();
+					writeIndex(voxel, (uint16)block);
+					return;
+				}
+			}
+		}
+	}
+
+	counts[old]--;
+	counts[index]++;
+	writeIndex(voxel, index);
+}
+
+void VoxelChunk::fill(BlockID block)
+{
+	dirty = true;
+	bits = 0;
+	palette.assign(1, block);
+	counts.assign(1, (uint16)VOLUME);
+	data.clear();
+	data.shrink_to_fit();
+}
+
+void VoxelChunk::load(const BlockID* blocks)
+{
+	//Index + 1 of each block in the palette, reset after use
+	static thread_local std::vector<uint16> lookup(65536, 0);
+
+	dirty = true;
+	palette.clear();
+	counts.clear();
+	for (int voxel = 0; voxel < VOLUME && palette.size() <= 256; voxel++)
+	{
+		uint16& entry = lookup[(uint16)blocks[voxel]];
+		if (entry == 0)
+		{
+			palette.push_back(blocks[voxel]);
+			counts.push_back(0);
+			entry = (uint16)palette.size();
+		}
+	}
+
+	bits = bitsFor((uint)palette.size());
+	data.assign((size_t)VOLUME * bits / 64, 0);
+	data.shrink_to_fit();
+
+	if (bits == 16)
+	{
+		for (int voxel = 0; voxel < VOLUME; voxel++)
+			writeIndex(voxel, (uint16)blocks[voxel]);
+	}
+	else
+	{
+		for (int voxel = 0; voxel < VOLUME; voxel++)
+		{
+			uint index = lookup[(uint16)blocks[voxel]] - 1;
+			counts[index]++;
+			if (bits > 0)
+				writeIndex(voxel, index);
+		}
+	}
+
+	for (BlockID block : palette)
+		lookup[(uint16)block] = 0;
+	if (bits == 16)
+	{
+		palette.clear();
+		counts.clear();
+	}
+	palette.shrink_to_fit();
+	counts.shrink_to_fit();
+}
+
+void VoxelChunk::unpack(BlockID* blocks) const
+{
+	if (bits == 0)
+	{
+		std::fill(blocks, blocks + VOLUME, palette[0]);
+		return;
+	}
+
+	//Whole words at once, each holds 64 / bits indices
+	const uint perWord = 64 / bits;
+	const uint64 mask = (1u << bits) - 1;
+	for (size_t word = 0; word < data.size(); word++)
+	{
+		uint64 value = data[word];
+		BlockID* out = blocks + word * perWord;
+		for (uint i = 0; i < perWord; i++, value >>= bits)
+			out[i] = paletteBlock((uint)(value & mask));
+	}
+}
+
+void VoxelChunk::compact()
+{
+	static thread_local std::vector<BlockID> blocks(VOLUME);
+	unpack(blocks.data());
+	load(blocks.data());
+}
+
+size_t VoxelChunk::memoryUsage() const
+{
+	return sizeof(VoxelChunk) + palette.capacity() * sizeof(BlockID) + counts.capacity() * sizeof(uint16) +
+		data.capacity() * sizeof(uint64);
+}
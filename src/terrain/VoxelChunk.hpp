@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Block.hpp"
+
+#include <vector>
+#include "glm/vec3.hpp"
+
+/* A VoxelChunk stores the blocks of a cube of SIZE^3 voxels with a palette: each voxel only stores an
+ * index in the list of the distinct blocks of the chunk, packed on as few bits as possible.
+ *
+ *   bits | distinct blocks | data
+ *   -----+-----------------+---------
+ *      0 | 1               | none, the chunk is uniform (most chunks are only air or only stone)
+ *      1 | 2               | 4 KB
+ *      2 | 4               | 8 KB
+ *      4 | 16              | 16 KB
+ *      8 | 256             | 32 KB
+ *     16 | more            | 64 KB, block ids are stored directly and the palette is unused
+ *
+ * against 64 KB for a raw array of int16. Since the bits per index are a power of 2, an index never
+ * straddles two words.
+ * Voxels are indexed as x + z * SIZE + y * SIZE^2, so horizontal layers are contiguous.
+ */
+
+/// <summary>
+/// A palette compressed cube of blocks, part of a ChunkMap.
+/// </summary>
+class VoxelChunk
+{
+public:
+
+	static constexpr int SIZE = 32;
+	static constexpr int VOLUME = SIZE * SIZE * SIZE;
+
+	const glm::ivec3 position; //In chunks, the first voxel is at position * SIZE
+	bool dirty = true;         //Whether the blocks changed since the chunk was last meshed
+
+	/// <summary>
+	/// Creates a chunk filled with the given block.
+	/// </summary>
+	VoxelChunk(glm::ivec3 position, BlockID block = AIR);
+
+	/// <summary>
+	/// Returns the index of a voxel, its' coordinates must be in [0, SIZE).
+	/// </summary>
+	static int indexOf(int x, int y, int z) { return x + z * SIZE + y * SIZE * SIZE; }
+
+	/// <summary>
+	/// Returns the block of a voxel, its' coordinates must be in [0, SIZE).
+	/// </summary>
+	BlockID get(int x, int y, int z) const { return paletteBlock(readIndex(indexOf(x, y, z))); }
+
+	/// <summary>
+	/// Sets the block of a voxel, its' coordinates must be in [0, SIZE). Grows the indices if needed.
+	/// </summary>
+	void set(int x, int y, int z, BlockID block);
+
+	/// <summary>
+	/// Fills the whole chunk with a block, freeing the indices.
+	/// </summary>
+	void fill(BlockID block);
+
+	/// <summary>
+	/// Replaces all the blocks of the chunk, using the smallest palette possible.
+	/// </summary>
+	/// <param name="blocks">VOLUME blocks, in the order of indexOf().</param>
+	void load(const BlockID* blocks);
+
+	/// <summary>
+	/// Writes all the blocks of the chunk, in the order of indexOf().
+	/// </summary>
+	/// <param name="blocks">Must hold VOLUME blocks.</param>
+	void unpack(BlockID* blocks) const;
+
+	/// <summary>
+	/// Removes the unused blocks from the palette and shrinks the indices if possible.
+	/// set() only grows them, call this after many edits.
+	/// </summary>
+	void compact();
+
+	/// <summary>
+	/// Returns whether every voxel holds the same block.
+	/// </summary>
+	bool isUniform() const { return bits == 0; }
+
+	/// <summary>
+	/// Returns the number of bits used per voxel.
+	/// </summary>
+	uint bitsPerVoxel() const { return bits; }
+
+	/// <summary>
+	/// Returns the memory used by the chunk in bytes.
+	/// </summary>
+	size_t memoryUsage() const;
+
+private:
+
+	uint bits;                   //Bits per index: 0, 1, 2, 4, 8 or 16
+	std::vector<BlockID> palette;
+	std::vector<uint16> counts;  //Number of voxels using each palette entry, unused with 16 bits
+	std::vector<uint64> data;    //Packed indices, or block ids with 16 bits
+
+	uint readIndex(int voxel) const
+	{
+		if (bits == 0)
+			return 0;
+		uint bit = (uint)voxel * bits;
+		return (uint)(data[bit >> 6] >> (bit & 63)) & ((1u << bits) - 1);
+	}
+
+	void writeIndex(int voxel, uint index)
+	{
+		uint bit = (uint)voxel * bits;
+		uint64 mask = (uint64)((1u << bits) - 1) << (bit & 63);
+		data[bit >> 6] = (data[bit >> 6] & ~mask) | ((uint64)index << (bit & 63));
+	}
+
+	BlockID paletteBlock(uint index) const { return bits == 16 ? (BlockID)index : palette[index]; }
+
+	/// <summary>
+	/// Returns the smallest bits per index able to store the given number of distinct blocks.
+	/// </summary>
+	static uint bitsFor(uint distinctBlocks);
+
+	/// <summary>
+	/// Rewrites every index with a new number of bits and a new palette.
+	/// </summary>
+	/// <param name="remap">The new index of each old index.</param>
+	void repack(uint newBits, const std::vector<uint>& remap);
+};
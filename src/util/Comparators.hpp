@@ -93,8 +93,8 @@ struct LessEqualThan : public IComparator<T>
 	LessEqualThan(T b) :
 		 b(b) { }
 
-	const bool compare(T b) const override { return a <= b; }
-	const std::string printMessage() const override { return "be less or equal to " + b; }
+	const bool compare(T a) const override { return a <= b; }
+	const std::string printMessage() const override { return "be less or equal to " + std::to_string(b); }
 
 };
 
@@ -106,8 +106,8 @@ struct GreaterThan : public IComparator<T>
 	GreaterThan(T b)  :
 		b(b) { }
 
-	const bool compare(T b) const override { return a > b; }
-	const std::string printMessage() const override { return "be greater than " + b; }
+	const bool compare(T a) const override { return a > b; }
+	const std::string printMessage() const override { return "be greater than " + std::to_string(b); }
 
 };
 
@@ -120,7 +120,7 @@ struct GreaterEqualThan : public IComparator<T>
 		b(b) { }
 
 	const bool compare(T a) const override { return a >= b; }
-	const std::string printMessage() const override { return "be greater or equal to " + b; }
+	const std::string printMessage() const override { return "be greater or equal to " + std::to_string(b); }
 
 };
 
@@ -1,6 +1,280 @@
 #include "Octree.hpp"
 
-/*Branch::Branch()
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "glm/common.hpp"
+
+#pragma region Nodes
+
+Octree::Octree(uint depth, BlockID block) :
+	depth(std::min(depth, 16u))
+{
+	nodes.push_back(leaf(block));
+}
+
+void Octree::split(uint node)
+{
+	uint group;
+	if (freeGroups.empty())
+	{
+		group = (uint)nodes.size();
+		nodes.resize(nodes.size() + 8);
+	}
+	else
+	{
+		group = freeGroups.back();
+		freeGroups.pop_back();
+	}
+
+	std::fill(nodes.begin() + group, nodes.begin() + group + 8, nodes[node]);
+	nodes[node] = group;
+}
+
+void Octree::freeSubtree(uint node)
+{
+	if (isLeaf(nodes[node]))
+		return;
+
+	uint group = nodes[node];
+	for (uint i = 0; i < 8; i++)
+		freeSubtree(group + i);
+	freeGroups.push_back(group);
+}
+
+bool Octree::tryCollapse(uint node)
+{
+	uint group = nodes[node];
+	uint first = nodes[group];
+	if (!isLeaf(first))
+		return false;
+	for (uint i = 1; i < 8; i++)
+		if (nodes[group + i] != first)
+			return false;
+
+	freeGroups.push_back(group);
+	nodes[node] = first;
+	return true;
+}
+
+uint Octree::findLeaf(glm::ivec3 voxel, glm::ivec3& origin, uint& size) const
+{
+	uint node = 0;
+	origin = glm::ivec3(0);
+	size = this->size();
+	while (!isLeaf(nodes[node]))
+	{
+		size /= 2;
+		uint child = 0;
+		for (int axis = 0; axis < 3; axis++)
+			if (voxel[axis] >= origin[axis] + (int)size)
+			{
+				child |= 1 << axis;
+				origin[axis] += size;
+			}
+		node = nodes[node] + child;
+	}
+	return node;
+}
+
+#pragma endregion
+
+#pragma region Voxels
+
+BlockID Octree::get(int x, int y, int z) const
+{
+	const int s = (int)size();
+	if (x < 0 || y < 0 || z < 0 || x >= s || y >= s || z >= s)
+		return 0;
+
+	glm::ivec3 origin;
+	uint leafSize;
+	return blockOf(nodes[findLeaf(glm::ivec3(x, y, z), origin, leafSize)]);
+}
+
+void Octree::set(int x, int y, int z, BlockID block)
+{
+	const int s = (int)size();
+	if (x < 0 || y < 0 || z < 0 || x >= s || y >= s || z >= s)
+		return;
+
+	uint path[17]; //Branches from the root to the parent of the voxel
+	uint length = 0;
+	uint node = 0;
+	for (uint level = depth; level > 0; level--)
+	{
+		if (isLeaf(nodes[node]))
+		{
+			if (blockOf(nodes[node]) == block)
+				return;
+			split(node);
+		}
+
+		uint bit = level - 1;
+		uint child = ((x >> bit) & 1) | (((y >> bit) & 1) << 1) | (((z >> bit) & 1) << 2);
+		path[length++] = node;
+		node = nodes[node] + child;
+	}
+	nodes[node] = leaf(block);
+
+	while (length > 0 && tryCollapse(path[--length]));
+}
+
+void Octree::fill(glm::ivec3 min, glm::ivec3 max, BlockID block)
 {
-	
-}*/
\ No newline at end of file
+	min = glm::max(min, glm::ivec3(0));
+	max = glm::min(max, glm::ivec3((int)size()));
+	if (min.x >= max.x || min.y >= max.y || min.z >= max.z)
+		return;
+	fill(0, glm::ivec3(0), size(), min, max, block);
+}
+
+void Octree::fill(uint node, glm::ivec3 origin, uint size, glm::ivec3 min, glm::ivec3 max, BlockID block)
+{
+	glm::ivec3 end = origin + (int)size;
+	if (max.x <= origin.x || max.y <= origin.y || max.z <= origin.z || min.x >= end.x || min.y >= end.y || min.z >= end.z)
+		return;
+
+	if (min.x <= origin.x && min.y <= origin.y && min.z <= origin.z && max.x >= end.x && max.y >= end.y && max.z >= end.z)
+	{
+		freeSubtree(node);
+		nodes[node] = leaf(block);
+		return;
+	}
+
+	if (isLeaf(nodes[node]))
+	{
+		if (blockOf(nodes[node]) == block)
+			return;
+		split(node);
+	}
+
+	uint half = size / 2;
+	for (uint child = 0; child < 8; child++)
+	{
+		glm::ivec3 childOrigin = origin + glm::ivec3(child & 1, (child >> 1) & 1, (child >> 2) & 1) * (int)half;
+		fill(nodes[node] + child, childOrigin, half, min, max, block); //nodes can grow, re-reading the group
+	}
+	tryCollapse(node);
+}
+
+#pragma endregion
+
+#pragma region Queries
+
+bool Octree::raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, OctreeHit& hit) const
+{
+	const float INF = std::numeric_limits<float>::infinity();
+	const int s = (int)size();
+
+	//Clipping the ray to the root
+	float tEnter = 0, tExit = maxDistance;
+	int enterAxis = -1;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (direction[axis] == 0)
+		{
+			if (origin[axis] < 0 || origin[axis] >= s)
+				return false;
+			continue;
+		}
+		float t0 = (0 - origin[axis]) / direction[axis];
+		float t1 = (s - origin[axis]) / direction[axis];
+		if (t0 > t1)
+			std::swap(t0, t1);
+		if (t0 > tEnter)
+		{
+			tEnter = t0;
+			enterAxis = axis;
+		}
+		tExit = std::min(tExit, t1);
+	}
+	if (tEnter > tExit)
+		return false;
+
+	float t = tEnter;
+	glm::ivec3 normal(0);
+	if (enterAxis >= 0)
+		normal[enterAxis] = direction[enterAxis] > 0 ? -1 : 1;
+	glm::ivec3 voxel = glm::clamp(glm::ivec3(glm::floor(origin + direction * t)), glm::ivec3(0), glm::ivec3(s - 1));
+
+	//Skipping whole air leaves at once
+	while (true)
+	{
+		glm::ivec3 leafOrigin;
+		uint leafSize;
+		BlockID block = blockOf(nodes[findLeaf(voxel, leafOrigin, leafSize)]);
+		if (block != 0)
+		{
+			hit = { voxel, normal, t, block };
+			return true;
+		}
+
+		int exitAxis = 0;
+		float tNext = INF;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float tAxis = INF;
+			if (direction[axis] > 0)
+				tAxis = (leafOrigin[axis] + (int)leafSize - origin[axis]) / direction[axis];
+			else if (direction[axis] < 0)
+				tAxis = (leafOrigin[axis] - origin[axis]) / direction[axis];
+			if (tAxis < tNext)
+			{
+				tNext = tAxis;
+				exitAxis = axis;
+			}
+		}
+		if (tNext > maxDistance)
+			return false;
+
+		//The next voxel is right after the face crossed, the other axes stay inside the leaf
+		t = tNext;
+		glm::vec3 position = origin + direction * t;
+		for (int axis = 0; axis < 3; axis++)
+			voxel[axis] = std::clamp((int)std::floor(position[axis]), leafOrigin[axis], leafOrigin[axis] + (int)leafSize - 1);
+		voxel[exitAxis] = direction[exitAxis] > 0 ? leafOrigin[exitAxis] + (int)leafSize : leafOrigin[exitAxis] - 1;
+		normal = glm::ivec3(0);
+		normal[exitAxis] = direction[exitAxis] > 0 ? -1 : 1;
+
+		if (voxel[exitAxis] < 0 || voxel[exitAxis] >= s)
+			return false;
+	}
+}
+
+void Octree::forEachLeaf(glm::ivec3 min, glm::ivec3 max, const std::function<void(glm::ivec3, uint, BlockID)>& function) const
+{
+	forEachLeaf(0, glm::ivec3(0), size(), min, max, [&](glm::ivec3 origin, uint size, BlockID block)
+	{
+		function(origin, size, block);
+		return true;
+	});
+}
+
+bool Octree::intersects(glm::ivec3 min, glm::ivec3 max) const
+{
+	//Stops at the first leaf found
+	return !forEachLeaf(0, glm::ivec3(0), size(), min, max, [](glm::ivec3, uint, BlockID) { return false; });
+}
+
+bool Octree::forEachLeaf(uint node, glm::ivec3 origin, uint size, glm::ivec3 min, glm::ivec3 max,
+	const std::function<bool(glm::ivec3, uint, BlockID)>& function) const
+{
+	glm::ivec3 end = origin + (int)size;
+	if (max.x <= origin.x || max.y <= origin.y || max.z <= origin.z || min.x >= end.x || min.y >= end.y || min.z >= end.z)
+		return true;
+
+	if (isLeaf(nodes[node]))
+		return blockOf(nodes[node]) == 0 || function(origin, size, blockOf(nodes[node]));
+
+	uint half = size / 2;
+	for (uint child = 0; child < 8; child++)
+	{
+		glm::ivec3 childOrigin = origin + glm::ivec3(child & 1, (child >> 1) & 1, (child >> 2) & 1) * (int)half;
+		if (!forEachLeaf(nodes[node] + child, childOrigin, half, min, max, function))
+			return false;
+	}
+	return true;
+}
+
+#pragma endregion
@@ -1,25 +1,130 @@
 #pragma once
 
-/*struct BranchOrLeaf
-{
+#include "Utility.hpp"
+#include "terrain/Block.hpp"
 
-};
-struct Branch : BranchOrLeaf
+#include <vector>
+#include <functional>
+#include "glm/vec3.hpp"
+
+/* A sparse voxel octree storing a block id per voxel of a cube of 2^depth voxels per side.
+ *
+ * The tree is pointerless: every node is a single 32 bits word in one contiguous array. A leaf has its'
+ * highest bit set and holds a block id in its' lowest 16 bits, a branch holds the index of its' first
+ * child, the 8 children of a branch being stored next to each other (a group) in Morton order
+ * (child = x | y << 1 | z << 2).
+ * Subtrees made of a single block are always collapsed into one leaf, so the memory used grows with
+ * the complexity of the surfaces instead of the volume. Groups freed by collapses are recycled.
+ */
+
+/// <summary>
+/// Where a ray hit a voxel of an Octree.
+/// </summary>
+struct OctreeHit
 {
-	const BranchOrLeaf& b_000;
-	const BranchOrLeaf& b_001;
-	const BranchOrLeaf& b_010;
-	const BranchOrLeaf& b_011;
-	const BranchOrLeaf& b_100;
-	const BranchOrLeaf& b_101;
-	const BranchOrLeaf& b_110;
-	const BranchOrLeaf& b_111;
-
-	Branch();
+	glm::ivec3 voxel;  //Coordinates of the voxel hit
+	glm::ivec3 normal; //Normal of the face hit, zero if the ray started inside the voxel
+	float distance;    //Distance along the ray, in multiples of the direction's length
+	BlockID block;
 };
 
-struct Leaf : BranchOrLeaf
+/// <summary>
+/// A sparse voxel octree of block ids, with the root covering [0, size()) on each axis.
+/// </summary>
+class Octree
 {
-	__int16 blockID;
-	Leaf();
-};*/
\ No newline at end of file
+public:
+
+	/// <summary>
+	/// Creates an octree of 2^depth voxels per side, filled with the given block.
+	/// </summary>
+	/// <param name="depth">In [0, 16].</param>
+	Octree(uint depth, BlockID block = 0);
+
+	/// <summary>
+	/// Returns the number of voxels per side.
+	/// </summary>
+	uint size() const { return 1u << depth; }
+
+	/// <summary>
+	/// Returns the block of a voxel, 0 (air) outside of the octree.
+	/// </summary>
+	BlockID get(int x, int y, int z) const;
+
+	/// <summary>
+	/// Sets the block of a voxel, collapsing the nodes that become uniform. Ignored outside of the octree.
+	/// </summary>
+	void set(int x, int y, int z, BlockID block);
+
+	/// <summary>
+	/// Sets the block of every voxel in [min, max), in O(surface of the box) nodes.
+	/// </summary>
+	void fill(glm::ivec3 min, glm::ivec3 max, BlockID block);
+
+	/// <summary>
+	/// Finds the first non air voxel along a ray.
+	/// </summary>
+	/// <param name="origin">The origin of the ray, in voxel units.</param>
+	/// <param name="direction">The direction of the ray, doesn't need to be normalized.</param>
+	/// <param name="maxDistance">The maximum distance, in multiples of the direction's length.</param>
+	/// <returns>Whether a voxel was hit.</returns>
+	bool raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, OctreeHit& hit) const;
+
+	/// <summary>
+	/// Calls function(min, size, block) for every non air leaf overlapping [min, max). A leaf is a
+	/// cube of size^3 uniform voxels starting at min, it can extend outside of the box.
+	/// </summary>
+	void forEachLeaf(glm::ivec3 min, glm::ivec3 max, const std::function<void(glm::ivec3, uint, BlockID)>& function) const;
+
+	/// <summary>
+	/// Returns whether any voxel in [min, max) isn't air.
+	/// </summary>
+	bool intersects(glm::ivec3 min, glm::ivec3 max) const;
+
+	/// <summary>
+	/// Returns the number of nodes used, including the free groups.
+	/// </summary>
+	uint nodeCount() const { return (uint)nodes.size(); }
+
+	/// <summary>
+	/// Returns the memory used by the nodes in bytes.
+	/// </summary>
+	size_t memoryUsage() const { return nodes.capacity() * sizeof(uint) + freeGroups.capacity() * sizeof(uint); }
+
+private:
+
+	static constexpr uint LEAF = 0x80000000;
+
+	uint depth;
+	std::vector<uint> nodes;      //The root is nodes[0], then groups of 8 children
+	std::vector<uint> freeGroups; //Index of the first node of each free group
+
+	static bool isLeaf(uint node) { return (node & LEAF) != 0; }
+	static uint leaf(BlockID block) { return LEAF | (uint16)block; }
+	static BlockID blockOf(uint node) { return (BlockID)(uint16)(node & 0xFFFF); }
+
+	/// <summary>
+	/// Replaces a leaf by a branch whose 8 children are leaves of the same block.
+	/// </summary>
+	void split(uint node);
+
+	/// <summary>
+	/// Frees the groups of the subtree of a node, but not the node itself.
+	/// </summary>
+	void freeSubtree(uint node);
+
+	/// <summary>
+	/// Replaces a branch by a leaf if its' 8 children are leaves of the same block.
+	/// </summary>
+	/// <returns>Whether the branch was collapsed.</returns>
+	bool tryCollapse(uint node);
+
+	void fill(uint node, glm::ivec3 origin, uint size, glm::ivec3 min, glm::ivec3 max, BlockID block);
+	bool forEachLeaf(uint node, glm::ivec3 origin, uint size, glm::ivec3 min, glm::ivec3 max,
+		const std::function<bool(glm::ivec3, uint, BlockID)>& function) const;
+
+	/// <summary>
+	/// Returns the leaf containing a voxel inside of the octree, with its' origin and size.
+	/// </summary>
+	uint findLeaf(glm::ivec3 voxel, glm::ivec3& origin, uint& size) const;
+};
@@ -6,8 +6,26 @@ typedef const std::string& constring;
 
 typedef unsigned int uint;
 typedef unsigned long ulong;
+typedef unsigned long long uint64;
 typedef char int8;
 typedef unsigned char uint8;
+typedef short int16;
+typedef unsigned short uint16;
+
+constexpr uint64 FNV_OFFSET_BASIS = 0xCBF29CE484222325ull; //Seed of a new FNV-1a hash
+
+/// <summary>
+/// Returns the 64 bits FNV-1a hash of some bytes. Pass the previous hash as the seed to hash several
+/// buffers as one.
+/// </summary>
+inline uint64 fnv1a(const void* bytes, size_t size, uint64 seed = FNV_OFFSET_BASIS)
+{
+	const uint8* b = (const uint8*)bytes;
+	uint64 hash = seed;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ b[i]) * 0x100000001B3ull;
+	return hash;
+}
 
 /// <summary>
 /// Skip the blank characters of the given string.
@@ -15,7 +33,7 @@ typedef unsigned char uint8;
 /// <param name="string">The string.</param>
 /// <param name="start">The starting character.</param>
 /// <returns>The index of the first non blank character.</returns>
-int skipToNext(constring string, int start)
+inline int skipToNext(constring string, int start)
 {
 	char c = string[start];
 	while (c == ' ' || c == '\n' || c == '\t')
@@ -25,7 +43,7 @@ int skipToNext(constring string, int start)
 	return start;
 }
 
-bool endsWith(const std::string &fullString, const std::string &ending) {
+inline bool endsWith(const std::string &fullString, const std::string &ending) {
 	if (fullString.length() < ending.length()) return false;
 
 	return (0 == fullString.compare(fullString.length() - ending.length(), ending.length(), ending));